@@ -0,0 +1,254 @@
+#include <bit>
+
+#include "wisdom-chess/engine/attack_counts.hpp"
+#include "wisdom-chess/engine/board.hpp"
+#include "wisdom-chess/engine/position.hpp"
+
+namespace wisdom
+{
+    // Score for each square a piece can move to beyond the usual number for
+    // that piece, in the middlegame and endgame. A pawn is worth 200.
+    static constexpr array<TaperedScore, Num_Piece_Types> Mobility_Weight = {
+        TaperedScore { 0, 0 },  // None
+        TaperedScore { 0, 0 },  // Pawn
+        TaperedScore { 4, 4 },  // Knight
+        TaperedScore { 5, 5 },  // Bishop
+        TaperedScore { 2, 4 },  // Rook
+        TaperedScore { 1, 2 },  // Queen
+        TaperedScore { 0, 0 },  // King
+    };
+
+    static constexpr array<int, Num_Piece_Types> Mobility_Baseline = { 0, 0, 4, 6, 6, 12, 0 };
+
+    // Weight of each attack on a square next to the king, by attacking piece.
+    static constexpr array<int, Num_Piece_Types> King_Attack_Weight = { 0, 0, 20, 20, 40, 80, 0 };
+
+    // Percentage of the attack weight that counts, by number of attackers: a
+    // lone attacker is rarely dangerous.
+    static constexpr array<int, 8> King_Attackers_Scale = { 0, 0, 50, 75, 88, 94, 97, 99 };
+
+    using SquareMask = uint64_t;
+
+    [[nodiscard]] static constexpr auto
+    squareBit (int index)
+        -> SquareMask
+    {
+        return SquareMask { 1 } << index;
+    }
+
+    inline constexpr int Num_Directions = 8;
+
+    // Rook directions first, then bishop directions.
+    static constexpr array<pair<int, int>, Num_Directions> Directions = { {
+        { -1, 0 }, { 1, 0 }, { 0, -1 }, { 0, 1 },
+        { -1, -1 }, { -1, 1 }, { 1, -1 }, { 1, 1 },
+    } };
+
+    // Whether the square index increases along each direction, which decides
+    // which end of the ray the nearest piece is found at.
+    [[nodiscard]] static constexpr auto
+    isIncreasingDirection (int direction)
+        -> bool
+    {
+        auto [row_step, col_step] = Directions[direction];
+        return row_step * Num_Columns + col_step > 0;
+    }
+
+    // The squares reachable from each square, computed at compile time.
+    struct AttackTables
+    {
+        array<SquareMask, Num_Squares> knight;
+        array<SquareMask, Num_Squares> king_zone;
+        array<array<SquareMask, Num_Directions>, Num_Squares> rays;
+    };
+
+    static consteval auto
+    makeAttackTables()
+        -> AttackTables
+    {
+        AttackTables result {};
+        constexpr array<pair<int, int>, 8> knight_offsets = { {
+            { -2, -1 }, { -2, 1 }, { -1, -2 }, { -1, 2 },
+            { 1, -2 }, { 1, 2 }, { 2, -1 }, { 2, 1 },
+        } };
+
+        for (int index = 0; index < Num_Squares; index++)
+        {
+            int row = index / Num_Columns;
+            int col = index % Num_Columns;
+
+            for (auto [row_offset, col_offset] : knight_offsets)
+            {
+                if (isValidRow (row + row_offset) && isValidColumn (col + col_offset))
+                    result.knight[index] |= squareBit ((row + row_offset) * Num_Columns + col + col_offset);
+            }
+
+            result.king_zone[index] = squareBit (index);
+            for (int direction = 0; direction < Num_Directions; direction++)
+            {
+                auto [row_step, col_step] = Directions[direction];
+                for (int ray_row = row + row_step, ray_col = col + col_step;
+                     isValidRow (ray_row) && isValidColumn (ray_col);
+                     ray_row += row_step, ray_col += col_step)
+                {
+                    result.rays[index][direction] |= squareBit (ray_row * Num_Columns + ray_col);
+                }
+
+                if (isValidRow (row + row_step) && isValidColumn (col + col_step))
+                    result.king_zone[index] |= squareBit ((row + row_step) * Num_Columns + col + col_step);
+            }
+        }
+
+        return result;
+    }
+
+    static constexpr AttackTables Attack_Tables = makeAttackTables();
+
+    // The squares attacked along the rays in the given directions, up to and
+    // including the first occupied square on each.
+    [[nodiscard]] static auto
+    slidingAttacks (int square, SquareMask occupied, int first_direction, int last_direction)
+        -> SquareMask
+    {
+        SquareMask result = 0;
+        for (int direction = first_direction; direction < last_direction; direction++)
+        {
+            auto ray = Attack_Tables.rays[square][direction];
+            auto blockers = ray & occupied;
+            if (blockers != 0)
+            {
+                auto nearest = isIncreasingDirection (direction)
+                    ? std::countr_zero (blockers)
+                    : Num_Squares - 1 - std::countl_zero (blockers);
+                ray ^= Attack_Tables.rays[nearest][direction];
+            }
+            result |= ray;
+        }
+        return result;
+    }
+
+    [[nodiscard]] static auto
+    pieceAttacks (Piece type, int square, SquareMask occupied)
+        -> SquareMask
+    {
+        switch (type)
+        {
+            case Piece::Knight:
+                return Attack_Tables.knight[square];
+            case Piece::Bishop:
+                return slidingAttacks (square, occupied, 4, Num_Directions);
+            case Piece::Rook:
+                return slidingAttacks (square, occupied, 0, 4);
+            case Piece::Queen:
+                return slidingAttacks (square, occupied, 0, Num_Directions);
+            default:
+                return 0;
+        }
+    }
+
+    auto
+    countAttacks (const Board& board)
+        -> AttackCounts
+    {
+        AttackCounts result {};
+        array<SquareMask, Num_Players> occupied {};
+        array<SquareMask, Num_Players> pieces {};
+        array<SquareMask, Num_Players> pawn_attacks {};
+
+        auto squares = board.squareData();
+        for (int index = 0; index < Num_Squares; index++)
+        {
+            auto piece = squares[index];
+            if (piece == Piece_And_Color_None)
+                continue;
+
+            auto color = pieceColor (piece);
+            auto color_index = colorIndex (color);
+            auto type = pieceType (piece);
+            occupied[color_index] |= squareBit (index);
+
+            if (type == Piece::Pawn)
+            {
+                int row = index / Num_Columns + pawnDirection<int> (color);
+                int col = index % Num_Columns;
+                if (isValidRow (row))
+                {
+                    if (col > 0)
+                        pawn_attacks[color_index] |= squareBit (row * Num_Columns + col - 1);
+                    if (col < Last_Column)
+                        pawn_attacks[color_index] |= squareBit (row * Num_Columns + col + 1);
+                }
+            }
+            else if (type != Piece::King)
+            {
+                pieces[color_index] |= squareBit (index);
+            }
+        }
+
+        auto all_occupied = occupied[Color_Index_White] | occupied[Color_Index_Black];
+
+        for (auto who : { Color::White, Color::Black })
+        {
+            auto index = colorIndex (who);
+            auto opponent = colorInvert (who);
+            auto enemy_index = colorIndex (opponent);
+            auto enemy_king_zone = Attack_Tables.king_zone[board.getKingPosition (opponent).index()];
+            auto unavailable = occupied[index] | pawn_attacks[enemy_index];
+
+            auto remaining = pieces[index];
+            while (remaining != 0)
+            {
+                auto square = std::countr_zero (remaining);
+                remaining &= remaining - 1;
+
+                auto type = pieceType (squares[square]);
+                auto type_index = toInt (type);
+                auto attacks = pieceAttacks (type, square, all_occupied);
+
+                result.mobility[index][type_index] += std::popcount (attacks & ~unavailable);
+                result.pieces[index][type_index]++;
+
+                auto zone_attacks = std::popcount (attacks & enemy_king_zone);
+                if (zone_attacks > 0)
+                {
+                    result.king_attackers[enemy_index]++;
+                    result.king_attack_weight[enemy_index] += zone_attacks * King_Attack_Weight[type_index];
+                }
+            }
+        }
+
+        return result;
+    }
+
+    [[nodiscard]] static auto
+    individualScore (const AttackCounts& counts, Color who)
+        -> TaperedScore
+    {
+        auto index = colorIndex (who);
+        TaperedScore result {};
+
+        for (auto type : { Piece::Knight, Piece::Bishop, Piece::Rook, Piece::Queen })
+        {
+            auto type_index = toInt (type);
+            auto extra_squares = counts.mobility[index][type_index]
+                - counts.pieces[index][type_index] * Mobility_Baseline[type_index];
+            result.middlegame += extra_squares * Mobility_Weight[type_index].middlegame;
+            result.endgame += extra_squares * Mobility_Weight[type_index].endgame;
+        }
+
+        // King safety matters much less once the queens and most pieces are
+        // gone, so it only counts in the middlegame.
+        auto attackers = std::min<int> (counts.king_attackers[index], King_Attackers_Scale.size() - 1);
+        result.middlegame -= counts.king_attack_weight[index] * King_Attackers_Scale[attackers] / 100;
+
+        return result;
+    }
+
+    auto
+    AttackCounts::overallScore (Color who, int phase) const
+        -> int
+    {
+        auto score = individualScore (*this, who) - individualScore (*this, colorInvert (who));
+        return score.blend (phase);
+    }
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include "wisdom-chess/engine/global.hpp"
+#include "wisdom-chess/engine/piece.hpp"
+
+namespace wisdom
+{
+    class Board;
+
+    // How freely each side's pieces move, and how hard each side's king is
+    // being attacked, counted in one pass over the pieces.
+    struct AttackCounts
+    {
+        // Squares the pieces of each type could move to, by color index and
+        // piece type. Squares with a piece of the same color and squares
+        // attacked by an enemy pawn don't count.
+        array<array<int, Num_Piece_Types>, Num_Players> mobility {};
+
+        // The number of pieces the mobility was counted for.
+        array<array<int, Num_Piece_Types>, Num_Players> pieces {};
+
+        // The number of pieces attacking the squares around each side's
+        // king, and the weighted number of attacks on those squares.
+        array<int, Num_Players> king_attackers {};
+        array<int, Num_Players> king_attack_weight {};
+
+        // The score of the mobility and king safety from the point of view of
+        // the player, blended by the game phase.
+        [[nodiscard]] auto
+        overallScore (Color who, int phase) const
+            -> int;
+    };
+
+    // Count the attacks on the board from scratch.
+    [[nodiscard]] auto
+    countAttacks (const Board& board)
+        -> AttackCounts;
+}
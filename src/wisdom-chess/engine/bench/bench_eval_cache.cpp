@@ -0,0 +1,103 @@
+#include <nanobench.h>
+
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+
+#include "wisdom-chess/engine/board.hpp"
+#include "wisdom-chess/engine/eval_cache.hpp"
+#include "wisdom-chess/engine/fen_parser.hpp"
+#include "wisdom-chess/engine/history.hpp"
+#include "wisdom-chess/engine/logger.hpp"
+#include "wisdom-chess/engine/search.hpp"
+#include "wisdom-chess/engine/transposition_table.hpp"
+
+#include "bench_positions.hpp"
+
+namespace wisdom::bench
+{
+    static constexpr int Search_Depth = 6;
+    static constexpr int Search_Repetitions = 5;
+    static constexpr int Cache_Size_In_Megabytes = 1;
+
+    struct SearchTiming
+    {
+        int64_t nodes = 0;
+        double seconds = 0.0;
+    };
+
+    // Search to a fixed depth with fresh tables, so the runs with and without
+    // the cache visit exactly the same nodes and only the time differs.
+    static auto timeSearch (const char* fen, EvalCache* eval_cache) -> SearchTiming
+    {
+        FenParser parser { fen };
+        auto board = parser.buildBoard();
+        auto color = parser.getActivePlayer();
+        auto history = History::fromInitialBoard (board);
+        auto table = TranspositionTable::fromMegabytes (TranspositionTable::Default_Size_In_Megabytes);
+        MoveTimer timer { 600 };
+
+        auto search = eval_cache != nullptr
+            ? IterativeSearch::create (board, history, makeNullLogger(), timer, Search_Depth, table, *eval_cache)
+            : IterativeSearch::create (board, history, makeNullLogger(), timer, Search_Depth, table);
+
+        auto start = std::chrono::steady_clock::now();
+        auto result = search.iterativelyDeepen (color);
+        auto end = std::chrono::steady_clock::now();
+        ankerl::nanobench::doNotOptimizeAway (result);
+
+        return SearchTiming {
+            search.getNodesVisited(),
+            std::chrono::duration<double> (end - start).count()
+        };
+    }
+
+    static auto nodesPerSecond (const SearchTiming& timing) -> double
+    {
+        return timing.seconds > 0.0 ? static_cast<double> (timing.nodes) / timing.seconds : 0.0;
+    }
+
+    // The fastest of several searches, to keep noise out of short searches.
+    static auto fastestSearch (const char* fen, EvalCache* eval_cache) -> SearchTiming
+    {
+        SearchTiming fastest {};
+        for (int i = 0; i < Search_Repetitions; i++)
+        {
+            if (eval_cache != nullptr)
+                eval_cache->clear();
+
+            auto timing = timeSearch (fen, eval_cache);
+            if (i == 0 || timing.seconds < fastest.seconds)
+                fastest = timing;
+        }
+        return fastest;
+    }
+
+    static void compareSearches (const char* label, const char* fen)
+    {
+        auto without_cache = fastestSearch (fen, nullptr);
+
+        auto eval_cache = EvalCache::fromMegabytes (Cache_Size_In_Megabytes);
+        auto with_cache = fastestSearch (fen, &eval_cache);
+        auto stats = eval_cache.getStats();
+
+        auto nps_off = nodesPerSecond (without_cache);
+        auto nps_on = nodesPerSecond (with_cache);
+        auto change = nps_off > 0.0 ? 100.0 * (nps_on - nps_off) / nps_off : 0.0;
+
+        std::cout << "  " << label << " depth " << Search_Depth << ": "
+                  << with_cache.nodes << " nodes, "
+                  << std::fixed << std::setprecision (0)
+                  << nps_off << " NPS without cache, "
+                  << nps_on << " NPS with cache ("
+                  << std::showpos << std::setprecision (1) << change << std::noshowpos
+                  << "%), hit rate "
+                  << computeHitRate (EvalCacheStats {}, stats) << "%\n";
+    }
+
+    void runEvalCacheBenchmarks ([[maybe_unused]] ankerl::nanobench::Bench& bench)
+    {
+        compareSearches ("eval-cache/starting", Starting_Position_Fen);
+        compareSearches ("eval-cache/kiwipete", Kiwipete_Fen);
+    }
+}
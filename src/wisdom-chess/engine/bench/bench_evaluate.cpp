@@ -0,0 +1,78 @@
+#include <nanobench.h>
+
+#include "wisdom-chess/engine/board.hpp"
+#include "wisdom-chess/engine/evaluate.hpp"
+#include "wisdom-chess/engine/fen_parser.hpp"
+#include "wisdom-chess/engine/generate.hpp"
+
+#include "bench_positions.hpp"
+
+namespace wisdom::bench
+{
+    static constexpr int Boards_Per_Game = 64;
+
+    // Boards from random games starting at each position, like the positions
+    // a data generation job sees.
+    static void addRandomGameBoards (
+        const char* fen,
+        std::mt19937& generator,
+        vector<Board>& boards,
+        vector<Color>& colors
+    )
+    {
+        FenParser parser { fen };
+        auto board = parser.buildBoard();
+        auto who = parser.getActivePlayer();
+
+        for (int i = 0; i < Boards_Per_Game; i++)
+        {
+            auto moves = generateLegalMoves (board, who);
+            if (moves.isEmpty())
+                break;
+
+            std::uniform_int_distribution<size_t> pick { 0, moves.size() - 1 };
+            auto move = *(moves.begin() + narrow<std::ptrdiff_t> (pick (generator)));
+
+            board = board.withMove (who, move);
+            who = colorInvert (who);
+            boards.push_back (board);
+            colors.push_back (who);
+        }
+    }
+
+    void runEvaluateBenchmarks (ankerl::nanobench::Bench& bench)
+    {
+        vector<Board> boards;
+        vector<Color> colors;
+        std::mt19937 generator { 1 };
+
+        for (int game = 0; game < 16; game++)
+        {
+            for (const auto* fen : { Starting_Position_Fen, Kiwipete_Fen, Position4_Fen, Italian_Game_Fen })
+                addRandomGameBoards (fen, generator, boards, colors);
+        }
+
+        vector<int> scores (boards.size());
+
+        bench.batch (boards.size()).unit ("board");
+
+        bench.run (
+            "evaluate/one-at-a-time",
+            [&] {
+                for (size_t i = 0; i < boards.size(); i++)
+                    scores[i] = evaluate (boards[i], colors[i], 0);
+                ankerl::nanobench::doNotOptimizeAway (scores.data());
+            }
+        );
+
+        bench.run (
+            "evaluate/batch",
+            [&] {
+                evaluateBatch (boards, colors, scores);
+                ankerl::nanobench::doNotOptimizeAway (scores.data());
+            }
+        );
+
+        bench.batch (1).unit ("op");
+    }
+}
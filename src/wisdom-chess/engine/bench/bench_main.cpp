@@ -9,6 +9,12 @@ namespace wisdom::bench
     void runThreatBenchmarks (ankerl::nanobench::Bench& bench);
     void runLegalityBenchmarks (ankerl::nanobench::Bench& bench);
     void runPerftBenchmarks (ankerl::nanobench::Bench& bench);
+    void runTranspositionTableBenchmarks (ankerl::nanobench::Bench& bench);
+    void runEvalCacheBenchmarks (ankerl::nanobench::Bench& bench);
+    void runNnueBenchmarks (ankerl::nanobench::Bench& bench);
+    void runEvaluateBenchmarks (ankerl::nanobench::Bench& bench);
+    void runMoveTimerBenchmarks (ankerl::nanobench::Bench& bench);
+    void runSearchWorkerBenchmarks (ankerl::nanobench::Bench& bench);
 }
 
 auto main() -> int
@@ -31,5 +37,23 @@ auto main() -> int
     std::cout << "\n--- Perft ---\n";
     wisdom::bench::runPerftBenchmarks (bench);
 
+    std::cout << "\n--- Transposition Table ---\n";
+    wisdom::bench::runTranspositionTableBenchmarks (bench);
+
+    std::cout << "\n--- Evaluation Cache ---\n";
+    wisdom::bench::runEvalCacheBenchmarks (bench);
+
+    std::cout << "\n--- Neural Network Evaluation ---\n";
+    wisdom::bench::runNnueBenchmarks (bench);
+
+    std::cout << "\n--- Batch Evaluation ---\n";
+    wisdom::bench::runEvaluateBenchmarks (bench);
+
+    std::cout << "\n--- Search Deadlines ---\n";
+    wisdom::bench::runMoveTimerBenchmarks (bench);
+
+    std::cout << "\n--- Search Worker ---\n";
+    wisdom::bench::runSearchWorkerBenchmarks (bench);
+
     return 0;
 }
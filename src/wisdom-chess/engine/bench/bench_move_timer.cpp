@@ -0,0 +1,94 @@
+#include <nanobench.h>
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <iomanip>
+#include <stop_token>
+#include <thread>
+
+#include "wisdom-chess/engine/fen_parser.hpp"
+#include "wisdom-chess/engine/game.hpp"
+#include "wisdom-chess/engine/history.hpp"
+#include "wisdom-chess/engine/logger.hpp"
+#include "wisdom-chess/engine/move_timer.hpp"
+#include "wisdom-chess/engine/search.hpp"
+#include "wisdom-chess/engine/transposition_table.hpp"
+
+#include "bench_positions.hpp"
+
+namespace wisdom::bench
+{
+    using Milliseconds = std::chrono::duration<double, std::milli>;
+
+    static constexpr auto Hard_Limit = std::chrono::milliseconds { 100 };
+    static constexpr int Deadline_Repetitions = 10;
+    static constexpr auto Time_Before_Stop = std::chrono::milliseconds { 100 };
+
+    // The fastest, median and slowest of a set of measurements.
+    static void printSpread (const char* label, vector<Milliseconds> times)
+    {
+        std::sort (times.begin(), times.end());
+
+        std::cout << "  " << label << ": "
+                  << std::fixed << std::setprecision (2)
+                  << times.front().count() << " ms min, "
+                  << times[times.size() / 2].count() << " ms median, "
+                  << times.back().count() << " ms max\n";
+    }
+
+    // Search deeper than the limit allows, so only the timer stops it, and
+    // return how far past the limit it ran.
+    static auto hardLimitOvershoot (const char* fen) -> Milliseconds
+    {
+        FenParser parser { fen };
+        auto board = parser.buildBoard();
+        auto history = History::fromInitialBoard (board);
+        auto table = TranspositionTable::fromMegabytes (1);
+        MoveTimer timer { Hard_Limit };
+
+        auto search = IterativeSearch::create (board, history, makeNullLogger(), timer, 64, table);
+
+        auto start = std::chrono::steady_clock::now();
+        auto result = search.iterativelyDeepen (parser.getActivePlayer());
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        ankerl::nanobench::doNotOptimizeAway (result);
+
+        return Milliseconds { elapsed - Hard_Limit };
+    }
+
+    // Start a long search on another thread, stop it partway through, and
+    // return how long it took to come back with a move.
+    static auto stopLatency (const char* fen) -> Milliseconds
+    {
+        auto game = Game::createGameFromFen (fen);
+        game.setSearchTimeout (std::chrono::seconds { 30 });
+
+        std::stop_source stop_source;
+        auto future = game.findBestMoveAsync (makeNullLogger(), stop_source.get_token());
+        std::this_thread::sleep_for (Time_Before_Stop);
+
+        auto stop_time = std::chrono::steady_clock::now();
+        stop_source.request_stop();
+        auto best_move = future.get();
+        auto latency = std::chrono::steady_clock::now() - stop_time;
+        ankerl::nanobench::doNotOptimizeAway (best_move);
+
+        return Milliseconds { latency };
+    }
+
+    void runMoveTimerBenchmarks ([[maybe_unused]] ankerl::nanobench::Bench& bench)
+    {
+        vector<Milliseconds> overshoots;
+        for (int i = 0; i < Deadline_Repetitions; i++)
+            overshoots.push_back (hardLimitOvershoot (Kiwipete_Fen));
+
+        printSpread ("move-timer/hard-limit-overshoot", std::move (overshoots));
+
+        vector<Milliseconds> latencies;
+        for (int i = 0; i < Deadline_Repetitions; i++)
+            latencies.push_back (stopLatency (Kiwipete_Fen));
+
+        printSpread ("move-timer/stop-latency", std::move (latencies));
+    }
+}
@@ -0,0 +1,101 @@
+#include <nanobench.h>
+
+#include "wisdom-chess/engine/board.hpp"
+#include "wisdom-chess/engine/evaluate.hpp"
+#include "wisdom-chess/engine/fen_parser.hpp"
+#include "wisdom-chess/engine/generate.hpp"
+#include "wisdom-chess/engine/nnue.hpp"
+#include "wisdom-chess/engine/pawn_structure.hpp"
+
+#include "bench_positions.hpp"
+
+namespace wisdom::bench
+{
+    // No trained network ships with the engine, so this measures the speed of
+    // random weights, which is all the speed depends on.
+    static constexpr uint64_t Network_Seed = 1234;
+
+    struct ChildPosition
+    {
+        Board board;
+        Color who;
+    };
+
+    // Every position one legal move away, as the search reaches leaves from
+    // their parent.
+    static auto childPositions (const char* fen) -> vector<ChildPosition>
+    {
+        FenParser parser { fen };
+        auto board = parser.buildBoard();
+        auto color = parser.getActivePlayer();
+
+        vector<ChildPosition> result;
+        for (auto move : generateLegalMoves (board, color))
+            result.push_back ({ board.withMove (color, move), colorInvert (color) });
+        return result;
+    }
+
+    void runNnueBenchmarks (ankerl::nanobench::Bench& bench)
+    {
+        struct PositionInfo
+        {
+            const char* name;
+            const char* fen;
+        };
+
+        PositionInfo positions[] = {
+            { "starting",     Starting_Position_Fen },
+            { "kiwipete",     Kiwipete_Fen },
+        };
+
+        auto network = NnueNetwork::fromWeights (NnueWeights::random (Network_Seed));
+        PawnHashTable pawn_table;
+
+        for (const auto& pos : positions)
+        {
+            FenParser parser { pos.fen };
+            auto parent = parser.buildBoard();
+            auto children = childPositions (pos.fen);
+
+            bench.batch (children.size()).unit ("eval");
+
+            bench.run (
+                string { "eval/classic/" } + pos.name,
+                [&] {
+                    int total = 0;
+                    for (const auto& child : children)
+                        total += evaluate (child.board, child.who, 1, pawn_table);
+                    ankerl::nanobench::doNotOptimizeAway (total);
+                }
+            );
+
+            for (auto kernel : { NnueKernel::Scalar, NnueKernel::Sse41, NnueKernel::Avx2 })
+            {
+                if (!isNnueKernelSupported (kernel))
+                    continue;
+
+                network->setKernel (kernel);
+                NnueAccumulator parent_accumulator {};
+                NnueAccumulator child_accumulator {};
+                network->refresh (parent, parent_accumulator);
+
+                // What the search does at a leaf: update from the parent, then
+                // evaluate.
+                bench.run (
+                    "eval/nnue-" + asString (kernel) + "/" + pos.name,
+                    [&] {
+                        int total = 0;
+                        for (const auto& child : children)
+                        {
+                            network->update (parent_accumulator, child.board, child_accumulator);
+                            total += evaluate (child.board, child.who, 1, *network, child_accumulator);
+                        }
+                        ankerl::nanobench::doNotOptimizeAway (total);
+                    }
+                );
+            }
+
+            bench.batch (1).unit ("op");
+        }
+    }
+}
@@ -0,0 +1,56 @@
+#include <nanobench.h>
+
+#include <stop_token>
+#include <thread>
+
+#include "wisdom-chess/engine/game.hpp"
+#include "wisdom-chess/engine/logger.hpp"
+#include "wisdom-chess/engine/search_worker.hpp"
+
+#include "bench_positions.hpp"
+
+namespace wisdom::bench
+{
+    static constexpr int Searches_Per_Run = 100;
+
+    // Depth 1 searches, as for "go depth 1", so the cost of getting a search
+    // onto a thread isn't hidden by the search itself.
+    void runSearchWorkerBenchmarks (ankerl::nanobench::Bench& bench)
+    {
+        auto game = Game::createGameFromFen (Kiwipete_Fen);
+        game.setMaxDepth (1);
+        auto logger = makeNullLogger();
+        optional<Move> best_move;
+
+        auto search = [&] (std::stop_token stop_token)
+        {
+            best_move = game.findBestMove (logger, std::move (stop_token));
+        };
+
+        bench.batch (Searches_Per_Run).unit ("search");
+
+        SearchWorker worker;
+        bench.run (
+            "search-worker/depth-1",
+            [&] {
+                for (int i = 0; i < Searches_Per_Run; i++)
+                {
+                    worker.start (search);
+                    worker.wait();
+                }
+                ankerl::nanobench::doNotOptimizeAway (best_move);
+            }
+        );
+
+        bench.run (
+            "thread-per-search/depth-1",
+            [&] {
+                for (int i = 0; i < Searches_Per_Run; i++)
+                    std::jthread { search }.join();
+                ankerl::nanobench::doNotOptimizeAway (best_move);
+            }
+        );
+
+        bench.batch (1).unit ("op");
+    }
+}
@@ -0,0 +1,91 @@
+#include <nanobench.h>
+
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+#include <iomanip>
+
+#include "wisdom-chess/engine/transposition_table.hpp"
+
+namespace wisdom::bench
+{
+    // Table sizes covering the default up to large analysis hashes.
+    static constexpr int Table_Sizes_In_Megabytes[] = { 16, 256, 1024, 4096 };
+
+    // Sizes to save and load. Smaller, to keep the files written to disk down.
+    static constexpr int File_Sizes_In_Megabytes[] = { 16, 1024 };
+
+    template <typename Operation>
+    static auto timeMilliseconds (Operation&& operation) -> double
+    {
+        auto start = std::chrono::steady_clock::now();
+        operation();
+        auto end = std::chrono::steady_clock::now();
+        return std::chrono::duration<double, std::milli> (end - start).count();
+    }
+
+    static void printLatency (const char* label, int size_in_megabytes, double milliseconds)
+    {
+        std::cout << "  " << label << " (" << size_in_megabytes << " MB): "
+                  << std::fixed << std::setprecision (3) << milliseconds << " ms\n";
+    }
+
+    void runTranspositionTableBenchmarks ([[maybe_unused]] ankerl::nanobench::Bench& bench)
+    {
+        for (auto size : Table_Sizes_In_Megabytes)
+        {
+            try
+            {
+                // Allocation is what the engine pays between startup and "uciok",
+                // and clearing is what "ucinewgame" pays before "readyok".
+                optional<TranspositionTable> table;
+                auto allocate_time = timeMilliseconds ([&] {
+                    table.emplace (TranspositionTable::fromMegabytes (size));
+                });
+                printLatency ("tt/allocate", size, allocate_time);
+
+                auto first_clear_time = timeMilliseconds ([&] { table->clear(); });
+                printLatency ("tt/clear-untouched", size, first_clear_time);
+
+                // Fill every entry, so the clear has to touch the whole table.
+                for (size_t i = 1; i <= table->getSize(); i++)
+                    table->store (i, 0, 1, BoundType::Exact, Move::make (0, 0, 1, 1), 0);
+
+                auto second_clear_time = timeMilliseconds ([&] { table->clear(); });
+                printLatency ("tt/clear", size, second_clear_time);
+            }
+            catch (const std::bad_alloc&)
+            {
+                std::cout << "  tt (" << size << " MB): not enough memory, skipped\n";
+            }
+        }
+
+        auto path = (std::filesystem::temp_directory_path() / "wisdom-chess-bench.hash").string();
+        for (auto size : File_Sizes_In_Megabytes)
+        {
+            try
+            {
+                auto table = TranspositionTable::fromMegabytes (size);
+                table.store (1, 0, 1, BoundType::Exact, Move::make (0, 0, 1, 1), 0);
+
+                auto save_time = timeMilliseconds ([&] { table.saveTo (path); });
+                printLatency ("tt/save", size, save_time);
+
+                auto loaded = TranspositionTable::fromMegabytes (1);
+                auto load_time = timeMilliseconds ([&] { loaded.loadFrom (path); });
+                printLatency ("tt/load", size, load_time);
+            }
+            catch (const std::bad_alloc&)
+            {
+                std::cout << "  tt/save (" << size << " MB): not enough memory, skipped\n";
+            }
+            catch (const TranspositionTableFileError& error)
+            {
+                std::cout << "  tt/save (" << size << " MB): " << error.message() << ", skipped\n";
+            }
+        }
+
+        std::error_code ignored;
+        std::filesystem::remove (path, ignored);
+    }
+}
@@ -15,9 +15,20 @@ namespace wisdom
     {
     }
 
+    [[nodiscard]] static auto
+    pawnCodeFromSquares (span<const ColoredPiece, Num_Squares> squares)
+        -> BoardHashCode
+    {
+        BoardHashCode result = 0;
+        for (auto coord : Board::allCoords())
+            result ^= pawnCodeHash (coord, squares[coord.index()]);
+        return result;
+    }
+
     Board::Board (const BoardBuilder& builder)
         : my_squares { builder.getSquares() }
         , my_code { BoardCode::fromBoardBuilder (builder) }
+        , my_pawn_code { pawnCodeFromSquares (my_squares) }
         , my_king_pos { builder.getKingPositions() }
         , my_half_move_clock { builder.getHalfMoveClock() }
         , my_full_move_clock { builder.getFullMoveClock() }
@@ -289,6 +300,7 @@ namespace wisdom
 
         // update the board code:
         result.my_code = BoardCode::fromBoard (result);
+        result.my_pawn_code = pawnCodeFromSquares (result.my_squares);
         return result;
     }
 
@@ -14,6 +14,17 @@ namespace wisdom
 {
     class BoardBuilder;
 
+    // A square changed by the last move made on a board.
+    struct SquareChange
+    {
+        Coord coord;
+        ColoredPiece removed;
+        ColoredPiece added;
+    };
+
+    // Castling changes the most squares: both the king's and the rook's.
+    inline constexpr int Max_Square_Changes = 4;
+
     class Board
     {
     public:
@@ -92,6 +103,14 @@ namespace wisdom
             return my_code;
         }
 
+        // A hash of only the pawns on the board, for caching pawn structure.
+        [[nodiscard]] auto
+        getPawnCode() const noexcept
+            -> BoardHashCode
+        {
+            return my_pawn_code;
+        }
+
         [[nodiscard]] auto
         getMaterial() const& noexcept
             -> const Material&
@@ -108,6 +127,16 @@ namespace wisdom
         }
         void getPosition() const&& = delete;
 
+        // The squares changed by the move that created this board, for
+        // updating evaluation state incrementally. Empty for a board that
+        // wasn't made by a move.
+        [[nodiscard]] auto
+        getLastMoveChanges() const noexcept
+            -> span<const SquareChange>
+        {
+            return span<const SquareChange> { my_changes.data(), static_cast<size_t> (my_change_count) };
+        }
+
         [[nodiscard]] auto
         toFenString (Color turn) const
             -> string;
@@ -256,6 +285,9 @@ namespace wisdom
         // Keep track of hashing information.
         BoardCode my_code;
 
+        // Hash of the pawns alone, updated whenever a square is set.
+        BoardHashCode my_pawn_code = 0;
+
         // Number of half moves since pawn or capture.
         int my_half_move_clock = 0;
 
@@ -270,6 +302,10 @@ namespace wisdom
 
         // positions of the kings.
         array<Coord, Num_Players> my_king_pos;
+
+        // The squares changed by the last move.
+        array<SquareChange, Max_Square_Changes> my_changes {};
+        int8_t my_change_count = 0;
     };
 
     constexpr auto 
@@ -47,6 +47,24 @@ namespace wisdom
 
     inline constexpr BoardCodeArray Hash_Code_Table = initializeBoardCodes();
 
+    // A fingerprint of the Zobrist table, so that hash codes saved to disk
+    // by a build with a different table can be detected and rejected.
+    [[nodiscard]] consteval auto
+    fingerprintBoardCodes (const BoardCodeArray& codes)
+        -> std::uint64_t
+    {
+        // FNV-1a over each 64-bit value.
+        std::uint64_t result = 0xcbf29ce484222325ULL;
+        for (auto code : codes)
+        {
+            result ^= code;
+            result *= 0x100000001b3ULL;
+        }
+        return result;
+    }
+
+    inline constexpr std::uint64_t Hash_Code_Table_Fingerprint = fingerprintBoardCodes (Hash_Code_Table);
+
     inline constexpr int Total_Metadata_Bits = 16;
 
 
@@ -60,6 +78,15 @@ namespace wisdom
         return Hash_Code_Table[piece_index * Num_Squares + coord_index] << Total_Metadata_Bits;
     }
 
+    // The hash contribution of a piece to the pawn code, which covers only
+    // the pawns on the board. Other pieces don't change the pawn code.
+    [[nodiscard]] constexpr auto
+    pawnCodeHash (Coord coord, ColoredPiece piece)
+        -> BoardHashCode
+    {
+        return piece.type() == Piece::Pawn ? boardCodeHash (coord, piece) : 0;
+    }
+
     class BoardCode final
     {
     private:
@@ -0,0 +1,389 @@
+#include "wisdom-chess/engine/endgame.hpp"
+#include "wisdom-chess/engine/board.hpp"
+#include "wisdom-chess/engine/material.hpp"
+
+namespace wisdom
+{
+    // Bonus for each row the pawn has advanced in a won king and pawn ending.
+    static constexpr int Pawn_Advance_Bonus = 40;
+
+    // Bonuses for driving the lone king toward the edge or the right corner,
+    // and for bringing the stronger king closer to it.
+    static constexpr int Edge_Bonus = 60;
+    static constexpr int Corner_Bonus = 40;
+    static constexpr int King_Proximity_Bonus = 20;
+
+    [[nodiscard]] static constexpr auto
+    squareDistance (int first, int second)
+        -> int
+    {
+        int row_distance = first / Num_Columns - second / Num_Columns;
+        int col_distance = first % Num_Columns - second % Num_Columns;
+        return std::max (row_distance < 0 ? -row_distance : row_distance,
+                         col_distance < 0 ? -col_distance : col_distance);
+    }
+
+    [[nodiscard]] static auto
+    squareDistance (Coord first, Coord second)
+        -> int
+    {
+        return squareDistance (first.index(), second.index());
+    }
+
+    [[nodiscard]] static auto
+    manhattanDistance (Coord first, Coord second)
+        -> int
+    {
+        return std::abs (first.row<int>() - second.row<int>())
+            + std::abs (first.column<int>() - second.column<int>());
+    }
+
+    // King and pawn against king positions are stored with the pawn's side
+    // as white and the pawn on the queen side, which covers the rest by
+    // symmetry. The pawn can only be on the six rows between the first and
+    // last.
+    static constexpr int Kpk_Pawn_Columns = Num_Columns / 2;
+    static constexpr int Kpk_Pawn_Rows = Num_Rows - 2;
+    static constexpr int Kpk_Position_Count
+        = Kpk_Pawn_Columns * Kpk_Pawn_Rows * Num_Squares * Num_Squares * Num_Players;
+
+    using KpkBitbase = array<uint64_t, Kpk_Position_Count / 64>;
+
+    [[nodiscard]] static constexpr auto
+    kpkIndex (int strong_king, int pawn, int weak_king, bool strong_to_move)
+        -> int
+    {
+        int pawn_row = pawn / Num_Columns - 1;
+        int pawn_col = pawn % Num_Columns;
+
+        return (((pawn_col * Kpk_Pawn_Rows + pawn_row) * Num_Squares + strong_king)
+                * Num_Squares + weak_king) * Num_Players + (strong_to_move ? 0 : 1);
+    }
+
+    // Results while generating the bitbase, as bits so that the results
+    // after every move from a position can be combined.
+    static constexpr uint8_t Kpk_Invalid = 0;
+    static constexpr uint8_t Kpk_Unknown = 1;
+    static constexpr uint8_t Kpk_Draw = 2;
+    static constexpr uint8_t Kpk_Win = 4;
+
+    // Whether the white pawn attacks the square.
+    [[nodiscard]] static constexpr auto
+    isPawnAttack (int pawn, int square)
+        -> bool
+    {
+        int col_distance = square % Num_Columns - pawn % Num_Columns;
+        return square / Num_Columns == pawn / Num_Columns - 1
+            && (col_distance == 1 || col_distance == -1);
+    }
+
+    // Call the function with each square a king on the square can move to.
+    static void
+    forEachKingMove (int square, auto function)
+    {
+        int row = square / Num_Columns;
+        int col = square % Num_Columns;
+
+        for (int row_offset = -1; row_offset <= 1; row_offset++)
+        {
+            for (int col_offset = -1; col_offset <= 1; col_offset++)
+            {
+                if ((row_offset != 0 || col_offset != 0)
+                    && isValidRow (row + row_offset)
+                    && isValidColumn (col + col_offset))
+                {
+                    function ((row + row_offset) * Num_Columns + col + col_offset);
+                }
+            }
+        }
+    }
+
+    // The result of the positions that are decided without looking at any
+    // moves: illegal positions, immediate promotions, captures of the pawn
+    // and stalemates.
+    [[nodiscard]] static auto
+    initialKpkResult (int strong_king, int pawn, int weak_king, bool strong_to_move)
+        -> uint8_t
+    {
+        if (strong_king == weak_king || strong_king == pawn || weak_king == pawn
+            || squareDistance (strong_king, weak_king) <= 1)
+        {
+            return Kpk_Invalid;
+        }
+
+        if (strong_to_move)
+        {
+            if (isPawnAttack (pawn, weak_king))
+                return Kpk_Invalid;
+
+            int promotion = pawn - Num_Columns;
+            if (pawn / Num_Columns == 1 && promotion != strong_king && promotion != weak_king
+                && (squareDistance (weak_king, promotion) > 1 || squareDistance (strong_king, promotion) == 1))
+            {
+                return Kpk_Win;
+            }
+
+            return Kpk_Unknown;
+        }
+
+        bool has_move = false;
+        forEachKingMove (weak_king, [&] (int square)
+        {
+            if (squareDistance (square, strong_king) > 1 && !isPawnAttack (pawn, square))
+                has_move = true;
+        });
+
+        if (!has_move)
+            return isPawnAttack (pawn, weak_king) ? Kpk_Win : Kpk_Draw;
+
+        if (squareDistance (weak_king, pawn) == 1 && squareDistance (strong_king, pawn) > 1)
+            return Kpk_Draw;
+
+        return Kpk_Unknown;
+    }
+
+    // Look at the results after each move to decide a position: the pawn's
+    // side wins if any move wins, and the lone king draws if any move draws.
+    [[nodiscard]] static auto
+    classifyKpkPosition (
+        const vector<uint8_t>& results,
+        int strong_king,
+        int pawn,
+        int weak_king,
+        bool strong_to_move
+    )
+        -> uint8_t
+    {
+        uint8_t combined = 0;
+
+        if (strong_to_move)
+        {
+            forEachKingMove (strong_king, [&] (int square)
+            {
+                if (square != pawn)
+                    combined |= results[kpkIndex (square, pawn, weak_king, false)];
+            });
+
+            // Moves to the last row were already decided as promotions.
+            int push = pawn - Num_Columns;
+            if (pawn / Num_Columns > 1 && push != strong_king && push != weak_king)
+            {
+                combined |= results[kpkIndex (strong_king, push, weak_king, false)];
+
+                int double_push = push - Num_Columns;
+                if (pawn / Num_Columns == Last_Row - 1 && double_push != strong_king && double_push != weak_king)
+                    combined |= results[kpkIndex (strong_king, double_push, weak_king, false)];
+            }
+
+            return (combined & Kpk_Win) ? Kpk_Win
+                : (combined & Kpk_Unknown) ? Kpk_Unknown
+                : Kpk_Draw;
+        }
+
+        forEachKingMove (weak_king, [&] (int square)
+        {
+            combined |= results[kpkIndex (strong_king, pawn, square, true)];
+        });
+
+        return (combined & Kpk_Draw) ? Kpk_Draw
+            : (combined & Kpk_Unknown) ? Kpk_Unknown
+            : Kpk_Win;
+    }
+
+    // Call the function with every position in the order of its index.
+    static void
+    forEachKpkPosition (auto function)
+    {
+        int index = 0;
+        for (int pawn_col = 0; pawn_col < Kpk_Pawn_Columns; pawn_col++)
+        {
+            for (int pawn_row = 1; pawn_row <= Kpk_Pawn_Rows; pawn_row++)
+            {
+                int pawn = pawn_row * Num_Columns + pawn_col;
+                for (int strong_king = 0; strong_king < Num_Squares; strong_king++)
+                {
+                    for (int weak_king = 0; weak_king < Num_Squares; weak_king++)
+                    {
+                        function (index++, strong_king, pawn, weak_king, true);
+                        function (index++, strong_king, pawn, weak_king, false);
+                    }
+                }
+            }
+        }
+    }
+
+    [[nodiscard]] static auto
+    generateKpkBitbase()
+        -> KpkBitbase
+    {
+        vector<uint8_t> results (Kpk_Position_Count);
+
+        forEachKpkPosition ([&] (int index, int strong_king, int pawn, int weak_king, bool strong_to_move)
+        {
+            assert (index == kpkIndex (strong_king, pawn, weak_king, strong_to_move));
+            results[index] = initialKpkResult (strong_king, pawn, weak_king, strong_to_move);
+        });
+
+        // Work back from the decided positions until nothing changes. The
+        // positions still undecided after that can't be won.
+        bool changed = true;
+        while (changed)
+        {
+            changed = false;
+            forEachKpkPosition ([&] (int index, int strong_king, int pawn, int weak_king, bool strong_to_move)
+            {
+                if (results[index] != Kpk_Unknown)
+                    return;
+
+                auto result = classifyKpkPosition (results, strong_king, pawn, weak_king, strong_to_move);
+                if (result != Kpk_Unknown)
+                {
+                    results[index] = result;
+                    changed = true;
+                }
+            });
+        }
+
+        KpkBitbase bitbase {};
+        for (int index = 0; index < Kpk_Position_Count; index++)
+        {
+            if (results[index] == Kpk_Win)
+                bitbase[index / 64] |= uint64_t { 1 } << (index % 64);
+        }
+        return bitbase;
+    }
+
+    [[nodiscard]] static auto
+    kpkBitbase()
+        -> const KpkBitbase&
+    {
+        static const KpkBitbase bitbase = generateKpkBitbase();
+        return bitbase;
+    }
+
+    auto
+    isKingPawnVsKingWin (Coord strong_king, Coord pawn, Coord weak_king, Color strong_side, Color to_move)
+        -> bool
+    {
+        bool flip_columns = pawn.column<int>() >= Kpk_Pawn_Columns;
+
+        auto normalize = [&] (Coord coord) -> int
+        {
+            int row = strong_side == Color::White ? coord.row<int>() : Last_Row - coord.row<int>();
+            int col = flip_columns ? Last_Column - coord.column<int>() : coord.column<int>();
+            return row * Num_Columns + col;
+        };
+
+        int index = kpkIndex (normalize (strong_king), normalize (pawn), normalize (weak_king), to_move == strong_side);
+        return (kpkBitbase()[index / 64] >> (index % 64)) & 1;
+    }
+
+    [[nodiscard]] static auto
+    findPiece (const Board& board, ColoredPiece piece)
+        -> Coord
+    {
+        auto squares = board.squareData();
+        auto found = std::find (squares.begin(), squares.end(), piece);
+        Expects (found != squares.end());
+        return Coord::fromIndex (narrow<int> (found - squares.begin()));
+    }
+
+    // The specialized evaluators give the score from the point of view of
+    // the stronger side.
+    using EndgameEvaluator = auto (*) (const Board& board, Color strong_side, Color who) -> int;
+
+    [[nodiscard]] static auto
+    evaluateKingPawnVsKing (const Board& board, Color strong_side, Color who)
+        -> int
+    {
+        auto pawn = findPiece (board, ColoredPiece::make (strong_side, Piece::Pawn));
+        auto strong_king = board.getKingPosition (strong_side);
+        auto weak_king = board.getKingPosition (colorInvert (strong_side));
+
+        if (!isKingPawnVsKingWin (strong_king, pawn, weak_king, strong_side, who))
+            return 0;
+
+        int rows_advanced = strong_side == Color::White
+            ? Last_Row - pawn.row<int>()
+            : pawn.row<int>();
+
+        return Known_Win_Score + Material::scaledScore (WeightPawn) + rows_advanced * Pawn_Advance_Bonus;
+    }
+
+    // Checkmate with a bishop and knight can only be forced in a corner the
+    // bishop can reach.
+    [[nodiscard]] static auto
+    evaluateKingBishopKnightVsKing (const Board& board, Color strong_side, [[maybe_unused]] Color who)
+        -> int
+    {
+        auto bishop = findPiece (board, ColoredPiece::make (strong_side, Piece::Bishop));
+        auto strong_king = board.getKingPosition (strong_side);
+        auto weak_king = board.getKingPosition (colorInvert (strong_side));
+
+        bool light_squares = (bishop.row<int>() + bishop.column<int>()) % 2 == 0;
+        auto first_corner = light_squares ? makeCoord (First_Row, First_Column) : makeCoord (Last_Row, First_Column);
+        auto second_corner = light_squares ? makeCoord (Last_Row, Last_Column) : makeCoord (First_Row, Last_Column);
+
+        int corner_distance = std::min (manhattanDistance (weak_king, first_corner),
+                                        manhattanDistance (weak_king, second_corner));
+
+        return Known_Win_Score + board.getMaterial().overallScore (strong_side)
+            + (Last_Row + Last_Column - corner_distance) * Corner_Bonus
+            + (Last_Row - squareDistance (strong_king, weak_king)) * King_Proximity_Bonus;
+    }
+
+    [[nodiscard]] static auto
+    evaluateKingAndMajorVsKing (const Board& board, Color strong_side, [[maybe_unused]] Color who)
+        -> int
+    {
+        auto strong_king = board.getKingPosition (strong_side);
+        auto weak_king = board.getKingPosition (colorInvert (strong_side));
+
+        // From zero in the center to three on the edge.
+        int edge_distance = std::max (std::abs (2 * weak_king.row<int>() - Last_Row),
+                                      std::abs (2 * weak_king.column<int>() - Last_Column)) / 2;
+
+        return Known_Win_Score + board.getMaterial().overallScore (strong_side)
+            + edge_distance * Edge_Bonus
+            + (Last_Row - squareDistance (strong_king, weak_king)) * King_Proximity_Bonus;
+    }
+
+    // The specialized evaluators, by the type of ending.
+    static constexpr array<EndgameEvaluator, Num_Endgame_Types> Endgame_Evaluators = {
+        nullptr,                            // None
+        evaluateKingPawnVsKing,             // KingPawnVsKing
+        evaluateKingBishopKnightVsKing,     // KingBishopKnightVsKing
+        evaluateKingAndMajorVsKing,         // KingAndMajorVsKing
+    };
+
+    auto
+    evaluateEndgame (const Board& board, Color who)
+        -> optional<int>
+    {
+        auto info = board.getMaterial().info();
+        auto evaluator = Endgame_Evaluators[static_cast<size_t> (info.endgame)];
+        if (evaluator == nullptr)
+            return nullopt;
+
+        auto score = evaluator (board, info.strong_side, who);
+        return who == info.strong_side ? score : -score;
+    }
+
+    auto
+    isKnownEndgameDraw (const Board& board, Color who)
+        -> bool
+    {
+        auto info = board.getMaterial().info();
+        if (info.endgame != EndgameType::KingPawnVsKing)
+            return false;
+
+        auto pawn = findPiece (board, ColoredPiece::make (info.strong_side, Piece::Pawn));
+        return !isKingPawnVsKingWin (
+            board.getKingPosition (info.strong_side),
+            pawn,
+            board.getKingPosition (colorInvert (info.strong_side)),
+            info.strong_side,
+            who
+        );
+    }
+}
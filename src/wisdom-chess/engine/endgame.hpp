@@ -0,0 +1,35 @@
+#pragma once
+
+#include "wisdom-chess/engine/global.hpp"
+#include "wisdom-chess/engine/coord.hpp"
+#include "wisdom-chess/engine/piece.hpp"
+
+namespace wisdom
+{
+    class Board;
+
+    // The score of a position known to be won before a checkmate has been
+    // found. Higher than any advantage in material, so the search heads for
+    // these positions, but lower than any checkmate.
+    inline constexpr int Known_Win_Score = 10 * WeightQueen * Material_Score_Scale;
+    static_assert (Known_Win_Score * 2 < Max_Non_Checkmate_Score);
+
+    // Whether the side with the pawn wins a king and pawn against king
+    // ending. Looks up a bitbase generated by retrograde analysis the first
+    // time it's needed.
+    [[nodiscard]] auto
+    isKingPawnVsKingWin (Coord strong_king, Coord pawn, Coord weak_king, Color strong_side, Color to_move)
+        -> bool;
+
+    // Evaluate an ending that has a specialized evaluator for the material on
+    // the board, from the point of view of the player to move. Returns
+    // nullopt when there's no evaluator for the material.
+    [[nodiscard]] auto
+    evaluateEndgame (const Board& board, Color who)
+        -> optional<int>;
+
+    // Whether the position is a known draw, however it's played from here.
+    [[nodiscard]] auto
+    isKnownEndgameDraw (const Board& board, Color who)
+        -> bool;
+}
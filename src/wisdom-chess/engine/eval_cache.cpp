@@ -0,0 +1,111 @@
+#include <atomic>
+
+#include "wisdom-chess/engine/eval_cache.hpp"
+#include "wisdom-chess/engine/transposition_table.hpp"
+
+namespace wisdom
+{
+    // Mixed into the key for black to move, so each side gets its own entry.
+    static constexpr uint64_t Black_To_Move_Key = 0x9e37'79b9'7f4a'7c15ULL;
+
+    [[nodiscard]] static auto
+    evalCacheKey (BoardHashCode code, Color who)
+        -> uint64_t
+    {
+        return who == Color::Black ? code ^ Black_To_Move_Key : code;
+    }
+
+    // The upper half of the entry holds the upper half of the key. Together
+    // with the entry's index, which also depends on the lower half, that's
+    // enough to tell positions apart.
+    [[nodiscard]] static auto
+    keyCheck (uint64_t key)
+        -> uint64_t
+    {
+        return key & 0xffff'ffff'0000'0000ULL;
+    }
+
+    [[nodiscard]] static auto
+    entryCountFromMegabytes (int size_in_megabytes)
+        -> size_t
+    {
+        constexpr size_t bytes_per_mb = 1024 * 1024;
+        size_t entry_count = (static_cast<size_t> (size_in_megabytes) * bytes_per_mb) / sizeof (uint64_t);
+
+        if (entry_count == 0)
+            return 0;
+
+        // Round down to a power of two, so the index can be found with a mask.
+        size_t power_of_2 = 1;
+        while (power_of_2 * 2 <= entry_count)
+            power_of_2 <<= 1;
+
+        return power_of_2;
+    }
+
+    auto
+    EvalCache::fromMegabytes (int size_in_megabytes)
+        -> EvalCache
+    {
+        EvalCache result;
+        result.resize (size_in_megabytes);
+        return result;
+    }
+
+    auto
+    EvalCache::probe (BoardHashCode code, Color who)
+        -> optional<int>
+    {
+        if (!isEnabled())
+            return nullopt;
+
+        my_probes++;
+
+        auto key = evalCacheKey (code, who);
+        auto& entry = my_entries[foldHashTo32Bits (key) & my_size_mask];
+        auto value = std::atomic_ref<uint64_t> { entry }.load (std::memory_order_relaxed);
+
+        if (value == 0 || keyCheck (value) != keyCheck (key))
+            return nullopt;
+
+        my_hits++;
+        return static_cast<int32_t> (static_cast<uint32_t> (value));
+    }
+
+    void
+    EvalCache::store (BoardHashCode code, Color who, int score)
+    {
+        if (!isEnabled())
+            return;
+
+        auto key = evalCacheKey (code, who);
+        auto& entry = my_entries[foldHashTo32Bits (key) & my_size_mask];
+        auto value = keyCheck (key) | static_cast<uint32_t> (score);
+
+        std::atomic_ref<uint64_t> { entry }.store (value, std::memory_order_relaxed);
+    }
+
+    void
+    EvalCache::clear()
+    {
+        std::fill (my_entries.begin(), my_entries.end(), 0);
+        my_probes = 0;
+        my_hits = 0;
+    }
+
+    void
+    EvalCache::resize (int size_in_megabytes)
+    {
+        Expects (size_in_megabytes >= 0);
+
+        auto entry_count = entryCountFromMegabytes (size_in_megabytes);
+
+        // Release the old entries before allocating, to not need both at once.
+        my_entries = vector<uint64_t> {};
+        my_entries.resize (entry_count);
+        my_size_mask = entry_count > 0 ? entry_count - 1 : 0;
+        my_size_in_megabytes = size_in_megabytes;
+        my_probes = 0;
+        my_hits = 0;
+    }
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include "wisdom-chess/engine/global.hpp"
+#include "wisdom-chess/engine/board_code.hpp"
+
+namespace wisdom
+{
+    struct EvalCacheStats
+    {
+        size_t probes = 0;
+        size_t hits = 0;
+    };
+
+    [[nodiscard]] inline auto
+    computeHitRate (const EvalCacheStats& start, const EvalCacheStats& end)
+        -> double
+    {
+        auto delta_probes = end.probes - start.probes;
+        auto delta_hits = end.hits - start.hits;
+        return delta_probes > 0 ? (100.0 * static_cast<double> (delta_hits) / static_cast<double> (delta_probes)) : 0.0;
+    }
+
+    // Caches the static evaluation of positions, from the point of view of
+    // the side to move. Transpositions reach the same positions over and
+    // over, and the evaluation at the leaves doesn't depend on how they
+    // were reached.
+    //
+    // Each entry is a single word holding part of the key and the score,
+    // which is read and written atomically, so the cache can be shared by
+    // searches running at the same time without locking.
+    //
+    // The cache is off by default: the evaluation is mostly incremental and
+    // cheap enough that a miss in a large table costs about as much as it
+    // saves. See the benchmark for the comparison.
+    class EvalCache
+    {
+    public:
+        static constexpr int Default_Size_In_Megabytes = 0;
+
+        // A cache with a size of zero is disabled: it never stores anything.
+        [[nodiscard]] static auto
+        fromMegabytes (int size_in_megabytes)
+            -> EvalCache;
+
+        [[nodiscard]] auto
+        probe (BoardHashCode code, Color who)
+            -> optional<int>;
+
+        void store (BoardHashCode code, Color who, int score);
+
+        void clear();
+
+        // Change the size of the cache, discarding its contents.
+        void resize (int size_in_megabytes);
+
+        [[nodiscard]] auto
+        isEnabled() const
+            -> bool
+        {
+            return !my_entries.empty();
+        }
+
+        [[nodiscard]] auto
+        getSize() const
+            -> size_t
+        {
+            return my_entries.size();
+        }
+
+        [[nodiscard]] auto
+        getSizeInMegabytes() const
+            -> int
+        {
+            return my_size_in_megabytes;
+        }
+
+        [[nodiscard]] auto
+        getStats() const
+            -> EvalCacheStats
+        {
+            return EvalCacheStats { my_probes, my_hits };
+        }
+
+    private:
+        EvalCache() = default;
+
+        vector<uint64_t> my_entries;
+        size_t my_size_mask = 0;
+        int my_size_in_megabytes = 0;
+        size_t my_probes = 0;
+        size_t my_hits = 0;
+    };
+}
@@ -1,5 +1,9 @@
 #include "wisdom-chess/engine/evaluate.hpp"
+#include "wisdom-chess/engine/attack_counts.hpp"
 #include "wisdom-chess/engine/board.hpp"
+#include "wisdom-chess/engine/endgame.hpp"
+#include "wisdom-chess/engine/nnue.hpp"
+#include "wisdom-chess/engine/pawn_structure.hpp"
 #include "wisdom-chess/engine/position.hpp"
 #include "wisdom-chess/engine/search.hpp"
 
@@ -53,25 +57,228 @@ namespace wisdom
         return result;
     }
 
-    auto 
-    evaluate (const Board& board, Color who, int moves_away) 
+    // The terms that are kept up to date as moves are made, and so cost
+    // almost nothing to evaluate: material and piece-squares.
+    [[nodiscard]] static auto
+    cheapScore (const Board& board, Color who)
+        -> int
+    {
+        const auto& material = board.getMaterial();
+        return board.getPosition().overallScore (who, material.info().phase)
+            + material.imbalanceScore (who);
+    }
+
+    // The rest of the evaluation, which has to look at the board: pawn
+    // structure, mobility, king safety and castling.
+    [[nodiscard]] static auto
+    expensiveScore (const Board& board, Color who, const PawnStructure& pawn_structure)
         -> int
     {
         int score = 0;
         Color opponent = colorInvert (who);
 
+        score += pawn_structure.overallScore (who);
+        score += countAttacks (board).overallScore (who, board.getMaterial().info().phase);
+
+        score -= unableToCastlePenalty (board, who);
+        score += unableToCastlePenalty (board, opponent);
+
+        return score;
+    }
+
+    [[nodiscard]] static auto
+    evaluateWithPawnStructure (
+        const Board& board,
+        Color who,
+        int moves_away,
+        const PawnStructure& pawn_structure
+    )
+        -> int
+    {
         if (isPlayerCheckmated (board, who))
         {
             return -1 * checkmateScoreInMoves (moves_away);
         }
 
-        score += board.getMaterial().overallScore (who);
-        score += board.getPosition().overallScore (who);
+        if (auto endgame_score = evaluateEndgame (board, who))
+            return *endgame_score;
 
-        score -= unableToCastlePenalty (board, who);
-        score += unableToCastlePenalty (board, opponent);
+        return cheapScore (board, who) + expensiveScore (board, who, pawn_structure);
+    }
 
-        return score;
+    auto 
+    evaluate (const Board& board, Color who, int moves_away) 
+        -> int
+    {
+        return evaluateWithPawnStructure (board, who, moves_away, analyzePawnStructure (board));
+    }
+
+    auto
+    evaluate (const Board& board, Color who, int moves_away, PawnHashTable& pawn_table)
+        -> int
+    {
+        return evaluateWithPawnStructure (board, who, moves_away, pawn_table.probe (board));
+    }
+
+    auto
+    evaluate (
+        const Board& board,
+        Color who,
+        int moves_away,
+        PawnHashTable& pawn_table,
+        int alpha,
+        int beta,
+        int margin,
+        LazyEvaluationStats& stats
+    )
+        -> int
+    {
+        // Only a player in check can be checkmated, and that has to be found
+        // by the full evaluation.
+        auto king_coord = board.getKingPosition (who);
+        if (isKingThreatened (board, who, king_coord))
+        {
+            stats.full_evaluations++;
+            return evaluate (board, who, moves_away, pawn_table);
+        }
+
+        if (auto endgame_score = evaluateEndgame (board, who))
+        {
+            stats.full_evaluations++;
+            return *endgame_score;
+        }
+
+        int score = cheapScore (board, who);
+        if (score + margin <= alpha || score - margin >= beta)
+        {
+            stats.cheap_exits++;
+            return score;
+        }
+
+        stats.full_evaluations++;
+        return score + expensiveScore (board, who, pawn_table.probe (board));
+    }
+
+    auto
+    evaluate (
+        const Board& board,
+        Color who,
+        int moves_away,
+        const NnueNetwork& network,
+        const NnueAccumulator& accumulator
+    )
+        -> int
+    {
+        if (isPlayerCheckmated (board, who))
+            return -1 * checkmateScoreInMoves (moves_away);
+
+        if (auto endgame_score = evaluateEndgame (board, who))
+            return *endgame_score;
+
+        // Keep whatever the network says away from the checkmate scores.
+        return std::clamp (network.evaluate (accumulator, who), -Max_Non_Checkmate_Score, Max_Non_Checkmate_Score);
+    }
+
+    // The number of boards evaluated together. Small enough that the arrays
+    // for a batch stay in the L1 cache.
+    static constexpr int Evaluation_Batch_Size = 64;
+
+    // The terms of the evaluation for a batch of boards, one array per term,
+    // so the scores for the whole batch can be computed with vector
+    // instructions.
+    struct EvaluationBatch
+    {
+        array<int32_t, Evaluation_Batch_Size> middlegame;
+        array<int32_t, Evaluation_Batch_Size> endgame;
+        array<int32_t, Evaluation_Batch_Size> phase;
+        array<int32_t, Evaluation_Batch_Size> other;
+        array<int32_t, Evaluation_Batch_Size> my_castling;
+        array<int32_t, Evaluation_Batch_Size> their_castling;
+        array<int32_t, Evaluation_Batch_Size> my_castled;
+        array<int32_t, Evaluation_Batch_Size> their_castled;
+        array<int32_t, Evaluation_Batch_Size> checkmated;
+    };
+
+    static void
+    gatherEvaluationTerms (
+        EvaluationBatch& batch,
+        int index,
+        const Board& board,
+        Color who,
+        PawnHashTable& pawn_table
+    )
+    {
+        auto opponent = colorInvert (who);
+        const auto& material = board.getMaterial();
+        const auto& position = board.getPosition();
+        auto score = position.individualScore (who) - position.individualScore (opponent);
+
+        batch.middlegame[index] = score.middlegame;
+        batch.endgame[index] = score.endgame;
+        batch.phase[index] = material.info().phase;
+        batch.other[index] = material.imbalanceScore (who)
+            + pawn_table.probe (board).overallScore (who)
+            + countAttacks (board).overallScore (who, material.info().phase);
+        batch.my_castling[index] = toInt<uint8_t> (board.getCastlingEligibility (who));
+        batch.their_castling[index] = toInt<uint8_t> (board.getCastlingEligibility (opponent));
+        batch.my_castled[index] = heuristicIsCastled (board, who);
+        batch.their_castled[index] = heuristicIsCastled (board, opponent);
+        batch.checkmated[index] = isPlayerCheckmated (board, who);
+    }
+
+    // The same as unableToCastlePenalty(), without branches.
+    [[nodiscard]] static auto
+    batchCastlePenalty (int32_t castling, int32_t castled)
+        -> int32_t
+    {
+        int32_t either_side = toInt<uint8_t> (CastlingEligibility::Either_Side);
+        int32_t missing = ((castling & 1) ^ 1) + (((castling >> 1) & 1) ^ 1);
+        int32_t penalty = missing * Castle_Penalty - castled * 2 * Castle_Penalty;
+        return castling != either_side ? penalty : 0;
+    }
+
+    static void
+    computeBatchScores (const EvaluationBatch& batch, int count, span<int> scores)
+    {
+        for (int i = 0; i < count; i++)
+        {
+            int32_t phase = batch.phase[i];
+            int32_t score = (batch.middlegame[i] * phase + batch.endgame[i] * (Max_Game_Phase - phase))
+                / Max_Game_Phase;
+            score += batch.other[i];
+            score -= batchCastlePenalty (batch.my_castling[i], batch.my_castled[i]);
+            score += batchCastlePenalty (batch.their_castling[i], batch.their_castled[i]);
+            scores[i] = batch.checkmated[i] != 0 ? -checkmateScoreInMoves (0) : score;
+        }
+    }
+
+    void
+    evaluateBatch (span<const Board> boards, span<const Color> who, span<int> scores)
+    {
+        Expects (boards.size() == who.size() && boards.size() == scores.size());
+
+        PawnHashTable pawn_table;
+        EvaluationBatch batch;
+
+        for (size_t start = 0; start < boards.size(); start += Evaluation_Batch_Size)
+        {
+            auto count = narrow<int> (std::min<size_t> (Evaluation_Batch_Size, boards.size() - start));
+            for (int i = 0; i < count; i++)
+                gatherEvaluationTerms (batch, i, boards[start + i], who[start + i], pawn_table);
+
+            computeBatchScores (batch, count, scores.subspan (start, narrow<size_t> (count)));
+
+            // Few boards are in an ending with its own evaluator, so they
+            // are replaced afterwards instead of being added to the batch.
+            for (int i = 0; i < count; i++)
+            {
+                if (batch.checkmated[i] != 0)
+                    continue;
+
+                if (auto endgame_score = evaluateEndgame (boards[start + i], who[start + i]))
+                    scores[start + i] = *endgame_score;
+            }
+        }
     }
 
     auto 
@@ -8,6 +8,10 @@
 namespace wisdom
 {
     class Board;
+    class PawnHashTable;
+    class NnueNetwork;
+    struct NnueAccumulator;
+    struct PawnStructure;
 
     struct DrawCategory
     {
@@ -126,6 +130,59 @@ namespace wisdom
     evaluate (const Board& board, Color who, int moves_away) 
         -> int;
 
+    // Evaluate the board, using a cache for the pawn structure. Gives the same
+    // score as the version without a cache.
+    [[nodiscard]] auto
+    evaluate (const Board& board, Color who, int moves_away, PawnHashTable& pawn_table)
+        -> int;
+
+    // How often a lazy evaluation stopped after the cheap terms, and how often
+    // it had to evaluate everything.
+    struct LazyEvaluationStats
+    {
+        size_t cheap_exits = 0;
+        size_t full_evaluations = 0;
+    };
+
+    // Twice the largest the terms after the cheap ones usually add up to,
+    // in either direction.
+    inline constexpr int Default_Lazy_Evaluation_Margin = 400;
+
+    // Evaluate the board lazily: compute the cheap material and piece-square
+    // terms first, and return them alone if they are more than the margin
+    // outside the alpha-beta window, since the rest of the evaluation is
+    // unlikely to bring the score back inside it. The score returned
+    // early is only an estimate; otherwise it's the same as the full
+    // evaluation.
+    [[nodiscard]] auto
+    evaluate (
+        const Board& board,
+        Color who,
+        int moves_away,
+        PawnHashTable& pawn_table,
+        int alpha,
+        int beta,
+        int margin,
+        LazyEvaluationStats& stats
+    )
+        -> int;
+
+    // Evaluate the board with a network, from the accumulator for the board.
+    [[nodiscard]] auto
+    evaluate (
+        const Board& board,
+        Color who,
+        int moves_away,
+        const NnueNetwork& network,
+        const NnueAccumulator& accumulator
+    )
+        -> int;
+
+    // Evaluate many boards at once, for tuning and generating training data.
+    // Each score is the same as evaluate() with moves_away of zero. All three
+    // spans must be the same size.
+    void evaluateBatch (span<const Board> boards, span<const Color> who, span<int> scores);
+
     // When there are no legal moves present, return the score of this move, which
     // checks for either a stalemate or checkmate position.
     [[nodiscard]] auto 
@@ -10,6 +10,7 @@
 #include "wisdom-chess/engine/evaluate.hpp"
 #include "wisdom-chess/engine/board_builder.hpp"
 #include "wisdom-chess/engine/fen_parser.hpp"
+#include "wisdom-chess/engine/generate.hpp"
 
 namespace wisdom
 {
@@ -73,7 +74,7 @@ namespace wisdom
     {
     }
 
-    // Copy constructor
+    // Copy constructor - the copy shares the transposition table.
     Game::Game (const Game& other)
         : my_pimpl { make_unique<Impl> (*other.my_pimpl) }
     {
@@ -219,18 +220,34 @@ namespace wisdom
 
     auto Game::findBestMove (shared_ptr<Logger> logger, Color whom) const
         -> optional<Move>
+    {
+        return findBestMove (std::move (logger), std::stop_token {}, whom);
+    }
+
+    auto Game::findBestMove (shared_ptr<Logger> logger, std::stop_token stop_token, Color whom) const
+        -> optional<Move>
     {
         if (whom == Color::None)
             whom = getCurrentTurn();
 
+        MoveTimer move_timer = my_pimpl->my_move_timer;
+        move_timer.setStopToken (std::move (stop_token));
+
         IterativeSearch iterative_search = IterativeSearch::create (
             my_pimpl->my_current_board,
             my_pimpl->my_history,
             std::move (logger),
-            my_pimpl->my_move_timer,
+            move_timer,
             my_pimpl->my_max_depth,
-            my_pimpl->my_transposition_table
+            *my_pimpl->my_transposition_table,
+            *my_pimpl->my_eval_cache,
+            my_pimpl->my_network.get()
         );
+        iterative_search.setTablebase (my_pimpl->my_tablebase.get());
+        iterative_search.setNodeLimit (my_pimpl->my_node_limit);
+        iterative_search.setSearchMoves (my_pimpl->my_search_moves);
+        iterative_search.setListener (my_pimpl->my_search_listener);
+        iterative_search.setMultiPv (my_pimpl->my_multi_pv);
         SearchResult result = iterative_search.iterativelyDeepen (whom);
 
         // If user cancelled the search, discard the results.
@@ -240,6 +257,34 @@ namespace wisdom
         return result.move;
     }
 
+    auto Game::expectedReply (Move move) const
+        -> optional<Move>
+    {
+        auto board = my_pimpl->my_current_board.withMove (getCurrentTurn(), move);
+        auto reply = my_pimpl->my_transposition_table->getBestMove (board.getCode().getHashCode());
+        if (!reply.has_value())
+            return {};
+
+        // The entry could be for another position with the same hash.
+        auto legal_moves = generateLegalMoves (board, colorInvert (getCurrentTurn()));
+        if (std::find (legal_moves.begin(), legal_moves.end(), *reply) == legal_moves.end())
+            return {};
+
+        return reply;
+    }
+
+    auto Game::findBestMoveAsync (shared_ptr<Logger> logger, std::stop_token stop_token, Color whom) const
+        -> std::future<optional<Move>>
+    {
+        return std::async (
+            std::launch::async,
+            [game = Game { *this }, logger = std::move (logger), stop_token = std::move (stop_token), whom]() mutable
+            {
+                return game.findBestMove (std::move (logger), std::move (stop_token), whom);
+            }
+        );
+    }
+
     auto Game::load (const string& filename, const Players& players)
         -> optional<Game>
     {
@@ -399,14 +444,161 @@ namespace wisdom
         my_pimpl->my_max_depth = max_depth;
     }
 
-    auto Game::getSearchTimeout() const -> std::chrono::seconds
+    auto Game::getNodeLimit() const -> optional<int64_t>
+    {
+        return my_pimpl->my_node_limit;
+    }
+
+    void Game::setNodeLimit (optional<int64_t> node_limit)
+    {
+        my_pimpl->my_node_limit = node_limit;
+    }
+
+    auto Game::getMultiPv() const -> int
+    {
+        return my_pimpl->my_multi_pv;
+    }
+
+    void Game::setMultiPv (int lines)
+    {
+        my_pimpl->my_multi_pv = std::max (lines, 1);
+    }
+
+    auto Game::getSearchMoves() const -> const vector<Move>&
+    {
+        return my_pimpl->my_search_moves;
+    }
+
+    void Game::setSearchMoves (vector<Move> search_moves)
+    {
+        my_pimpl->my_search_moves = std::move (search_moves);
+    }
+
+    auto Game::getSearchTimeout() const -> std::chrono::milliseconds
+    {
+        return my_pimpl->my_move_timer.getTimeLimit();
+    }
+
+    void Game::setSearchTimeout (std::chrono::milliseconds timeout)
+    {
+        my_pimpl->my_move_timer.setTimeLimit (timeout);
+    }
+
+    void Game::setPonderHitToken (std::stop_token ponder_hit)
+    {
+        my_pimpl->my_move_timer.setPonderHitToken (std::move (ponder_hit));
+    }
+
+    void Game::setSearchListener (shared_ptr<SearchListener> listener)
+    {
+        my_pimpl->my_search_listener = std::move (listener);
+    }
+
+    auto Game::getSoftSearchTimeout() const -> optional<std::chrono::milliseconds>
+    {
+        return my_pimpl->my_move_timer.getSoftTimeLimit();
+    }
+
+    void Game::setSoftSearchTimeout (optional<std::chrono::milliseconds> timeout)
+    {
+        my_pimpl->my_move_timer.setSoftTimeLimit (timeout);
+    }
+
+    auto Game::getTranspositionTableSize() const -> int
+    {
+        return my_pimpl->my_transposition_table->getSizeInMegabytes();
+    }
+
+    void Game::setTranspositionTableSize (int size_in_megabytes)
+    {
+        if (size_in_megabytes != getTranspositionTableSize())
+            my_pimpl->my_transposition_table->resize (size_in_megabytes);
+    }
+
+    void Game::clearTranspositionTable()
+    {
+        my_pimpl->my_transposition_table->clear();
+    }
+
+    void Game::takeTranspositionTable (Game&& other)
+    {
+        // Swap rather than move, so the other game is still left in a usable state.
+        std::swap (my_pimpl->my_transposition_table, other.my_pimpl->my_transposition_table);
+    }
+
+    void Game::detachTranspositionTable()
+    {
+        my_pimpl->my_transposition_table = make_shared<TranspositionTable> (
+            *my_pimpl->my_transposition_table
+        );
+    }
+
+    void Game::replaceTranspositionTable (int size_in_megabytes)
+    {
+        my_pimpl->my_transposition_table = make_shared<TranspositionTable> (
+            TranspositionTable::fromMegabytes (size_in_megabytes)
+        );
+    }
+
+    auto Game::sharesTranspositionTableWith (const Game& other) const -> bool
+    {
+        return my_pimpl->my_transposition_table == other.my_pimpl->my_transposition_table;
+    }
+
+    void Game::saveTranspositionTable (const string& path)
+    {
+        my_pimpl->my_transposition_table->saveTo (path);
+    }
+
+    void Game::loadTranspositionTable (const string& path)
+    {
+        my_pimpl->my_transposition_table->loadFrom (path);
+    }
+
+    void Game::attachSharedTranspositionTable (const string& name, int size_in_megabytes)
+    {
+        my_pimpl->my_transposition_table->attachSharedMemory (name, size_in_megabytes);
+    }
+
+    auto Game::getEvalCacheSize() const -> int
+    {
+        return my_pimpl->my_eval_cache->getSizeInMegabytes();
+    }
+
+    void Game::setEvalCacheSize (int size_in_megabytes)
+    {
+        if (size_in_megabytes != getEvalCacheSize())
+            my_pimpl->my_eval_cache->resize (size_in_megabytes);
+    }
+
+    void Game::takeEvalCache (Game&& other)
+    {
+        std::swap (my_pimpl->my_eval_cache, other.my_pimpl->my_eval_cache);
+    }
+
+    void Game::setEvaluationNetwork (shared_ptr<const NnueNetwork> network)
+    {
+        if (network == my_pimpl->my_network)
+            return;
+
+        // The cached scores came from the old evaluation.
+        my_pimpl->my_network = std::move (network);
+        my_pimpl->my_eval_cache->clear();
+    }
+
+    auto Game::getEvaluationNetwork() const -> shared_ptr<const NnueNetwork>
+    {
+        return my_pimpl->my_network;
+    }
+
+    void Game::setTablebase (shared_ptr<const Tablebase> tablebase)
     {
-        return my_pimpl->my_move_timer.getSeconds();
+        my_pimpl->my_tablebase = std::move (tablebase);
     }
 
-    void Game::setSearchTimeout (std::chrono::seconds seconds)
+    auto Game::getTablebase() const -> shared_ptr<const Tablebase>
     {
-        my_pimpl->my_move_timer.setSeconds (seconds);
+        return my_pimpl->my_tablebase;
     }
 
     auto Game::mapCoordinatesToMove (Coord src, Coord dst, optional<Piece> promoted) const
@@ -1,5 +1,8 @@
 #pragma once
 
+#include <future>
+#include <stop_token>
+
 #include "wisdom-chess/engine/global.hpp"
 #include "wisdom-chess/engine/piece.hpp"
 #include "wisdom-chess/engine/move.hpp"
@@ -12,7 +15,10 @@ namespace wisdom
 {
     class BoardBuilder;
     class Logger;
+    class SearchListener;
     class Board;
+    class NnueNetwork;
+    class Tablebase;
 
     enum class DrawStatus;
     enum class ProposedDrawType;
@@ -83,6 +89,27 @@ namespace wisdom
         ) const
             -> optional<Move>;
 
+        // Search until the timer runs out or a stop is requested, and
+        // return the best move found by then.
+        [[nodiscard]] auto findBestMove (
+            shared_ptr<Logger> logger,
+            std::stop_token stop_token,
+            Color whom = Color::None
+        ) const
+            -> optional<Move>;
+
+        // The reply to the move that was best for the other side at the
+        // last search, which is the move to ponder on.
+        [[nodiscard]] auto expectedReply (Move move) const -> optional<Move>;
+
+        // Search a copy of the game on another thread.
+        [[nodiscard]] auto findBestMoveAsync (
+            shared_ptr<Logger> logger,
+            std::stop_token stop_token,
+            Color whom = Color::None
+        ) const
+            -> std::future<optional<Move>>;
+
         void move (Move move);
 
         [[nodiscard]] auto getCurrentTurn() const -> Color;
@@ -111,9 +138,101 @@ namespace wisdom
 
         void setMaxDepth (int max_depth);
 
-        [[nodiscard]] auto getSearchTimeout() const -> std::chrono::seconds;
+        // Stop the search after this many nodes instead of when the time
+        // runs out, so it always comes out the same.
+        [[nodiscard]] auto getNodeLimit() const -> optional<int64_t>;
+
+        void setNodeLimit (optional<int64_t> node_limit);
+
+        // How many of the best moves the search finds, each reported to the
+        // search listener with its own score and line. The best move is
+        // still the one played.
+        [[nodiscard]] auto getMultiPv() const -> int;
+
+        void setMultiPv (int lines);
+
+        // Restrict the search to these moves, or consider all moves if empty.
+        [[nodiscard]] auto getSearchMoves() const -> const vector<Move>&;
+
+        void setSearchMoves (vector<Move> search_moves);
+
+        [[nodiscard]] auto getSearchTimeout() const -> std::chrono::milliseconds;
+
+        void setSearchTimeout (std::chrono::milliseconds timeout);
+
+        // Search on the opponent's time, without the timeouts applying
+        // until a stop is requested through the token.
+        void setPonderHitToken (std::stop_token ponder_hit);
+
+        // Report the progress of searches to the listener, or to nothing
+        // if it's null. Copies of the game share the listener.
+        void setSearchListener (shared_ptr<SearchListener> listener);
+
+        // Once past the soft timeout, the search won't start another depth.
+        [[nodiscard]] auto getSoftSearchTimeout() const -> optional<std::chrono::milliseconds>;
+
+        void setSoftSearchTimeout (optional<std::chrono::milliseconds> timeout);
+
+        //
+        // The transposition table is shared between copies of a game, so
+        // resizing or clearing it affects every copy that still shares it.
+        //
+        [[nodiscard]] auto getTranspositionTableSize() const -> int;
+
+        // Resize the transposition table, in megabytes. The table is only
+        // reallocated (and its contents discarded) if the size changes.
+        void setTranspositionTableSize (int size_in_megabytes);
+
+        void clearTranspositionTable();
+
+        // Take over the transposition table of another game, so that a new
+        // position can keep using an existing table instead of allocating one.
+        void takeTranspositionTable (Game&& other);
+
+        // Give this game its own copy of the transposition table, so that it
+        // no longer shares it with the game it was copied from.
+        void detachTranspositionTable();
+
+        // Give this game a new, empty transposition table of the given size,
+        // without copying the current one first.
+        void replaceTranspositionTable (int size_in_megabytes);
+
+        [[nodiscard]] auto sharesTranspositionTableWith (const Game& other) const -> bool;
+
+        // Save the transposition table to a file, or replace it with one
+        // loaded from a file, so analysis can continue across restarts.
+        // Both throw TranspositionTableFileError on failure.
+        void saveTranspositionTable (const string& path);
+
+        void loadTranspositionTable (const string& path);
+
+        // Use a transposition table in a named shared memory segment, shared
+        // with other engine processes on this machine. If the segment already
+        // exists, its size is used instead of the one given here.
+        void attachSharedTranspositionTable (const string& name, int size_in_megabytes);
+
+        //
+        // The evaluation cache is shared between copies of a game the same
+        // way as the transposition table, and sized separately from it.
+        //
+        [[nodiscard]] auto getEvalCacheSize() const -> int;
+
+        // Resize the evaluation cache, in megabytes. Zero disables the cache.
+        void setEvalCacheSize (int size_in_megabytes);
+
+        void takeEvalCache (Game&& other);
+
+        // Evaluate positions with a network instead of the classic
+        // evaluation. A null network switches back to the classic one.
+        void setEvaluationNetwork (shared_ptr<const NnueNetwork> network);
+
+        [[nodiscard]] auto getEvaluationNetwork() const -> shared_ptr<const NnueNetwork>;
+
+        // Look up endings with few pieces in the tablebase instead of
+        // searching them. A null tablebase switches the lookups off.
+        void setTablebase (shared_ptr<const Tablebase> tablebase);
 
-        void setSearchTimeout (std::chrono::seconds seconds);
+        [[nodiscard]] auto getTablebase() const -> shared_ptr<const Tablebase>;
 
         [[nodiscard]] auto
         mapCoordinatesToMove (Coord src, Coord dst, optional<Piece> promoted) const
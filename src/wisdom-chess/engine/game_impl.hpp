@@ -5,6 +5,8 @@
 #include "wisdom-chess/engine/history.hpp"
 #include "wisdom-chess/engine/move_timer.hpp"
 #include "wisdom-chess/engine/game_status.hpp"
+#include "wisdom-chess/engine/eval_cache.hpp"
+#include "wisdom-chess/engine/nnue.hpp"
 #include "wisdom-chess/engine/transposition_table.hpp"
 
 namespace wisdom
@@ -27,7 +29,28 @@ namespace wisdom
         History my_history;
         MoveTimer my_move_timer { Default_Max_Search_Seconds };
         int my_max_depth { Default_Max_Depth };
-        mutable TranspositionTable my_transposition_table = TranspositionTable::fromMegabytes (TranspositionTable::Default_Size_In_Megabytes);
+        optional<int64_t> my_node_limit {};
+        vector<Move> my_search_moves {};
+        int my_multi_pv = 1;
+        shared_ptr<SearchListener> my_search_listener {};
+
+        // Shared by copies of the game, so copying a game for a search doesn't
+        // copy the whole table. See Game::detachTranspositionTable().
+        shared_ptr<TranspositionTable> my_transposition_table = make_shared<TranspositionTable> (
+            TranspositionTable::fromMegabytes (TranspositionTable::Default_Size_In_Megabytes)
+        );
+
+        // Shared the same way as the transposition table.
+        shared_ptr<EvalCache> my_eval_cache = make_shared<EvalCache> (
+            EvalCache::fromMegabytes (EvalCache::Default_Size_In_Megabytes)
+        );
+
+        // The network to evaluate positions with, or null for the classic
+        // evaluation.
+        shared_ptr<const NnueNetwork> my_network;
+
+        // The endgame tablebase, if any.
+        shared_ptr<const Tablebase> my_tablebase;
 
         Players my_players = { Player::Human, Player::ChessEngine };
 
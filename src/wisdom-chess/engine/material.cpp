@@ -13,60 +13,190 @@ namespace wisdom
         }
     }
 
-    [[nodiscard]] static auto 
-    dualBishopsAreTheSameColor (const Board& board)
-        -> Material::CheckmateIsPossible
-    {
-        auto first_coord = board.findFirstCoordWithPiece (Piece::Bishop);
-        assert (first_coord.has_value());
+    // In the same units as the material weights, where a pawn is 100.
+    static constexpr int Bishop_Pair_Bonus = 30;
 
-        auto starting_at = nextCoord (*first_coord);
-        assert (starting_at.has_value());
+    // Contribution of each piece type to the game phase.
+    static constexpr array<int, Num_Piece_Types> Phase_Weight = {
+        0, // None
+        0, // Pawn
+        1, // Knight
+        1, // Bishop
+        2, // Rook
+        4, // Queen
+        0, // King
+    };
 
-        auto second_coord = board.findFirstCoordWithPiece (Piece::Bishop, *starting_at);
-        assert (second_coord.has_value());
-
-        return (coordColor (*first_coord) == coordColor (*second_coord))
-            ? Material::CheckmateIsPossible::No
-            : Material::CheckmateIsPossible::Yes;
-    }
-
-    auto Material::checkInsufficientMaterialScenarios (const Board& board) const
-        -> CheckmateIsPossible
+    [[nodiscard]] static auto
+    drawStatusFromCounts (const Material::PieceCounts& counts)
+        -> MaterialDrawStatus
     {
-        auto white_knight_count = pieceCount (Color::White, Piece::Knight);
-        auto black_knight_count = pieceCount (Color::Black, Piece::Knight);
-        auto white_bishop_count = pieceCount (Color::White, Piece::Bishop);
-        auto black_bishop_count = pieceCount (Color::Black, Piece::Bishop);
+        auto count = [&counts] (Color who, Piece type) -> int
+        {
+            return counts[colorIndex (who)][toInt (type)];
+        };
+
+        for (auto who : { Color::White, Color::Black })
+        {
+            if (count (who, Piece::Pawn) > 0 || count (who, Piece::Rook) > 0)
+                return MaterialDrawStatus::Sufficient;
 
-        auto knight_sum = black_knight_count + white_knight_count;
-        auto bishop_sum = black_bishop_count + white_bishop_count;
+            // More than two bishops' worth of material besides the king:
+            auto non_king_score = count (who, Piece::Knight) * WeightKnight
+                + count (who, Piece::Bishop) * WeightBishop
+                + count (who, Piece::Queen) * WeightQueen;
+            if (non_king_score > 2 * WeightBishop)
+                return MaterialDrawStatus::Sufficient;
+        }
 
-        auto minor_piece_sum = knight_sum + bishop_sum;
+        auto knight_sum = count (Color::White, Piece::Knight) + count (Color::Black, Piece::Knight);
+        auto bishop_sum = count (Color::White, Piece::Bishop) + count (Color::Black, Piece::Bishop);
 
         // King and King:
-        if (minor_piece_sum == 0)
-            return CheckmateIsPossible::No;
+        if (knight_sum + bishop_sum == 0)
+            return MaterialDrawStatus::Insufficient;
 
-        if (bishop_sum == 0)
-        {
-            // King and knight vs King:
-            if (knight_sum == 1)
-                return CheckmateIsPossible::No;
-        }
+        // King and knight vs King:
+        if (bishop_sum == 0 && knight_sum == 1)
+            return MaterialDrawStatus::Insufficient;
 
         if (knight_sum == 0)
         {
             // King and bishop vs King:
             if (bishop_sum == 1)
-                return CheckmateIsPossible::No;
+                return MaterialDrawStatus::Insufficient;
 
-            // King and bishop vs King and bishop with opposite colored bishops, 
+            // King and bishop vs King and bishop with opposite colored bishops,
             // or King and two bishops vs King;
             if (bishop_sum == 2)
-                return dualBishopsAreTheSameColor (board);
+                return MaterialDrawStatus::DependsOnBishopColors;
+        }
+
+        return MaterialDrawStatus::Sufficient;
+    }
+
+    [[nodiscard]] static auto
+    endgameFromCounts (const Material::PieceCounts& counts)
+        -> std::pair<EndgameType, Color>
+    {
+        for (auto strong : { Color::White, Color::Black })
+        {
+            auto weak = colorInvert (strong);
+            auto weak_index = colorIndex (weak);
+            auto strong_index = colorIndex (strong);
+
+            // The weaker side must have only a king.
+            bool weak_is_bare = true;
+            for (auto type : { Piece::Pawn, Piece::Knight, Piece::Bishop, Piece::Rook, Piece::Queen })
+            {
+                if (counts[weak_index][toInt (type)] > 0)
+                    weak_is_bare = false;
+            }
+            if (!weak_is_bare)
+                continue;
+
+            auto count = [&] (Piece type) -> int { return counts[strong_index][toInt (type)]; };
+
+            auto total = count (Piece::Pawn) + count (Piece::Knight) + count (Piece::Bishop)
+                + count (Piece::Rook) + count (Piece::Queen);
+
+            if (total == 1 && count (Piece::Pawn) == 1)
+                return { EndgameType::KingPawnVsKing, strong };
+
+            if (total == 2 && count (Piece::Bishop) == 1 && count (Piece::Knight) == 1)
+                return { EndgameType::KingBishopKnightVsKing, strong };
+
+            if (count (Piece::Pawn) == 0 && count (Piece::Rook) + count (Piece::Queen) > 0)
+                return { EndgameType::KingAndMajorVsKing, strong };
+        }
+
+        return { EndgameType::None, Color::None };
+    }
+
+    auto
+    Material::computeInfo (const PieceCounts& counts)
+        -> MaterialInfo
+    {
+        MaterialInfo result;
+
+        int imbalance = 0;
+        if (counts[Color_Index_White][toInt (Piece::Bishop)] >= 2)
+            imbalance += Bishop_Pair_Bonus;
+        if (counts[Color_Index_Black][toInt (Piece::Bishop)] >= 2)
+            imbalance -= Bishop_Pair_Bonus;
+        result.imbalance = narrow<int16_t> (scaledScore (imbalance));
+
+        int phase = 0;
+        for (const auto& color_counts : counts)
+        {
+            for (std::size_t type_index = 0; type_index < Num_Piece_Types; type_index++)
+                phase += color_counts[type_index] * Phase_Weight[type_index];
+        }
+        result.phase = narrow<uint8_t> (std::min (phase, Max_Game_Phase));
+
+        result.draw_status = drawStatusFromCounts (counts);
+
+        auto [endgame, strong_side] = endgameFromCounts (counts);
+        result.endgame = endgame;
+        result.strong_side = strong_side;
+
+        return result;
+    }
+
+    auto
+    Material::buildInfoTable()
+        -> vector<MaterialInfo>
+    {
+        vector<MaterialInfo> table (Signature_Count);
+
+        // Walk every combination of counts within the limits, in the same
+        // order as the signature's mixed-radix digits.
+        PieceCounts counts {};
+        for (int signature = 0; signature < Signature_Count; signature++)
+        {
+            table[signature] = computeInfo (counts);
+
+            for (int color_index = 0; color_index < Num_Players; color_index++)
+            {
+                bool carried = false;
+                for (std::size_t type_index = 0; type_index < Num_Piece_Types; type_index++)
+                {
+                    if (Signature_Piece_Limit[type_index] == 0)
+                        continue;
+
+                    if (counts[color_index][type_index] < Signature_Piece_Limit[type_index])
+                    {
+                        counts[color_index][type_index]++;
+                        carried = false;
+                        break;
+                    }
+
+                    counts[color_index][type_index] = 0;
+                    carried = true;
+                }
+                if (!carried)
+                    break;
+            }
         }
 
-        return CheckmateIsPossible::Yes;
+        return table;
+    }
+
+    auto
+    Material::checkBishopColors (const Board& board)
+        -> CheckmateIsPossible
+    {
+        auto first_coord = board.findFirstCoordWithPiece (Piece::Bishop);
+        assert (first_coord.has_value());
+
+        auto starting_at = nextCoord (*first_coord);
+        assert (starting_at.has_value());
+
+        auto second_coord = board.findFirstCoordWithPiece (Piece::Bishop, *starting_at);
+        assert (second_coord.has_value());
+
+        return (coordColor (*first_coord) == coordColor (*second_coord))
+            ? Material::CheckmateIsPossible::No
+            : Material::CheckmateIsPossible::Yes;
     }
 }
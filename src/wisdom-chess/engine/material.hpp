@@ -7,14 +7,87 @@ namespace wisdom
 {
     class Board;
 
+    // Endings that can be evaluated better with knowledge of the ending than
+    // with the general evaluation.
+    enum class EndgameType : uint8_t
+    {
+        None,
+
+        // King and one pawn against a lone king.
+        KingPawnVsKing,
+
+        // King, bishop and knight against a lone king.
+        KingBishopKnightVsKing,
+
+        // King and a queen or rook (or more) against a lone king.
+        KingAndMajorVsKing,
+    };
+
+    inline constexpr int Num_Endgame_Types = 4;
+
+    enum class MaterialDrawStatus : uint8_t
+    {
+        // There's enough material for a checkmate.
+        Sufficient,
+
+        // Neither side can checkmate.
+        Insufficient,
+
+        // Two bishops and nothing else besides kings: whether a checkmate is
+        // possible depends on whether the bishops are on the same color.
+        DependsOnBishopColors,
+    };
+
+    // Everything known about a position from the piece counts alone.
+    struct MaterialInfo
+    {
+        // Adjustment to the material score from white's point of view, for
+        // combinations of pieces worth more or less than their sum.
+        int16_t imbalance = 0;
+
+        // From Max_Game_Phase with all pieces on the board, down to zero with
+        // only kings and pawns.
+        uint8_t phase = 0;
+
+        MaterialDrawStatus draw_status = MaterialDrawStatus::Sufficient;
+        EndgameType endgame = EndgameType::None;
+
+        // The side with the extra material when there's a specialized ending.
+        Color strong_side = Color::None;
+    };
+    static_assert (sizeof (MaterialInfo) <= 8);
+
+    inline constexpr int Max_Game_Phase = 24;
+
     class Material
     {
     public:
+        // Limits on the piece counts covered by the material signature. A
+        // count beyond these (only possible with promotions) isn't covered,
+        // and the material info is computed directly instead.
+        static constexpr array<int, Num_Piece_Types> Signature_Piece_Limit = {
+            0, // None
+            8, // Pawn
+            2, // Knight
+            2, // Bishop
+            2, // Rook
+            1, // Queen
+            0, // King
+        };
+
+        // Number of distinct material signatures.
+        static constexpr int Signature_Count = [] {
+            int count = 1;
+            for (auto limit : Signature_Piece_Limit)
+                count *= (limit + 1);
+            return count * count;
+        }();
+
         Material() = default;
 
         explicit Material (const Board& board);
 
-        [[nodiscard]] static auto
+        [[nodiscard]] static constexpr auto
         weight (Piece piece) noexcept
             -> int
         {
@@ -34,8 +107,8 @@ namespace wisdom
             std::terminate();
         }
 
-        [[nodiscard]] static auto 
-        scaledScore (int score) 
+        [[nodiscard]] static constexpr auto
+        scaledScore (int score)
             -> int
         {
             return score * Material_Score_Scale;
@@ -49,6 +122,9 @@ namespace wisdom
 
             my_score[color_idx] += weight (type);
             my_piece_count[color_idx][type_idx]++;
+            my_signature += Signature_Stride[color_idx][type_idx];
+            if (my_piece_count[color_idx][type_idx] > Signature_Piece_Limit[type_idx] && type != Piece::King)
+                my_pieces_beyond_signature++;
 
             assert (my_piece_count[color_idx][type_idx] > 0);
         }
@@ -59,8 +135,11 @@ namespace wisdom
             auto type = pieceType (piece);
             auto type_idx = toInt (type);
 
+            if (my_piece_count[color_idx][type_idx] > Signature_Piece_Limit[type_idx] && type != Piece::King)
+                my_pieces_beyond_signature--;
             my_score[color_idx] -= weight (type);
             my_piece_count[color_idx][type_idx]--;
+            my_signature -= Signature_Stride[color_idx][type_idx];
 
             assert (my_piece_count[color_idx][type_idx] >= 0);
         }
@@ -92,6 +171,55 @@ namespace wisdom
             return my_piece_count[color_idx][type_idx];
         }
 
+        // The number of pieces on the board, counting the kings.
+        [[nodiscard]] auto
+        totalPieceCount() const
+            -> int
+        {
+            int result = 0;
+            for (const auto& counts : my_piece_count)
+                result += std::accumulate (counts.begin(), counts.end(), 0);
+            return result;
+        }
+
+        // An index for the piece counts on both sides, in [0, Signature_Count).
+        // Only meaningful if hasSignature() is true.
+        [[nodiscard]] auto
+        signature() const noexcept
+            -> int
+        {
+            return my_signature;
+        }
+
+        [[nodiscard]] auto
+        hasSignature() const noexcept
+            -> bool
+        {
+            return my_pieces_beyond_signature == 0;
+        }
+
+        // Look up what's known about the material on the board. This is
+        // a single table load, except in positions with extra pieces from
+        // promotions.
+        [[nodiscard]] auto
+        info() const
+            -> MaterialInfo
+        {
+            if (hasSignature()) [[likely]]
+                return materialInfoTable()[my_signature];
+
+            return computeInfo (my_piece_count);
+        }
+
+        // The imbalance adjustment from the point of view of the player.
+        [[nodiscard]] auto
+        imbalanceScore (Color who) const
+            -> int
+        {
+            int imbalance = info().imbalance;
+            return who == Color::White ? imbalance : -imbalance;
+        }
+
         enum class CheckmateIsPossible
         {
             No,
@@ -103,38 +231,70 @@ namespace wisdom
         checkmateIsPossible (const Board& board) const 
             -> CheckmateIsPossible
         {
-            // clang-format off
-            if (pieceCount (Color::White, Piece::Pawn) > 0 ||
-                pieceCount (Color::Black, Piece::Pawn) > 0 ||
-                pieceCount (Color::White, Piece::Rook) > 0 ||
-                pieceCount (Color::Black, Piece::Rook) > 0)
-            {
-                return CheckmateIsPossible::Yes;
-            }
-            // clang-format on
-
-            // clang-format off
-            if (individualScore (Color::White) > scaledScore (WeightKing + 2 * WeightBishop) ||
-                individualScore (Color::Black) > scaledScore (WeightKing + 2 * WeightBishop))
+            switch (info().draw_status)
             {
-                return CheckmateIsPossible::Yes;
+                case MaterialDrawStatus::Sufficient:
+                    return CheckmateIsPossible::Yes;
+                case MaterialDrawStatus::Insufficient:
+                    return CheckmateIsPossible::No;
+                case MaterialDrawStatus::DependsOnBishopColors:
+                    return checkBishopColors (board);
             }
-            // clang-format on
 
-            return checkInsufficientMaterialScenarios (board);
+            std::terminate();
         }
 
+        using PieceCounts = array<array<int8_t, Num_Piece_Types>, Num_Players>;
+
+        // Work out the material info from the piece counts. This is used to
+        // fill in the table, and for counts the table doesn't cover.
+        [[nodiscard]] static auto
+        computeInfo (const PieceCounts& piece_counts)
+            -> MaterialInfo;
+
     private:
-        // Check for more detailed scenarios of sufficient material. This assumes there are
-        // only minor pieces and king left, with no pawns.
-        [[nodiscard]] auto 
-        checkInsufficientMaterialScenarios (const Board& board) const
+        // Check whether two bishops, with nothing else but kings, can deliver mate.
+        [[nodiscard]] static auto
+        checkBishopColors (const Board& board)
             -> CheckmateIsPossible;
 
+        [[nodiscard]] static auto
+        buildInfoTable()
+            -> vector<MaterialInfo>;
+
+        // Table of material info for every signature, built on first use.
+        [[nodiscard]] static auto
+        materialInfoTable()
+            -> const MaterialInfo*
+        {
+            static const vector<MaterialInfo> table = buildInfoTable();
+            return table.data();
+        }
+
+        static constexpr auto Signature_Stride = [] {
+            array<array<int, Num_Piece_Types>, Num_Players> strides {};
+            int stride = 1;
+            for (int color_index = 0; color_index < Num_Players; color_index++)
+            {
+                for (std::size_t type_index = 0; type_index < Num_Piece_Types; type_index++)
+                {
+                    strides[color_index][type_index] = Signature_Piece_Limit[type_index] > 0 ? stride : 0;
+                    stride *= Signature_Piece_Limit[type_index] + 1;
+                }
+            }
+            return strides;
+        }();
+
     private:
         int my_score[Num_Players] {};
 
         // Count of pieces on either side:
-        array<array<int8_t, Num_Piece_Types>, Num_Players> my_piece_count {};
+        PieceCounts my_piece_count {};
+
+        // Index of the piece counts into the material info table.
+        int my_signature = 0;
+
+        // How many pieces go past the limits covered by the signature.
+        int my_pieces_beyond_signature = 0;
     };
 }
@@ -41,6 +41,11 @@ namespace wisdom
     void 
     Board::setPiece (Coord coord, ColoredPiece piece) noexcept
     {
+        assert (my_change_count < Max_Square_Changes);
+        my_changes[my_change_count++] = SquareChange { coord, my_squares[coord.index()], piece };
+
+        my_pawn_code ^= pawnCodeHash (coord, my_squares[coord.index()]);
+        my_pawn_code ^= pawnCodeHash (coord, piece);
         my_squares[coord.index()] = piece;
     }
 
@@ -284,6 +289,8 @@ namespace wisdom
     {
         assert (who == my_code.getCurrentTurn());
 
+        my_change_count = 0;
+
         Coord src = move.getSrc();
         Coord dst = move.getDst();
 
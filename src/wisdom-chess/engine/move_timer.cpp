@@ -1,5 +1,4 @@
 #include <cmath>
-#include <atomic>
 
 #include "wisdom-chess/engine/move_timer.hpp"
 
@@ -7,8 +6,6 @@ namespace wisdom
 {
     using chrono::steady_clock;
 
-    static std::atomic<int> timing_adjustment_saved_iterations {};
-
     auto MoveTimer::isTriggered() -> bool
     {
         if (!my_timer_state.started_time.has_value())
@@ -17,6 +14,12 @@ namespace wisdom
         if (my_timer_state.triggered)
             return true;
 
+        if (my_stop_token.stop_requested())
+        {
+            my_timer_state.triggered = true;
+            return true;
+        }
+
         if (++my_timer_state.check_calls % my_timing_adjustment.getIterations() != 0)
             return false;
 
@@ -56,7 +59,7 @@ namespace wisdom
 
         my_timer_state.last_check_time = check_time;
 
-        if (diff_time >= my_seconds)
+        if (diff_time >= my_hard_limit && !isPondering())
         {
             my_timer_state.triggered = true;
             return true;
@@ -69,16 +72,6 @@ namespace wisdom
 
     auto TimingAdjustment::create() -> TimingAdjustment
     {
-        auto iterations = std::clamp (
-            timing_adjustment_saved_iterations.load(),
-            Min_Iterations_Before_Checking,
-            Max_Iterations_Before_Checking
-        );
-        return TimingAdjustment (iterations);
-    }
-
-    void TimingAdjustment::setSavedIterations (int iterations)
-    {
-        timing_adjustment_saved_iterations.store (iterations);
+        return TimingAdjustment (Min_Iterations_Before_Checking);
     }
 }
@@ -1,16 +1,21 @@
 #pragma once
 
+#include <stop_token>
+
 #include "wisdom-chess/engine/global.hpp"
 
 namespace wisdom
 {
-    inline constexpr int Min_Iterations_Before_Checking = 10'000;
+    inline constexpr int Min_Iterations_Before_Checking = 100;
     inline constexpr int Max_Iterations_Before_Checking = 1'000'000;
 
-    inline constexpr chrono::milliseconds Lower_Bound_Timer_Check =
-        chrono::milliseconds { 25 };
-    inline constexpr chrono::milliseconds Upper_Bound_Timer_Check =
-        chrono::milliseconds { 50 };
+    // The clock is checked often enough that the search stops within a
+    // millisecond or two of its deadline, even when the search moves into
+    // positions that take several times longer between checks.
+    inline constexpr chrono::microseconds Lower_Bound_Timer_Check =
+        chrono::microseconds { 250 };
+    inline constexpr chrono::microseconds Upper_Bound_Timer_Check =
+        chrono::microseconds { 500 };
 
     struct MoveTimer;
 
@@ -29,12 +34,9 @@ namespace wisdom
         void setIterations (int iterations)
         {
             current_iterations = iterations;
-            setSavedIterations (iterations);
         }
 
     private:
-        static void setSavedIterations (int);
-
         explicit TimingAdjustment (int iterations)
             : current_iterations { iterations }
         {}
@@ -53,13 +55,16 @@ namespace wisdom
         bool cancelled = false;
     };
 
+    // Limits how long a search runs for. The hard limit stops the search
+    // wherever it is, and the soft limit only stops it from starting
+    // another iteration, which would likely be cut short anyway.
     class MoveTimer
     {
     public:
         using PeriodicFunction = std::function<void(nonnull_observer_ptr<MoveTimer>)>;
 
-        explicit MoveTimer (chrono::seconds seconds)
-            : my_seconds { seconds }
+        explicit MoveTimer (chrono::milliseconds hard_limit)
+            : my_hard_limit { hard_limit }
         {
         }
 
@@ -82,18 +87,59 @@ namespace wisdom
         {
             my_timer_state = TimerState {};
             my_timer_state.started_time = chrono::steady_clock::now();
+
+            // Start over from checking often, since the count that suited
+            // another search can put off the first check for far too long.
+            my_timing_adjustment = TimingAdjustment::create();
+        }
+
+        [[nodiscard]] auto
+        getTimeLimit() const noexcept
+            -> chrono::milliseconds
+        {
+            return my_hard_limit;
+        }
+
+        void setTimeLimit (chrono::milliseconds hard_limit)
+        {
+            my_hard_limit = hard_limit;
         }
 
         [[nodiscard]] auto
-        getSeconds() const noexcept
-            -> chrono::seconds
+        getSoftTimeLimit() const noexcept
+            -> optional<chrono::milliseconds>
         {
-            return my_seconds;
+            return my_soft_limit;
         }
 
-        void setSeconds (chrono::seconds new_seconds)
+        void setSoftTimeLimit (optional<chrono::milliseconds> soft_limit)
         {
-            my_seconds = new_seconds;
+            my_soft_limit = soft_limit;
+        }
+
+        // Time since the timer was started, or zero if it hasn't been.
+        [[nodiscard]] auto
+        elapsed() const
+            -> chrono::steady_clock::duration
+        {
+            if (!my_timer_state.started_time.has_value())
+                return chrono::steady_clock::duration::zero();
+
+            return chrono::steady_clock::now() - *my_timer_state.started_time;
+        }
+
+        // Whether it's past the soft limit, so no new iteration of the
+        // search should start.
+        [[nodiscard]] auto
+        isSoftLimitReached() const
+            -> bool
+        {
+            if (isPondering())
+                return false;
+
+            return my_timer_state.triggered
+                || (my_soft_limit.has_value() && my_timer_state.started_time.has_value()
+                    && elapsed() >= *my_soft_limit);
         }
 
         void setPeriodicFunction (const PeriodicFunction& periodic_function) noexcept
@@ -108,16 +154,51 @@ namespace wisdom
                 my_timer_state.triggered = true;
         }
 
+        // Stop the search as soon as a stop is requested through the token.
+        // Unlike cancelling, the search still returns the best move found
+        // so far. The token is checked on every call to isTriggered(), not
+        // only when the clock is.
+        void setStopToken (std::stop_token stop_token) noexcept
+        {
+            my_stop_token = std::move (stop_token);
+        }
+
+        [[nodiscard]] auto
+        isStopRequested() const noexcept
+            -> bool
+        {
+            return my_stop_token.stop_requested();
+        }
+
+        // Ponder on the opponent's time: the time limits don't apply until
+        // a stop is requested through the token, which signals that the
+        // opponent played the expected move. The time spent pondering still
+        // counts after that, since the search is that much further along.
+        void setPonderHitToken (std::stop_token ponder_hit) noexcept
+        {
+            my_ponder_hit_token = std::move (ponder_hit);
+        }
+
+        [[nodiscard]] auto
+        isPondering() const noexcept
+            -> bool
+        {
+            return my_ponder_hit_token.stop_possible() && !my_ponder_hit_token.stop_requested();
+        }
+
     private:
         void setTriggered (bool triggered) noexcept
         {
             my_timer_state.triggered = triggered;
         }
 
-        chrono::seconds my_seconds;
+        chrono::milliseconds my_hard_limit;
+        optional<chrono::milliseconds> my_soft_limit {};
 
         TimingAdjustment my_timing_adjustment = TimingAdjustment::create();
         optional<PeriodicFunction> my_periodic_function {};
+        std::stop_token my_stop_token {};
+        std::stop_token my_ponder_hit_token {};
 
         TimerState my_timer_state {};
     };
@@ -0,0 +1,593 @@
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// The vector kernels are compiled for their instruction sets with target
+// attributes and picked at runtime, so the library itself still runs on any
+// x86-64 processor.
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__)) \
+    && !defined(EMSCRIPTEN) && !defined(__PIZLONATOR_WAS_HERE__)
+#define WISDOM_CHESS_NNUE_X86_KERNELS 1
+#include <immintrin.h>
+#endif
+
+#include "wisdom-chess/engine/nnue.hpp"
+#include "wisdom-chess/engine/board.hpp"
+
+namespace wisdom
+{
+    // Layout of a network file: this header, followed by the feature biases,
+    // the feature weights one row of Nnue_Hidden_Size per feature, and the
+    // output weights for the side to move and then the other side. All values
+    // are little-endian.
+    struct NnueFileHeader
+    {
+        char magic[8];
+        uint32_t version;
+        uint32_t feature_count;
+        uint32_t hidden_size;
+        int32_t output_bias;
+        int32_t output_divisor;
+        uint8_t reserved[36];
+    };
+    static_assert (sizeof (NnueFileHeader) == 64);
+
+    static constexpr char Nnue_File_Magic[8] = { 'W', 'I', 'S', 'D', 'O', 'M', 'N', 'N' };
+    static constexpr uint32_t Nnue_File_Version = 1;
+
+    static constexpr size_t Nnue_Feature_Biases_Size = Nnue_Hidden_Size * sizeof (int16_t);
+    static constexpr size_t Nnue_Feature_Weights_Size =
+        static_cast<size_t> (Nnue_Feature_Count) * Nnue_Hidden_Size * sizeof (int16_t);
+    static constexpr size_t Nnue_Output_Weights_Size = Num_Players * Nnue_Hidden_Size * sizeof (int8_t);
+    static constexpr size_t Nnue_File_Size = sizeof (NnueFileHeader) + Nnue_Feature_Biases_Size
+        + Nnue_Feature_Weights_Size + Nnue_Output_Weights_Size;
+
+    static_assert (Nnue_Hidden_Size % 16 == 0, "The vector kernels work on 16 values at a time");
+
+    using NnueRow = span<int16_t, Nnue_Hidden_Size>;
+    using ConstNnueRow = span<const int16_t, Nnue_Hidden_Size>;
+    using ConstNnueOutputWeights = span<const int8_t, Nnue_Hidden_Size>;
+
+    static void
+    scalarAddRow (NnueRow accumulator, ConstNnueRow row)
+    {
+        for (int i = 0; i < Nnue_Hidden_Size; i++)
+            accumulator[i] = static_cast<int16_t> (accumulator[i] + row[i]);
+    }
+
+    static void
+    scalarSubRow (NnueRow accumulator, ConstNnueRow row)
+    {
+        for (int i = 0; i < Nnue_Hidden_Size; i++)
+            accumulator[i] = static_cast<int16_t> (accumulator[i] - row[i]);
+    }
+
+    [[nodiscard]] static auto
+    scalarOutput (ConstNnueRow accumulator, ConstNnueOutputWeights weights)
+        -> int32_t
+    {
+        int32_t sum = 0;
+        for (int i = 0; i < Nnue_Hidden_Size; i++)
+        {
+            int32_t activation = std::clamp<int16_t> (accumulator[i], 0, Nnue_Activation_Max);
+            sum += activation * weights[i];
+        }
+        return sum;
+    }
+
+#ifdef WISDOM_CHESS_NNUE_X86_KERNELS
+    __attribute__ ((target ("sse4.1"))) static void
+    sse41AddRow (NnueRow accumulator, ConstNnueRow row)
+    {
+        for (int i = 0; i < Nnue_Hidden_Size; i += 8)
+        {
+            auto* dst = reinterpret_cast<__m128i*> (&accumulator[i]);
+            auto src = _mm_loadu_si128 (reinterpret_cast<const __m128i*> (&row[i]));
+            _mm_storeu_si128 (dst, _mm_add_epi16 (_mm_loadu_si128 (dst), src));
+        }
+    }
+
+    __attribute__ ((target ("sse4.1"))) static void
+    sse41SubRow (NnueRow accumulator, ConstNnueRow row)
+    {
+        for (int i = 0; i < Nnue_Hidden_Size; i += 8)
+        {
+            auto* dst = reinterpret_cast<__m128i*> (&accumulator[i]);
+            auto src = _mm_loadu_si128 (reinterpret_cast<const __m128i*> (&row[i]));
+            _mm_storeu_si128 (dst, _mm_sub_epi16 (_mm_loadu_si128 (dst), src));
+        }
+    }
+
+    __attribute__ ((target ("sse4.1"))) [[nodiscard]] static auto
+    sse41Output (ConstNnueRow accumulator, ConstNnueOutputWeights weights)
+        -> int32_t
+    {
+        auto zero = _mm_setzero_si128();
+        auto max = _mm_set1_epi16 (Nnue_Activation_Max);
+        auto sum = _mm_setzero_si128();
+
+        for (int i = 0; i < Nnue_Hidden_Size; i += 8)
+        {
+            auto values = _mm_loadu_si128 (reinterpret_cast<const __m128i*> (&accumulator[i]));
+            values = _mm_min_epi16 (_mm_max_epi16 (values, zero), max);
+            auto factors = _mm_cvtepi8_epi16 (
+                _mm_loadl_epi64 (reinterpret_cast<const __m128i*> (&weights[i]))
+            );
+            sum = _mm_add_epi32 (sum, _mm_madd_epi16 (values, factors));
+        }
+
+        sum = _mm_add_epi32 (sum, _mm_shuffle_epi32 (sum, 0x4e));
+        sum = _mm_add_epi32 (sum, _mm_shuffle_epi32 (sum, 0xb1));
+        return _mm_cvtsi128_si32 (sum);
+    }
+
+    __attribute__ ((target ("avx2"))) static void
+    avx2AddRow (NnueRow accumulator, ConstNnueRow row)
+    {
+        for (int i = 0; i < Nnue_Hidden_Size; i += 16)
+        {
+            auto* dst = reinterpret_cast<__m256i*> (&accumulator[i]);
+            auto src = _mm256_loadu_si256 (reinterpret_cast<const __m256i*> (&row[i]));
+            _mm256_storeu_si256 (dst, _mm256_add_epi16 (_mm256_loadu_si256 (dst), src));
+        }
+    }
+
+    __attribute__ ((target ("avx2"))) static void
+    avx2SubRow (NnueRow accumulator, ConstNnueRow row)
+    {
+        for (int i = 0; i < Nnue_Hidden_Size; i += 16)
+        {
+            auto* dst = reinterpret_cast<__m256i*> (&accumulator[i]);
+            auto src = _mm256_loadu_si256 (reinterpret_cast<const __m256i*> (&row[i]));
+            _mm256_storeu_si256 (dst, _mm256_sub_epi16 (_mm256_loadu_si256 (dst), src));
+        }
+    }
+
+    __attribute__ ((target ("avx2"))) [[nodiscard]] static auto
+    avx2Output (ConstNnueRow accumulator, ConstNnueOutputWeights weights)
+        -> int32_t
+    {
+        auto zero = _mm256_setzero_si256();
+        auto max = _mm256_set1_epi16 (Nnue_Activation_Max);
+        auto sum = _mm256_setzero_si256();
+
+        for (int i = 0; i < Nnue_Hidden_Size; i += 16)
+        {
+            auto values = _mm256_loadu_si256 (reinterpret_cast<const __m256i*> (&accumulator[i]));
+            values = _mm256_min_epi16 (_mm256_max_epi16 (values, zero), max);
+            auto factors = _mm256_cvtepi8_epi16 (
+                _mm_loadu_si128 (reinterpret_cast<const __m128i*> (&weights[i]))
+            );
+            sum = _mm256_add_epi32 (sum, _mm256_madd_epi16 (values, factors));
+        }
+
+        auto half = _mm_add_epi32 (_mm256_castsi256_si128 (sum), _mm256_extracti128_si256 (sum, 1));
+        half = _mm_add_epi32 (half, _mm_shuffle_epi32 (half, 0x4e));
+        half = _mm_add_epi32 (half, _mm_shuffle_epi32 (half, 0xb1));
+        return _mm_cvtsi128_si32 (half);
+    }
+#endif
+
+    static void
+    addRow (NnueKernel kernel, NnueRow accumulator, ConstNnueRow row)
+    {
+        switch (kernel)
+        {
+#ifdef WISDOM_CHESS_NNUE_X86_KERNELS
+            case NnueKernel::Avx2:
+                return avx2AddRow (accumulator, row);
+            case NnueKernel::Sse41:
+                return sse41AddRow (accumulator, row);
+#endif
+            default:
+                return scalarAddRow (accumulator, row);
+        }
+    }
+
+    static void
+    subRow (NnueKernel kernel, NnueRow accumulator, ConstNnueRow row)
+    {
+        switch (kernel)
+        {
+#ifdef WISDOM_CHESS_NNUE_X86_KERNELS
+            case NnueKernel::Avx2:
+                return avx2SubRow (accumulator, row);
+            case NnueKernel::Sse41:
+                return sse41SubRow (accumulator, row);
+#endif
+            default:
+                return scalarSubRow (accumulator, row);
+        }
+    }
+
+    [[nodiscard]] static auto
+    output (NnueKernel kernel, ConstNnueRow accumulator, ConstNnueOutputWeights weights)
+        -> int32_t
+    {
+        switch (kernel)
+        {
+#ifdef WISDOM_CHESS_NNUE_X86_KERNELS
+            case NnueKernel::Avx2:
+                return avx2Output (accumulator, weights);
+            case NnueKernel::Sse41:
+                return sse41Output (accumulator, weights);
+#endif
+            default:
+                return scalarOutput (accumulator, weights);
+        }
+    }
+
+    auto
+    isNnueKernelSupported (NnueKernel kernel)
+        -> bool
+    {
+        switch (kernel)
+        {
+            case NnueKernel::Scalar:
+                return true;
+#ifdef WISDOM_CHESS_NNUE_X86_KERNELS
+            case NnueKernel::Sse41:
+                return __builtin_cpu_supports ("sse4.1");
+            case NnueKernel::Avx2:
+                return __builtin_cpu_supports ("avx2");
+#else
+            case NnueKernel::Sse41:
+            case NnueKernel::Avx2:
+                return false;
+#endif
+        }
+        std::terminate();
+    }
+
+    auto
+    bestNnueKernel()
+        -> NnueKernel
+    {
+        static const NnueKernel best = []
+        {
+            if (isNnueKernelSupported (NnueKernel::Avx2))
+                return NnueKernel::Avx2;
+            if (isNnueKernelSupported (NnueKernel::Sse41))
+                return NnueKernel::Sse41;
+            return NnueKernel::Scalar;
+        }();
+        return best;
+    }
+
+    auto
+    asString (NnueKernel kernel)
+        -> string
+    {
+        switch (kernel)
+        {
+            case NnueKernel::Scalar: return "scalar";
+            case NnueKernel::Sse41: return "sse4.1";
+            case NnueKernel::Avx2: return "avx2";
+        }
+        std::terminate();
+    }
+
+    auto
+    NnueWeights::random (uint64_t seed)
+        -> NnueWeights
+    {
+        std::mt19937_64 generator { seed };
+        std::uniform_int_distribution<int> bias_distribution { 0, 40 };
+        std::uniform_int_distribution<int> feature_distribution { -8, 8 };
+        std::uniform_int_distribution<int> output_distribution { -32, 32 };
+
+        NnueWeights result;
+        result.feature_biases.resize (Nnue_Hidden_Size);
+        for (auto& bias : result.feature_biases)
+            bias = narrow_cast<int16_t> (bias_distribution (generator));
+
+        result.feature_weights.resize (static_cast<size_t> (Nnue_Feature_Count) * Nnue_Hidden_Size);
+        for (auto& weight : result.feature_weights)
+            weight = narrow_cast<int16_t> (feature_distribution (generator));
+
+        result.output_weights.resize (Num_Players * Nnue_Hidden_Size);
+        for (auto& weight : result.output_weights)
+            weight = narrow_cast<int8_t> (output_distribution (generator));
+
+        result.output_bias = 0;
+        result.output_divisor = 16;
+        return result;
+    }
+
+    static void
+    validateHeader (const NnueFileHeader& header, uint64_t file_size, const string& path)
+    {
+        if (std::memcmp (header.magic, Nnue_File_Magic, sizeof (header.magic)) != 0)
+            throw NnueFileError { "Not a network file", path };
+
+        if (header.version != Nnue_File_Version)
+            throw NnueFileError { "Unsupported network file version", path };
+
+        if (header.feature_count != static_cast<uint32_t> (Nnue_Feature_Count)
+            || header.hidden_size != static_cast<uint32_t> (Nnue_Hidden_Size))
+        {
+            throw NnueFileError { "Network has the wrong architecture", path };
+        }
+
+        if (header.output_divisor <= 0)
+            throw NnueFileError { "Invalid network output divisor", path };
+
+        if (file_size != Nnue_File_Size)
+            throw NnueFileError { "Network file has the wrong size", path };
+    }
+
+    NnueNetwork::~NnueNetwork()
+    {
+#ifndef _WIN32
+        if (my_mapping != nullptr)
+            ::munmap (my_mapping, my_mapping_size);
+#endif
+    }
+
+    void
+    NnueNetwork::usePointers (const NnueWeights& weights)
+    {
+        my_feature_biases = weights.feature_biases.data();
+        my_feature_weights = weights.feature_weights.data();
+        my_output_weights = weights.output_weights.data();
+        my_output_bias = weights.output_bias;
+        my_output_divisor = weights.output_divisor;
+    }
+
+    auto
+    NnueNetwork::fromWeights (NnueWeights weights)
+        -> shared_ptr<NnueNetwork>
+    {
+        Expects (weights.feature_biases.size() == Nnue_Hidden_Size);
+        Expects (weights.feature_weights.size() == static_cast<size_t> (Nnue_Feature_Count) * Nnue_Hidden_Size);
+        Expects (weights.output_weights.size() == Num_Players * Nnue_Hidden_Size);
+        Expects (weights.output_divisor > 0);
+
+        shared_ptr<NnueNetwork> result { new NnueNetwork {} };
+        result->my_owned_weights = std::move (weights);
+        result->usePointers (result->my_owned_weights);
+        return result;
+    }
+
+#ifndef _WIN32
+    auto
+    NnueNetwork::load (const string& path)
+        -> shared_ptr<NnueNetwork>
+    {
+        int fd = ::open (path.c_str(), O_RDONLY);
+        if (fd < 0)
+            throw NnueFileError { "Unable to open network file", path };
+
+        auto close_file = gsl::finally ([fd] { ::close (fd); });
+
+        struct stat file_stat {};
+        if (::fstat (fd, &file_stat) != 0)
+            throw NnueFileError { "Unable to open network file", path };
+
+        auto file_size = static_cast<uint64_t> (file_stat.st_size);
+
+        NnueFileHeader header {};
+        if (file_size < sizeof (header)
+            || ::pread (fd, &header, sizeof (header), 0) != static_cast<ssize_t> (sizeof (header)))
+        {
+            throw NnueFileError { "Not a network file", path };
+        }
+
+        validateHeader (header, file_size, path);
+
+        // The weights are only ever read, so a shared read-only mapping lets
+        // every process using the same file share the same pages.
+        auto mapped_length = narrow<size_t> (file_size);
+        void* mapping = ::mmap (nullptr, mapped_length, PROT_READ, MAP_SHARED, fd, 0);
+        if (mapping == MAP_FAILED)
+            throw NnueFileError { "Unable to map network file", path };
+
+        shared_ptr<NnueNetwork> result { new NnueNetwork {} };
+        result->my_mapping = mapping;
+        result->my_mapping_size = mapped_length;
+        result->my_path = path;
+
+        auto* data = static_cast<const char*> (mapping) + sizeof (NnueFileHeader);
+        result->my_feature_biases = reinterpret_cast<const int16_t*> (data);
+        data += Nnue_Feature_Biases_Size;
+        result->my_feature_weights = reinterpret_cast<const int16_t*> (data);
+        data += Nnue_Feature_Weights_Size;
+        result->my_output_weights = reinterpret_cast<const int8_t*> (data);
+        result->my_output_bias = header.output_bias;
+        result->my_output_divisor = header.output_divisor;
+        return result;
+    }
+#else
+    auto
+    NnueNetwork::load (const string& path)
+        -> shared_ptr<NnueNetwork>
+    {
+        // No mmap() here, so read the weights into memory instead.
+        std::ifstream input { path, std::ios::binary };
+        if (!input)
+            throw NnueFileError { "Unable to open network file", path };
+
+        std::error_code error;
+        auto file_size = static_cast<uint64_t> (std::filesystem::file_size (path, error));
+        if (error)
+            throw NnueFileError { "Unable to open network file", path };
+
+        NnueFileHeader header {};
+        if (file_size < sizeof (header) || !input.read (reinterpret_cast<char*> (&header), sizeof (header)))
+            throw NnueFileError { "Not a network file", path };
+
+        validateHeader (header, file_size, path);
+
+        NnueWeights weights;
+        weights.feature_biases.resize (Nnue_Hidden_Size);
+        weights.feature_weights.resize (static_cast<size_t> (Nnue_Feature_Count) * Nnue_Hidden_Size);
+        weights.output_weights.resize (Num_Players * Nnue_Hidden_Size);
+        weights.output_bias = header.output_bias;
+        weights.output_divisor = header.output_divisor;
+
+        input.read (reinterpret_cast<char*> (weights.feature_biases.data()), Nnue_Feature_Biases_Size);
+        input.read (reinterpret_cast<char*> (weights.feature_weights.data()), Nnue_Feature_Weights_Size);
+        input.read (reinterpret_cast<char*> (weights.output_weights.data()), Nnue_Output_Weights_Size);
+        if (!input)
+            throw NnueFileError { "Network file is truncated", path };
+
+        auto result = fromWeights (std::move (weights));
+        result->my_path = path;
+        return result;
+    }
+#endif
+
+    void
+    NnueNetwork::saveTo (const string& path) const
+    {
+        NnueFileHeader header {};
+        std::memcpy (header.magic, Nnue_File_Magic, sizeof (header.magic));
+        header.version = Nnue_File_Version;
+        header.feature_count = Nnue_Feature_Count;
+        header.hidden_size = Nnue_Hidden_Size;
+        header.output_bias = my_output_bias;
+        header.output_divisor = my_output_divisor;
+
+        std::ofstream output { path, std::ios::binary | std::ios::trunc };
+        if (!output)
+            throw NnueFileError { "Unable to create network file", path };
+
+        output.write (reinterpret_cast<const char*> (&header), sizeof (header));
+        output.write (reinterpret_cast<const char*> (my_feature_biases), Nnue_Feature_Biases_Size);
+        output.write (reinterpret_cast<const char*> (my_feature_weights), Nnue_Feature_Weights_Size);
+        output.write (reinterpret_cast<const char*> (my_output_weights), Nnue_Output_Weights_Size);
+        output.close();
+
+        if (!output)
+            throw NnueFileError { "Unable to write network file", path };
+    }
+
+    void
+    NnueNetwork::setKernel (NnueKernel kernel)
+    {
+        Expects (isNnueKernelSupported (kernel));
+        my_kernel = kernel;
+    }
+
+    // Flip the board vertically for black, so both sides see their own
+    // pieces from the same side of the board.
+    [[nodiscard]] static auto
+    orient (Color perspective, Coord coord)
+        -> int
+    {
+        return perspective == Color::White ? coord.index() : coord.index() ^ 56;
+    }
+
+    auto
+    NnueNetwork::featureRow (Color perspective, Coord king, Coord coord, ColoredPiece piece) const
+        -> const int16_t*
+    {
+        assert (pieceType (piece) != Piece::None && pieceType (piece) != Piece::King);
+
+        int kind = (toInt (pieceType (piece)) - 1) * 2 + (pieceColor (piece) == perspective ? 0 : 1);
+        auto feature = static_cast<size_t> (
+            (orient (perspective, king) * Nnue_Piece_Kinds + kind) * Num_Squares + orient (perspective, coord)
+        );
+        return my_feature_weights + feature * Nnue_Hidden_Size;
+    }
+
+    [[nodiscard]] static auto
+    isFeature (ColoredPiece piece)
+        -> bool
+    {
+        auto type = pieceType (piece);
+        return type != Piece::None && type != Piece::King;
+    }
+
+    void
+    NnueNetwork::refresh (const Board& board, Color perspective, NnueAccumulator& result) const
+    {
+        auto& values = result.values[colorIndex (perspective)];
+        std::copy_n (my_feature_biases, Nnue_Hidden_Size, values.begin());
+
+        auto king = board.getKingPosition (perspective);
+        for (auto coord : Board::allCoords())
+        {
+            auto piece = board.pieceAt (coord);
+            if (isFeature (piece))
+                addRow (my_kernel, values, ConstNnueRow { featureRow (perspective, king, coord, piece), Nnue_Hidden_Size });
+        }
+    }
+
+    void
+    NnueNetwork::refresh (const Board& board, NnueAccumulator& result) const
+    {
+        refresh (board, Color::White, result);
+        refresh (board, Color::Black, result);
+    }
+
+    void
+    NnueNetwork::update (
+        const NnueAccumulator& parent,
+        const Board& board,
+        NnueAccumulator& result
+    ) const
+    {
+        auto changes = board.getLastMoveChanges();
+
+        for (auto perspective : { Color::White, Color::Black })
+        {
+            auto own_king = ColoredPiece::make (perspective, Piece::King);
+            bool king_moved = std::any_of (changes.begin(), changes.end(), [own_king] (const SquareChange& change)
+            {
+                return change.removed == own_king || change.added == own_king;
+            });
+
+            // Every feature is relative to the king, so they all change when
+            // it moves.
+            if (king_moved)
+            {
+                refresh (board, perspective, result);
+                continue;
+            }
+
+            auto index = colorIndex (perspective);
+            auto& values = result.values[index];
+            if (&parent != &result)
+                values = parent.values[index];
+
+            auto king = board.getKingPosition (perspective);
+            for (const auto& change : changes)
+            {
+                if (isFeature (change.removed))
+                {
+                    subRow (my_kernel, values,
+                        ConstNnueRow { featureRow (perspective, king, change.coord, change.removed), Nnue_Hidden_Size });
+                }
+                if (isFeature (change.added))
+                {
+                    addRow (my_kernel, values,
+                        ConstNnueRow { featureRow (perspective, king, change.coord, change.added), Nnue_Hidden_Size });
+                }
+            }
+        }
+    }
+
+    auto
+    NnueNetwork::evaluate (const NnueAccumulator& accumulator, Color who) const
+        -> int
+    {
+        auto mine = colorIndex (who);
+        auto theirs = colorIndex (colorInvert (who));
+
+        int32_t sum = my_output_bias;
+        sum += output (my_kernel, accumulator.values[mine],
+            ConstNnueOutputWeights { my_output_weights, Nnue_Hidden_Size });
+        sum += output (my_kernel, accumulator.values[theirs],
+            ConstNnueOutputWeights { my_output_weights + Nnue_Hidden_Size, Nnue_Hidden_Size });
+
+        return sum / my_output_divisor;
+    }
+}
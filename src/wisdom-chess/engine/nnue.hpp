@@ -0,0 +1,153 @@
+#pragma once
+
+#include "wisdom-chess/engine/global.hpp"
+#include "wisdom-chess/engine/coord.hpp"
+#include "wisdom-chess/engine/piece.hpp"
+
+namespace wisdom
+{
+    class Board;
+
+    class NnueFileError : public Error
+    {
+    public:
+        NnueFileError (string message, string path) noexcept
+            : Error { std::move (message), std::move (path) }
+        {
+        }
+    };
+
+    // The network's input features are king-relative: each non-king piece on
+    // a square, seen from one side's perspective, relative to that side's king
+    // square. Both kings are left out of the features, which is what lets the
+    // accumulator be updated incrementally unless the perspective's own king
+    // moves.
+    inline constexpr int Nnue_Piece_Kinds = 10;
+    inline constexpr int Nnue_Feature_Count = Num_Squares * Nnue_Piece_Kinds * Num_Squares;
+    inline constexpr int Nnue_Hidden_Size = 128;
+
+    // The hidden layer is clamped to this range before the output layer.
+    inline constexpr int16_t Nnue_Activation_Max = 127;
+
+    // The first layer's output for both perspectives, indexed by color index.
+    struct NnueAccumulator
+    {
+        alignas (64) array<array<int16_t, Nnue_Hidden_Size>, Num_Players> values;
+    };
+
+    // The weights of a network, quantized to 16 bits for the first layer and
+    // 8 bits for the output layer.
+    struct NnueWeights
+    {
+        vector<int16_t> feature_biases;
+        vector<int16_t> feature_weights;
+        vector<int8_t> output_weights;
+        int32_t output_bias = 0;
+        int32_t output_divisor = 1;
+
+        // Weights without any meaning, for testing and benchmarking.
+        [[nodiscard]] static auto
+        random (uint64_t seed)
+            -> NnueWeights;
+    };
+
+    enum class NnueKernel
+    {
+        Scalar,
+        Sse41,
+        Avx2,
+    };
+
+    [[nodiscard]] auto
+    isNnueKernelSupported (NnueKernel kernel)
+        -> bool;
+
+    // The fastest kernel the processor we're running on supports.
+    [[nodiscard]] auto
+    bestNnueKernel()
+        -> NnueKernel;
+
+    [[nodiscard]] auto
+    asString (NnueKernel kernel)
+        -> string;
+
+    // An efficiently updatable neural network for evaluating positions.
+    //
+    // The network file is mapped into memory read-only where the platform
+    // allows, so several engines loading the same file share one copy.
+    class NnueNetwork
+    {
+    public:
+        NnueNetwork (const NnueNetwork&) = delete;
+        auto operator= (const NnueNetwork&) -> NnueNetwork& = delete;
+
+        ~NnueNetwork();
+
+        [[nodiscard]] static auto
+        load (const string& path)
+            -> shared_ptr<NnueNetwork>;
+
+        [[nodiscard]] static auto
+        fromWeights (NnueWeights weights)
+            -> shared_ptr<NnueNetwork>;
+
+        void saveTo (const string& path) const;
+
+        // Compute the accumulator for both perspectives from scratch.
+        void refresh (const Board& board, NnueAccumulator& result) const;
+
+        void refresh (const Board& board, Color perspective, NnueAccumulator& result) const;
+
+        // Compute the accumulator of a board from its parent's, using the
+        // squares changed by the move that made it.
+        void update (
+            const NnueAccumulator& parent,
+            const Board& board,
+            NnueAccumulator& result
+        ) const;
+
+        // The score for the side to move.
+        [[nodiscard]] auto
+        evaluate (const NnueAccumulator& accumulator, Color who) const
+            -> int;
+
+        [[nodiscard]] auto
+        getKernel() const
+            -> NnueKernel
+        {
+            return my_kernel;
+        }
+
+        // Change the kernel, which must be supported by the processor.
+        void setKernel (NnueKernel kernel);
+
+        [[nodiscard]] auto
+        getPath() const
+            -> const string&
+        {
+            return my_path;
+        }
+
+    private:
+        NnueNetwork() = default;
+
+        void usePointers (const NnueWeights& weights);
+
+        [[nodiscard]] auto
+        featureRow (Color perspective, Coord king, Coord coord, ColoredPiece piece) const
+            -> const int16_t*;
+
+        NnueKernel my_kernel = bestNnueKernel();
+        string my_path;
+
+        NnueWeights my_owned_weights;
+        void* my_mapping = nullptr;
+        size_t my_mapping_size = 0;
+
+        const int16_t* my_feature_biases = nullptr;
+        const int16_t* my_feature_weights = nullptr;
+        const int8_t* my_output_weights = nullptr;
+        int32_t my_output_bias = 0;
+        int32_t my_output_divisor = 1;
+    };
+}
@@ -0,0 +1,183 @@
+#include "wisdom-chess/engine/pawn_structure.hpp"
+#include "wisdom-chess/engine/board.hpp"
+#include "wisdom-chess/engine/material.hpp"
+
+namespace wisdom
+{
+    // In the same units as the material weights, where a pawn is 100.
+    static constexpr int Doubled_Pawn_Penalty = 12;
+    static constexpr int Isolated_Pawn_Penalty = 15;
+    static constexpr int Backward_Pawn_Penalty = 10;
+
+    // Bonus for a passed pawn, by the number of rows it has advanced.
+    static constexpr array<int, Num_Rows> Passed_Pawn_Bonus = { 5, 10, 20, 35, 60, 100, 0, 0 };
+
+    using PawnGrid = array<array<bool, Num_Columns>, Num_Rows>;
+
+    [[nodiscard]] static auto
+    hasPawnOnColumn (const PawnGrid& pawns, int col)
+        -> bool
+    {
+        if (col < 0 || col >= Num_Columns)
+            return false;
+
+        for (int row = 0; row < Num_Rows; row++)
+        {
+            if (pawns[row][col])
+                return true;
+        }
+        return false;
+    }
+
+    // Whether the row is strictly in front of the other row for the color.
+    [[nodiscard]] static auto
+    isAhead (Color who, int row, int other_row)
+        -> bool
+    {
+        return who == Color::White ? row < other_row : row > other_row;
+    }
+
+    [[nodiscard]] static auto
+    isPassed (Color who, const PawnGrid& enemy_pawns, int pawn_row, int pawn_col)
+        -> bool
+    {
+        for (int col = std::max (pawn_col - 1, 0); col <= std::min (pawn_col + 1, Last_Column); col++)
+        {
+            for (int row = 0; row < Num_Rows; row++)
+            {
+                if (enemy_pawns[row][col] && isAhead (who, row, pawn_row))
+                    return false;
+            }
+        }
+        return true;
+    }
+
+    // A pawn is backward when its neighbors have all advanced past it, so none
+    // can defend it, and an enemy pawn stops it from advancing to join them.
+    [[nodiscard]] static auto
+    isBackward (
+        Color who,
+        const PawnGrid& own_pawns,
+        const PawnGrid& enemy_pawns,
+        int pawn_row,
+        int pawn_col
+    )
+        -> bool
+    {
+        for (int col : { pawn_col - 1, pawn_col + 1 })
+        {
+            if (col < 0 || col >= Num_Columns)
+                continue;
+
+            for (int row = 0; row < Num_Rows; row++)
+            {
+                if (own_pawns[row][col] && !isAhead (who, row, pawn_row))
+                    return false;
+            }
+        }
+
+        int direction = pawnDirection<int> (who);
+        int attacker_row = pawn_row + 2 * direction;
+        if (attacker_row < 0 || attacker_row >= Num_Rows)
+            return false;
+
+        return (pawn_col > 0 && enemy_pawns[attacker_row][pawn_col - 1])
+            || (pawn_col < Last_Column && enemy_pawns[attacker_row][pawn_col + 1]);
+    }
+
+    static void
+    analyzeColor (
+        PawnStructure& result,
+        Color who,
+        const PawnGrid& own_pawns,
+        const PawnGrid& enemy_pawns
+    ) {
+        auto index = colorIndex (who);
+
+        for (int col = 0; col < Num_Columns; col++)
+        {
+            int count_on_column = 0;
+            bool isolated = !hasPawnOnColumn (own_pawns, col - 1)
+                && !hasPawnOnColumn (own_pawns, col + 1);
+
+            for (int row = 0; row < Num_Rows; row++)
+            {
+                if (!own_pawns[row][col])
+                    continue;
+
+                count_on_column++;
+
+                if (isolated)
+                    result.isolated[index] -= Isolated_Pawn_Penalty;
+                else if (isBackward (who, own_pawns, enemy_pawns, row, col))
+                    result.backward[index] -= Backward_Pawn_Penalty;
+
+                if (isPassed (who, enemy_pawns, row, col))
+                {
+                    int advanced = who == Color::White ? (Num_Rows - 2 - row) : (row - 1);
+                    result.passed[index] += Passed_Pawn_Bonus[std::clamp (advanced, 0, Num_Rows - 1)];
+                    result.passed_pawns[index] |= uint64_t { 1 } << makeCoord (row, col).index();
+                }
+            }
+
+            if (count_on_column > 1)
+                result.doubled[index] -= (count_on_column - 1) * Doubled_Pawn_Penalty;
+        }
+
+        result.doubled[index] = Material::scaledScore (result.doubled[index]);
+        result.isolated[index] = Material::scaledScore (result.isolated[index]);
+        result.backward[index] = Material::scaledScore (result.backward[index]);
+        result.passed[index] = Material::scaledScore (result.passed[index]);
+    }
+
+    auto
+    analyzePawnStructure (const Board& board)
+        -> PawnStructure
+    {
+        array<PawnGrid, Num_Players> pawns {};
+
+        for (auto coord : Board::allCoords())
+        {
+            auto piece = board.pieceAt (coord);
+            if (piece.type() == Piece::Pawn)
+                pawns[colorIndex (piece.color())][coord.row()][coord.column()] = true;
+        }
+
+        PawnStructure result;
+        result.pawn_code = board.getPawnCode();
+
+        analyzeColor (result, Color::White, pawns[Color_Index_White], pawns[Color_Index_Black]);
+        analyzeColor (result, Color::Black, pawns[Color_Index_Black], pawns[Color_Index_White]);
+
+        return result;
+    }
+
+    PawnHashTable::PawnHashTable (size_t entry_count)
+        : my_entries (entry_count)
+        , my_size_mask { entry_count - 1 }
+    {
+        Expects (entry_count >= 2 && (entry_count & (entry_count - 1)) == 0);
+    }
+
+    auto
+    PawnHashTable::probe (const Board& board)
+        -> const PawnStructure&
+    {
+        my_probes++;
+
+        auto pawn_code = board.getPawnCode();
+
+        // The low bits of a board code hold metadata and are always zero here.
+        auto index = (pawn_code >> Total_Metadata_Bits) & my_size_mask;
+        auto& entry = my_entries[index];
+
+        if (entry.pawn_code == pawn_code)
+        {
+            my_hits++;
+            return entry;
+        }
+
+        entry = analyzePawnStructure (board);
+        return entry;
+    }
+}
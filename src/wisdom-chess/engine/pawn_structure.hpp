@@ -0,0 +1,98 @@
+#pragma once
+
+#include "wisdom-chess/engine/global.hpp"
+#include "wisdom-chess/engine/board_code.hpp"
+
+namespace wisdom
+{
+    class Board;
+
+    // Scores for the pawn structure of both sides. These only depend on
+    // where the pawns are, so they can be cached by the board's pawn code.
+    struct PawnStructure
+    {
+        BoardHashCode pawn_code = 0;
+
+        // Penalties are negative, bonuses positive, and all are scaled the
+        // same as the material score.
+        array<int, Num_Players> doubled {};
+        array<int, Num_Players> isolated {};
+        array<int, Num_Players> backward {};
+        array<int, Num_Players> passed {};
+
+        // Squares of each side's passed pawns, one bit per square index.
+        array<uint64_t, Num_Players> passed_pawns {};
+
+        [[nodiscard]] auto
+        total (Color who) const
+            -> int
+        {
+            auto index = colorIndex (who);
+            return doubled[index] + isolated[index] + backward[index] + passed[index];
+        }
+
+        // The score of the pawn structure from the point of view of the player.
+        [[nodiscard]] auto
+        overallScore (Color who) const
+            -> int
+        {
+            return total (who) - total (colorInvert (who));
+        }
+    };
+
+    // Work out the pawn structure of the board from scratch.
+    [[nodiscard]] auto
+    analyzePawnStructure (const Board& board)
+        -> PawnStructure;
+
+    struct PawnHashTableStats
+    {
+        size_t probes = 0;
+        size_t hits = 0;
+    };
+
+    [[nodiscard]] inline auto
+    computeHitRate (const PawnHashTableStats& start, const PawnHashTableStats& end)
+        -> double
+    {
+        auto delta_probes = end.probes - start.probes;
+        auto delta_hits = end.hits - start.hits;
+        return delta_probes > 0 ? (100.0 * static_cast<double> (delta_hits) / static_cast<double> (delta_probes)) : 0.0;
+    }
+
+    // Caches the pawn structure by pawn code. Pawns move much less often than
+    // other pieces, so most positions in a search share their pawn structure
+    // with one already analyzed.
+    class PawnHashTable
+    {
+    public:
+        static constexpr size_t Default_Entry_Count = 16 * 1024;
+
+        explicit PawnHashTable (size_t entry_count = Default_Entry_Count);
+
+        // Get the pawn structure of the board, analyzing it if it's not cached.
+        [[nodiscard]] auto
+        probe (const Board& board)
+            -> const PawnStructure&;
+
+        [[nodiscard]] auto
+        getSize() const
+            -> size_t
+        {
+            return my_entries.size();
+        }
+
+        [[nodiscard]] auto
+        getStats() const
+            -> PawnHashTableStats
+        {
+            return PawnHashTableStats { my_probes, my_hits };
+        }
+
+    private:
+        vector<PawnStructure> my_entries;
+        size_t my_size_mask;
+        size_t my_probes = 0;
+        size_t my_hits = 0;
+    };
+}
@@ -6,7 +6,7 @@
 namespace wisdom
 {
     // clang-format off
-    constexpr int pawn_positions[Num_Rows][Num_Columns] = {
+    constexpr int pawn_middlegame_positions[Num_Rows][Num_Columns] = {
             {  0,  0,  0,  0,  0,  0,  0,  0 },
             { +9, +9, +9, +9, +9, +9, +9, +9 },
             { +2, +2, +4, +6, +6, +4, +2, +2 },
@@ -17,7 +17,7 @@ namespace wisdom
             {  0,  0,  0,  0,  0,  0,  0,  0 },
     };
 
-    constexpr int king_positions[Num_Rows][Num_Columns] = {
+    constexpr int king_middlegame_positions[Num_Rows][Num_Columns] = {
             { -6, -8, -8, -9, -9, -4, -4, -6 },
             { -6, -8, -8, -9, -9, -4, -4, -6 },
             { -6, -8, -8, -9, -9, -4, -4, -6 },
@@ -71,22 +71,113 @@ namespace wisdom
             { -2,  0, +1,  0,  0,  0,  0, -2 },
             { -4, -2, -2, -1, -1, -2, -2, -4 },
     };
+
+    // In the endgame, pawns are worth more the closer they are to promoting,
+    // and the king should come out to the center instead of hiding.
+    constexpr int pawn_endgame_positions[Num_Rows][Num_Columns] = {
+            {  0,  0,  0,  0,  0,  0,  0,  0 },
+            { +9, +9, +9, +9, +9, +9, +9, +9 },
+            { +6, +6, +6, +6, +6, +6, +6, +6 },
+            { +4, +4, +4, +4, +4, +4, +4, +4 },
+            { +2, +2, +2, +2, +2, +2, +2, +2 },
+            { +1, +1, +1, +1, +1, +1, +1, +1 },
+            {  0,  0,  0,  0,  0,  0,  0,  0 },
+            {  0,  0,  0,  0,  0,  0,  0,  0 },
+    };
+
+    constexpr int king_endgame_positions[Num_Rows][Num_Columns] = {
+            { -9, -6, -4, -3, -3, -4, -6, -9 },
+            { -6, -3,  0, +1, +1,  0, -3, -6 },
+            { -4,  0, +3, +4, +4, +3,  0, -4 },
+            { -3, +1, +4, +6, +6, +4, +1, -3 },
+            { -3, +1, +4, +6, +6, +4, +1, -3 },
+            { -4,  0, +3, +4, +4, +3,  0, -4 },
+            { -6, -3,  0, +1, +1,  0, -3, -6 },
+            { -9, -6, -4, -3, -3, -4, -6, -9 },
+    };
     // clang-format on
 
-    static auto 
-    translatePosition (Coord coord, Color who)
-        -> Coord
+    using PieceSquareScores = int[Num_Rows][Num_Columns];
+
+    struct PieceSquareTables
+    {
+        const PieceSquareScores& middlegame;
+        const PieceSquareScores& endgame;
+    };
+
+    static constexpr auto
+    pieceSquareTables (Piece piece)
+        -> PieceSquareTables
+    {
+        switch (piece)
+        {
+            case Piece::Pawn:
+                return { pawn_middlegame_positions, pawn_endgame_positions };
+            case Piece::Knight:
+                return { knight_positions, knight_positions };
+            case Piece::Bishop:
+                return { bishop_positions, bishop_positions };
+            case Piece::Rook:
+                return { rook_positions, rook_positions };
+            case Piece::Queen:
+                return { queen_positions, queen_positions };
+            case Piece::King:
+                return { king_middlegame_positions, king_endgame_positions };
+            default:
+                std::terminate();
+        }
+    }
+
+    // One more than the largest ColoredPiece value, so a piece can index the table.
+    static constexpr int Num_Colored_Piece_Values =
+        (toInt (Color::Black) << Piece_Color_Shift) + static_cast<int> (Num_Piece_Types);
+
+    using PositionTable = array<array<TaperedScore, Num_Squares>, Num_Colored_Piece_Values>;
+
+    // The material and piece-square score of every piece on every square,
+    // already scaled and flipped for black, so updating the position for a
+    // piece is a single lookup.
+    static consteval auto
+    makePositionTable()
+        -> PositionTable
     {
-        if (who == Color::White)
-            return coord;
+        PositionTable result {};
+
+        for (auto color : { Color::White, Color::Black })
+        {
+            for (auto piece : { Piece::Pawn, Piece::Knight, Piece::Bishop,
+                                Piece::Rook, Piece::Queen, Piece::King })
+            {
+                auto tables = pieceSquareTables (piece);
+                auto material = Material::scaledScore (Material::weight (piece));
+                auto& scores = result[toInt8 (ColoredPiece::make (color, piece))];
+
+                for (int square = 0; square < Num_Squares; square++)
+                {
+                    // The tables are from white's point of view, so black's
+                    // pieces use them rotated.
+                    int table_square = color == Color::White ? square : Num_Squares - 1 - square;
+                    int row = table_square / Num_Columns;
+                    int col = table_square % Num_Columns;
+
+                    scores[square] = TaperedScore {
+                        .middlegame = material + tables.middlegame[row][col] * Position_Score_Scale,
+                        .endgame = material + tables.endgame[row][col] * Position_Score_Scale,
+                    };
+                }
+            }
+        }
+
+        return result;
+    }
 
-        int8_t row = coord.row();
-        int8_t col = coord.column();
+    static constexpr PositionTable Position_Table = makePositionTable();
 
-        return makeCoord (
-            narrow_cast<int8_t> (Last_Row - row),
-            narrow_cast<int8_t> (Last_Column - col)
-        );
+    [[nodiscard]] static auto
+    positionScore (Coord coord, ColoredPiece piece)
+        -> TaperedScore
+    {
+        return Position_Table[toInt8 (piece)][coord.index()];
     }
 
     static auto 
@@ -104,57 +195,23 @@ namespace wisdom
         }
     }
 
-    static auto 
-    change (Coord coord, Color who, ColoredPiece piece)
-        -> int
-    {
-        Coord translated_pos = translatePosition (coord, who);
-        int8_t row = translated_pos.row();
-        int8_t col = translated_pos.column();
-
-        // todo convert enum to integer index instead of using switch.
-        switch (pieceType (piece))
-        {
-            case Piece::Pawn:
-                return pawn_positions[row][col];
-            case Piece::Knight:
-                return knight_positions[row][col];
-            case Piece::Bishop:
-                return bishop_positions[row][col];
-            case Piece::Rook:
-                return rook_positions[row][col];
-            case Piece::Queen:
-                return queen_positions[row][col];
-            case Piece::King:
-                return king_positions[row][col];
-            default:
-                throw Error ("Invalid position of piece to change.");
-        }
-    }
-
-    auto 
-    Position::overallScore (Color who) const
+    auto
+    Position::overallScore (Color who, int phase) const
         -> int
     {
-        ColorIndex index = colorIndex (who);
-        ColorIndex inverted = colorIndex (colorInvert (who));
-        assert (this->my_score[index] < 3000 && this->my_score[index] > -3000);
-        assert (this->my_score[inverted] < 3000 && this->my_score[inverted] > -3000);
-        int result = this->my_score[index] - this->my_score[inverted];
-        assert (result < 3000);
-        return result * Position_Score_Scale;
+        auto mine = my_scores[colorIndex (who)];
+        auto theirs = my_scores[colorIndex (colorInvert (who))];
+        return (mine - theirs).blend (phase);
     }
 
-    void Position::add (Color who, Coord coord, ColoredPiece piece)
+    void Position::add (Coord coord, ColoredPiece piece)
     {
-        ColorIndex index = colorIndex (who);
-        this->my_score[index] += change (coord, who, piece);
+        my_scores[colorIndex (piece.color())] += positionScore (coord, piece);
     }
 
-    void Position::remove (Color who, Coord coord, ColoredPiece piece)
+    void Position::remove (Coord coord, ColoredPiece piece)
     {
-        ColorIndex index = colorIndex (who);
-        this->my_score[index] -= change (coord, who, piece);
+        my_scores[colorIndex (piece.color())] -= positionScore (coord, piece);
     }
 
     void Position::applyMove (Color who, ColoredPiece src_piece, Move move, ColoredPiece dst_piece)
@@ -164,7 +221,7 @@ namespace wisdom
         Coord src = move.getSrc();
         Coord dst = move.getDst();
 
-        this->remove (who, src, src_piece);
+        this->remove (src, src_piece);
 
         switch (move.getMoveCategory())
         {
@@ -174,18 +231,14 @@ namespace wisdom
             case MoveCategory::NormalCapturing:
                 {
                     Coord taken_piece_coord = dst;
-                    this->remove (opponent, taken_piece_coord, dst_piece);
+                    this->remove (taken_piece_coord, dst_piece);
                 }
                 break;
 
             case MoveCategory::EnPassant:
                 {
                     Coord taken_pawn_coord = enPassantTakenPawnCoord (src, dst);
-                    this->remove (
-                        opponent,
-                        taken_pawn_coord,
-                        ColoredPiece::make (opponent, Piece::Pawn)
-                    );
+                    this->remove (taken_pawn_coord, ColoredPiece::make (opponent, Piece::Pawn));
                 }
                 break;
 
@@ -205,8 +258,8 @@ namespace wisdom
                     Coord dst_rook_coord = makeCoord (rook_src_row, rook_dst_col);
                     ColoredPiece rook = ColoredPiece::make (who, Piece::Rook);
 
-                    this->remove (who, src_rook_coord, rook);
-                    this->add (who, dst_rook_coord, rook);
+                    this->remove (src_rook_coord, rook);
+                    this->add (dst_rook_coord, rook);
                 }
                 break;
 
@@ -218,14 +271,14 @@ namespace wisdom
             ? ColoredPiece::make (who, move.getPromotedPiece())
             : src_piece;
 
-        this->add (who, dst, new_piece);
+        this->add (dst, new_piece);
     }
 
-    auto 
+    auto
     Position::individualScore (Color who) const
-        -> int
+        -> TaperedScore
     {
-        return my_score[colorIndex (who)];
+        return my_scores[colorIndex (who)];
     }
 
     Position::Position (const Board& board)
@@ -234,7 +287,7 @@ namespace wisdom
         {
             auto piece = board.pieceAt (coord);
             if (piece != Piece_And_Color_None)
-                add (pieceColor (piece), coord, piece);
+                add (coord, piece);
         }
     }
 
@@ -242,6 +295,9 @@ namespace wisdom
     operator<< (std::ostream& ostream, Position& position) 
         -> std::ostream&
     {
-        return ostream << "{ " << position.my_score[0] << ", " << position.my_score[1] << "}";
+        const auto& white = position.my_scores[Color_Index_White];
+        const auto& black = position.my_scores[Color_Index_Black];
+        return ostream << "{ { " << white.middlegame << ", " << white.endgame << " }, { "
+                       << black.middlegame << ", " << black.endgame << " } }";
     }
 }
@@ -2,6 +2,7 @@
 
 #include "wisdom-chess/engine/global.hpp"
 #include "wisdom-chess/engine/coord.hpp"
+#include "wisdom-chess/engine/material.hpp"
 #include "wisdom-chess/engine/move.hpp"
 #include "wisdom-chess/engine/piece.hpp"
 
@@ -9,6 +10,54 @@ namespace wisdom
 {
     class Board;
 
+    // A score with separate values for the middlegame and the endgame, which
+    // are blended together depending on how much material is left.
+    struct TaperedScore
+    {
+        int middlegame = 0;
+        int endgame = 0;
+
+        constexpr auto
+        operator+= (TaperedScore other) noexcept
+            -> TaperedScore&
+        {
+            middlegame += other.middlegame;
+            endgame += other.endgame;
+            return *this;
+        }
+
+        constexpr auto
+        operator-= (TaperedScore other) noexcept
+            -> TaperedScore&
+        {
+            middlegame -= other.middlegame;
+            endgame -= other.endgame;
+            return *this;
+        }
+
+        [[nodiscard]] friend constexpr auto
+        operator- (TaperedScore first, TaperedScore second) noexcept
+            -> TaperedScore
+        {
+            return first -= second;
+        }
+
+        [[nodiscard]] friend constexpr auto
+        operator== (const TaperedScore& first, const TaperedScore& second) noexcept
+            -> bool = default;
+
+        // Blend the two values by the game phase: all middlegame at
+        // Max_Game_Phase, and all endgame at zero.
+        [[nodiscard]] constexpr auto
+        blend (int phase) const noexcept
+            -> int
+        {
+            return (middlegame * phase + endgame * (Max_Game_Phase - phase)) / Max_Game_Phase;
+        }
+    };
+
+    // Keeps the material and piece-square score of each side up to date as
+    // moves are made.
     class Position
     {
     public:
@@ -16,29 +65,28 @@ namespace wisdom
 
         explicit Position (const Board& board);
 
-        // My score minus my oppponent's score
-        [[nodiscard]] auto 
-        overallScore (Color who) const 
+        // My score minus my opponent's score, blended by the game phase.
+        [[nodiscard]] auto
+        overallScore (Color who, int phase) const
             -> int;
 
-        // The score for the individual player.
-        [[nodiscard]] auto 
-        individualScore (Color who) const 
-            -> int;
+        // The middlegame and endgame scores for the individual player.
+        [[nodiscard]] auto
+        individualScore (Color who) const
+            -> TaperedScore;
 
         // Apply the move to the position.
         void applyMove (Color who, ColoredPiece src_piece, Move move, ColoredPiece dst_piece);
 
-        friend auto 
-        operator<< (std::ostream& ostream, Position& position) 
+        friend auto
+        operator<< (std::ostream& ostream, Position& position)
             -> std::ostream&;
 
     private:
-        void add (Color who, Coord coord, ColoredPiece piece);
-        void remove (Color who, Coord coord, ColoredPiece piece);
+        void add (Coord coord, ColoredPiece piece);
+        void remove (Coord coord, ColoredPiece piece);
 
     private:
-        int my_score[Num_Players]{};
+        array<TaperedScore, Num_Players> my_scores {};
     };
 }
-
@@ -4,15 +4,33 @@
 
 #include "wisdom-chess/engine/piece.hpp"
 #include "wisdom-chess/engine/board.hpp"
+#include "wisdom-chess/engine/endgame.hpp"
+#include "wisdom-chess/engine/eval_cache.hpp"
 #include "wisdom-chess/engine/evaluate.hpp"
 #include "wisdom-chess/engine/search.hpp"
 #include "wisdom-chess/engine/logger.hpp"
+#include "wisdom-chess/engine/nnue.hpp"
+#include "wisdom-chess/engine/pawn_structure.hpp"
+#include "wisdom-chess/engine/tablebase.hpp"
+#include "wisdom-chess/engine/time_manager.hpp"
 #include "wisdom-chess/engine/transposition_table.hpp"
 
 namespace wisdom
 {
     using SystemClockTime = chrono::time_point<chrono::system_clock>;
 
+    // The pawn hash table is kept for the life of the thread, so a thread
+    // that searches again starts with the pawn structures it has already
+    // analyzed. Entries are checked against the whole pawn code, so they're
+    // good for any position.
+    static auto
+    threadPawnTable()
+        -> PawnHashTable&
+    {
+        thread_local PawnHashTable pawn_table;
+        return pawn_table;
+    }
+
     class IterativeSearchImpl
     {
     public:
@@ -22,7 +40,9 @@ namespace wisdom
             shared_ptr<Logger> output,
             MoveTimer timer,
             int total_depth,
-            TranspositionTable& transposition_table
+            TranspositionTable& transposition_table,
+            EvalCache* eval_cache,
+            const NnueNetwork* network
         )
             : my_original_board { Board { board } }
             , my_history { History { history } }
@@ -30,7 +50,15 @@ namespace wisdom
             , my_timer { std::move (timer) }
             , my_total_depth { total_depth }
             , my_transposition_table { transposition_table }
+            , my_eval_cache { eval_cache }
+            , my_network { network }
+            , my_pv_stride { std::max (total_depth, 0) + 2 }
         {
+            if (my_network != nullptr)
+                my_accumulators.resize (narrow<size_t> (total_depth + 2));
+
+            my_pv_table.resize (narrow<size_t> (my_pv_stride * my_pv_stride));
+            my_pv_length.resize (narrow<size_t> (my_pv_stride));
         }
 
         [[nodiscard]] auto
@@ -41,17 +69,147 @@ namespace wisdom
         iterate (Color side, int depth)
             -> SearchResult;
 
+        // Search the moves at the root, in the order of the root move list,
+        // and return the best score. With several lines wanted, the best
+        // moves end up at the front of the list in order.
+        auto
+        searchRoot (Color side, int depth)
+            -> int;
+
+        // Find the best of the root moves from this line onwards, leaving
+        // out the moves that were best for the earlier lines, and move it
+        // to the line's place in the list.
+        void searchRootLine (Color side, int depth, size_t line);
+
         // Search for the best move, and return the best score.
         auto
         search (const Board& parent_board, Color side, int depth,
                 int alpha, int beta, int ply)
             -> int;
 
+        // Evaluate a leaf of the search, using the evaluation cache if there is one.
+        [[nodiscard]] auto
+        evaluateLeaf (const Board& board, Color side, int moves_away, int ply, int alpha, int beta)
+            -> int;
+
+        // Evaluate with the network if there is one, or the classic evaluation.
+        [[nodiscard]] auto
+        staticEvaluation (const Board& board, Color side, int moves_away, int ply, int alpha, int beta)
+            -> int;
+
+        void setLazyEvaluationMargin (optional<int> margin)
+        {
+            my_lazy_evaluation_margin = margin;
+        }
+
+        [[nodiscard]] auto
+        getLazyEvaluationStats() const
+            -> LazyEvaluationStats
+        {
+            return my_lazy_evaluation_stats;
+        }
+
+        void setTablebase (const Tablebase* tablebase)
+        {
+            my_tablebase = tablebase;
+        }
+
+        void setNodeLimit (optional<int64_t> node_limit)
+        {
+            my_node_limit = node_limit;
+        }
+
+        void setSearchMoves (vector<Move> search_moves)
+        {
+            my_search_moves = std::move (search_moves);
+        }
+
+        void setListener (shared_ptr<SearchListener> listener)
+        {
+            my_listener = std::move (listener);
+        }
+
+        [[nodiscard]] auto
+        getRootMoves() const
+            -> const vector<RootMove>&
+        {
+            return my_root_moves;
+        }
+
+        // Fill in the root move list with the legal moves the search may
+        // play, the transposition table's best move first.
+        void buildRootMoves (Color side);
+
+        // Put the best move first among the root moves from the first one
+        // on, and the others in order of how many nodes it took to refute
+        // them. A move that was hard to refute is more likely to become the
+        // best one.
+        void sortRootMoves (size_t first, Move best_move);
+
+        void setMultiPv (int lines)
+        {
+            my_multi_pv = std::max (lines, 1);
+        }
+
+        // How many of the best lines to find, which can't be more than the
+        // number of moves.
+        [[nodiscard]] auto
+        multiPvLines() const
+            -> size_t
+        {
+            return std::min (narrow<size_t> (my_multi_pv), my_root_moves.size());
+        }
+
+        [[nodiscard]] auto
+        isNodeLimitReached() const
+            -> bool
+        {
+            return my_node_limit.has_value()
+                && my_total_nodes_visited + my_nodes_visited >= *my_node_limit;
+        }
+
+        // Whether the move can be played at the root, which is every move
+        // unless the search was restricted to some of them.
+        [[nodiscard]] auto
+        isSearchMove (Move move) const
+            -> bool
+        {
+            return my_search_moves.empty()
+                || std::find (my_search_moves.begin(), my_search_moves.end(), move) != my_search_moves.end();
+        }
+
+        // The exact score of a position in the tablebase, if it's there.
+        [[nodiscard]] auto
+        probeTablebase (const Board& board, Color side, int ply) const
+            -> optional<int>;
+
+        // Pick the move at the root from the tablebase, if the position is
+        // in it.
+        [[nodiscard]] auto
+        searchTablebaseRoot (Color side) const
+            -> optional<SearchResult>;
+
         // Get the best result the search found.
         [[nodiscard]] auto
         getBestResult() const
             -> SearchResult;
 
+        // Make the move followed by the child's line the line at this ply.
+        void updatePrincipalVariation (int ply, Move move);
+
+        // The line found from the root by the last search.
+        [[nodiscard]] auto
+        rootPrincipalVariation() const
+            -> vector<Move>;
+
+        // A line cut short by a transposition table hit is carried on with
+        // the best moves stored in the table, up to the depth searched.
+        void extendPrincipalVariation (Color side, vector<Move>& principal_variation, int depth) const;
+
+        // Tell the listener about one of the best lines of a depth that
+        // finished, numbered from one.
+        void reportLine (int depth, int line, int score, const vector<Move>& principal_variation) const;
+
         [[nodiscard]] auto
         moveTimer() const&
             -> const MoveTimer&
@@ -59,6 +217,13 @@ namespace wisdom
             return my_timer;
         }
 
+        [[nodiscard]] auto
+        getTotalNodesVisited() const
+            -> int64_t
+        {
+            return my_total_nodes_visited;
+        }
+
     private:
         Board my_original_board;
         History my_history;
@@ -66,18 +231,63 @@ namespace wisdom
         MoveTimer my_timer;
         shared_ptr<Logger> my_output;
         TranspositionTable& my_transposition_table;
+        EvalCache* my_eval_cache;
+
+        // The table of the thread running the search, looked up when it
+        // starts.
+        PawnHashTable* my_pawn_table = nullptr;
+
+        // The network's accumulator for the board at each ply.
+        const NnueNetwork* my_network;
+        vector<NnueAccumulator> my_accumulators;
+
+        optional<int> my_lazy_evaluation_margin = Default_Lazy_Evaluation_Margin;
+        LazyEvaluationStats my_lazy_evaluation_stats;
+
+        const Tablebase* my_tablebase = nullptr;
+
+        // Limits the nodes over all depths, so a search comes out the same
+        // every time however fast it runs.
+        optional<int64_t> my_node_limit {};
+
+        // The only moves to consider at the root, or all if empty.
+        vector<Move> my_search_moves {};
+
+        shared_ptr<SearchListener> my_listener {};
+
+        // Kept across depths, so each one starts with what the last one
+        // found out.
+        vector<RootMove> my_root_moves {};
+
+        // The number of best lines to find at the root.
+        int my_multi_pv = 1;
+
+        // The principal variation from each ply, as a triangular table: the
+        // row for a ply holds the best line from there, and only the first
+        // my_pv_length[ply] moves of it are filled in.
+        int my_pv_stride;
+        vector<Move> my_pv_table {};
+        vector<int> my_pv_length {};
+
+        // The line from the last depth that finished, which is searched
+        // first while the search is still following it.
+        vector<Move> my_previous_pv {};
+        bool my_following_pv = false;
 
         int my_total_depth;
         int my_search_depth {};
-        int my_nodes_visited = 0;
+        int my_selective_depth = 0;
+        int64_t my_nodes_visited = 0;
         int my_alpha_beta_cutoffs = 0;
-        int my_total_nodes_visited = 0;
+        int64_t my_total_nodes_visited = 0;
         int my_total_alpha_beta_cutoffs = 0;
         Color my_searching_color = Color::None;
     };
 
     IterativeSearch::~IterativeSearch() = default;
 
+    SearchListener::~SearchListener() = default;
+
     // Private constructor for factory functions
     IterativeSearch::IterativeSearch (unique_ptr<IterativeSearchImpl> impl)
         : impl { std::move (impl) }
@@ -101,7 +311,34 @@ namespace wisdom
                 std::move (logger),
                 timer,
                 max_depth,
-                transposition_table
+                transposition_table,
+                nullptr,
+                nullptr
+            )
+        };
+    }
+
+    auto IterativeSearch::create (
+        const Board& board,
+        const History& history,
+        shared_ptr<Logger> logger,
+        const MoveTimer& timer,
+        int max_depth,
+        TranspositionTable& transposition_table,
+        EvalCache& eval_cache,
+        const NnueNetwork* network
+    ) -> IterativeSearch
+    {
+        return IterativeSearch {
+            make_unique<IterativeSearchImpl> (
+                Board { board },
+                history,
+                std::move (logger),
+                timer,
+                max_depth,
+                transposition_table,
+                &eval_cache,
+                network
             )
         };
     }
@@ -120,6 +357,63 @@ namespace wisdom
         return impl->moveTimer().isCancelled();
     }
 
+    auto
+    IterativeSearch::getNodesVisited() const
+        -> int64_t
+    {
+        return impl->getTotalNodesVisited();
+    }
+
+    void
+    IterativeSearch::setLazyEvaluationMargin (optional<int> margin)
+    {
+        impl->setLazyEvaluationMargin (margin);
+    }
+
+    auto
+    IterativeSearch::getLazyEvaluationStats() const
+        -> LazyEvaluationStats
+    {
+        return impl->getLazyEvaluationStats();
+    }
+
+    void
+    IterativeSearch::setTablebase (const Tablebase* tablebase)
+    {
+        impl->setTablebase (tablebase);
+    }
+
+    void
+    IterativeSearch::setNodeLimit (optional<int64_t> node_limit)
+    {
+        impl->setNodeLimit (node_limit);
+    }
+
+    void
+    IterativeSearch::setSearchMoves (vector<Move> search_moves)
+    {
+        impl->setSearchMoves (std::move (search_moves));
+    }
+
+    void
+    IterativeSearch::setListener (shared_ptr<SearchListener> listener)
+    {
+        impl->setListener (std::move (listener));
+    }
+
+    void
+    IterativeSearch::setMultiPv (int lines)
+    {
+        impl->setMultiPv (lines);
+    }
+
+    auto
+    IterativeSearch::getRootMoves() const
+        -> vector<RootMove>
+    {
+        return impl->getRootMoves();
+    }
+
     auto 
     IterativeSearch::moveTimer() const& 
         -> const MoveTimer&
@@ -140,6 +434,163 @@ namespace wisdom
         return current_color == searching_color ? Min_Draw_Score : 0;
     }
 
+    void
+    IterativeSearchImpl::buildRootMoves (Color side)
+    {
+        my_root_moves.clear();
+
+        auto tt_move = my_transposition_table.getBestMove (my_original_board.getCode().getHashCode());
+        for (auto move : generateAllPotentialMoves (my_original_board, side, tt_move))
+        {
+            if (!isSearchMove (move))
+                continue;
+
+            auto child_board = my_original_board.withMove (side, move);
+            if (isLegalPositionAfterMove (child_board, side, move))
+                my_root_moves.push_back (RootMove { .move = move });
+        }
+    }
+
+    void
+    IterativeSearchImpl::sortRootMoves (size_t first, Move best_move)
+    {
+        std::stable_sort (
+            my_root_moves.begin() + narrow<std::ptrdiff_t> (first),
+            my_root_moves.end(),
+            [best_move] (const RootMove& a, const RootMove& b)
+            {
+                bool a_is_best = a.move == best_move;
+                bool b_is_best = b.move == best_move;
+                if (a_is_best != b_is_best)
+                    return a_is_best;
+
+                return a.nodes > b.nodes;
+            }
+        );
+    }
+
+    auto
+    IterativeSearchImpl::searchRoot (Color side, int depth) // NOLINT(misc-no-recursion)
+        -> int
+    {
+        my_pv_length[0] = 0;
+
+        if (isProbablyDrawingMove (my_original_board, side, Move {}, my_history))
+            return drawingScore (my_searching_color, side);
+
+        my_current_result.depth = depth;
+        if (my_root_moves.empty())
+        {
+            // With no legal moves, the side to move is in a stalemate or
+            // checkmate position.
+            my_current_result.score = evaluateWithoutLegalMoves (my_original_board, side, 0);
+            return my_current_result.score;
+        }
+
+        for (auto& root_move : my_root_moves)
+            root_move.nodes = 0;
+
+        auto lines = multiPvLines();
+        for (size_t line = 0; line < lines; line++)
+        {
+            searchRootLine (side, depth, line);
+            if (my_current_result.timed_out)
+                return -Initial_Alpha;
+        }
+
+        // A later line can come out ahead of an earlier one, because the
+        // transposition table knows more by the time it's searched.
+        std::stable_sort (
+            my_root_moves.begin(),
+            my_root_moves.begin() + narrow<std::ptrdiff_t> (lines),
+            [] (const RootMove& a, const RootMove& b) { return a.score > b.score; }
+        );
+        for (size_t line = 0; line < lines; line++)
+            extendPrincipalVariation (side, my_root_moves[line].principal_variation, depth);
+
+        const auto& best = my_root_moves.front();
+        my_current_result.move = best.move;
+        my_current_result.score = best.score;
+        my_current_result.principal_variation = best.principal_variation;
+
+        // With only some of the moves searched, the root's score isn't its
+        // real one.
+        if (my_search_moves.empty())
+        {
+            my_transposition_table.store (
+                my_original_board.getCode().getHashCode(),
+                best.score,
+                depth,
+                BoundType::Exact,
+                best.move,
+                0
+            );
+        }
+
+        return best.score;
+    }
+
+    void
+    IterativeSearchImpl::searchRootLine (Color side, int depth, size_t line) // NOLINT(misc-no-recursion)
+    {
+        // The root is searched with the full window, so alpha is always the
+        // best score so far and there are no cutoffs.
+        optional<Move> best_move {};
+        int best_score = -Initial_Alpha;
+        int move_number = narrow<int> (line);
+
+        for (auto it = my_root_moves.begin() + narrow<std::ptrdiff_t> (line); it != my_root_moves.end(); ++it)
+        {
+            if (my_timer.isTriggered() || isNodeLimitReached())
+            {
+                my_current_result.timed_out = true;
+                return;
+            }
+
+            auto& root_move = *it;
+            auto move = root_move.move;
+            Board child_board = my_original_board.withMove (side, move);
+            auto nodes_before = my_nodes_visited;
+            my_nodes_visited++;
+
+            if (my_listener != nullptr)
+            {
+                my_listener->rootMoveStarted (RootMoveStats {
+                    .depth = depth,
+                    .move = move,
+                    .move_number = ++move_number,
+                    .time = chrono::duration_cast<chrono::milliseconds> (my_timer.elapsed()),
+                });
+            }
+
+            if (my_network != nullptr)
+                my_network->update (my_accumulators[0], child_board, my_accumulators[1]);
+
+            my_history.addTentativePosition (child_board);
+
+            my_following_pv = !my_previous_pv.empty() && move == my_previous_pv.front();
+            int score = -1 * search (child_board, colorInvert (side), depth - 1, -Initial_Alpha, -best_score, 1);
+
+            my_history.removeLastTentativePosition();
+
+            if (my_current_result.timed_out)
+                return;
+
+            root_move.score = score;
+            root_move.nodes += my_nodes_visited - nodes_before;
+
+            if (score > best_score)
+            {
+                best_score = score;
+                best_move = move;
+                updatePrincipalVariation (0, move);
+                root_move.principal_variation = rootPrincipalVariation();
+            }
+        }
+
+        sortRootMoves (line, *best_move);
+    }
+
     auto
     IterativeSearchImpl::search ( // NOLINT(misc-no-recursion)
         const Board& parent_board,
@@ -151,14 +602,30 @@ namespace wisdom
     )
         -> int
     {
+        my_selective_depth = std::max (my_selective_depth, ply);
+        my_pv_length[narrow<size_t> (ply)] = 0;
+
         if (isProbablyDrawingMove (parent_board, side, Move {}, my_history))
         {
             return drawingScore (my_searching_color, side);
         }
 
+        // A known drawn ending can't become anything else, so there's no
+        // need to search it. The root still needs a move.
+        if (ply > 0 && isKnownEndgameDraw (parent_board, side))
+        {
+            return drawingScore (my_searching_color, side);
+        }
+
+        if (ply > 0)
+        {
+            if (auto tablebase_score = probeTablebase (parent_board, side, ply))
+                return *tablebase_score;
+        }
+
         if (depth <= 0)
         {
-            return evaluate (parent_board, side, my_search_depth - depth);
+            return evaluateLeaf (parent_board, side, my_search_depth - depth, ply, alpha, beta);
         }
 
         int original_alpha = alpha;
@@ -167,7 +634,10 @@ namespace wisdom
 
         auto hash = parent_board.getCode().getHashCode();
 
-        if (ply > 0)
+        // A stored score doesn't know about the history that led here, so don't
+        // trust it for a position that has already occurred: repeating it again
+        // may be a draw.
+        if (ply > 0 && !my_history.isProbablyNthRepetition (parent_board, 2))
         {
             if (auto tt_score = my_transposition_table.probe (hash, depth, alpha, beta, ply))
             {
@@ -178,14 +648,18 @@ namespace wisdom
             }
         }
 
-        auto tt_move = my_transposition_table.getBestMove (hash);
-        auto moves = generateAllPotentialMoves (parent_board, side, tt_move);
+        // Along the last depth's line, its move is likely still the best.
+        bool on_previous_pv = my_following_pv && ply < narrow<int> (my_previous_pv.size());
+        auto first_move = on_previous_pv
+            ? optional<Move> { my_previous_pv[narrow<size_t> (ply)] }
+            : my_transposition_table.getBestMove (hash);
+        auto moves = generateAllPotentialMoves (parent_board, side, first_move);
 
         for (auto move : moves)
         {
             int score;
 
-            if (my_timer.isTriggered())
+            if (my_timer.isTriggered() || isNodeLimitReached())
             {
                 my_current_result.timed_out = true;
                 return -Initial_Alpha;
@@ -198,8 +672,12 @@ namespace wisdom
 
             my_nodes_visited++;
 
+            if (my_network != nullptr)
+                my_network->update (my_accumulators[ply], child_board, my_accumulators[ply + 1]);
+
             my_history.addTentativePosition (child_board);
 
+            my_following_pv = on_previous_pv && move == my_previous_pv[narrow<size_t> (ply)];
             score = -1 * search (child_board, colorInvert (side), depth - 1, -beta, -alpha, ply + 1);
 
             if (score > best_score)
@@ -209,7 +687,10 @@ namespace wisdom
             }
 
             if (best_score > alpha)
+            {
                 alpha = best_score;
+                updatePrincipalVariation (ply, move);
+            }
 
             my_history.removeLastTentativePosition();
 
@@ -251,16 +732,143 @@ namespace wisdom
         return best_score;
     }
 
+    auto
+    IterativeSearchImpl::probeTablebase (const Board& board, Color side, int ply) const
+        -> optional<int>
+    {
+        if (my_tablebase == nullptr || board.getMaterial().totalPieceCount() > my_tablebase->maxPieces())
+            return nullopt;
+
+        auto result = my_tablebase->probe (board, side);
+        if (!result.has_value())
+            return nullopt;
+
+        switch (result->outcome)
+        {
+            case TablebaseOutcome::Win:
+                return checkmateScoreInMoves (ply + result->plies);
+            case TablebaseOutcome::Loss:
+                return -checkmateScoreInMoves (ply + result->plies);
+            case TablebaseOutcome::Draw:
+                return drawingScore (my_searching_color, side);
+        }
+
+        std::terminate();
+    }
+
+    auto
+    IterativeSearchImpl::searchTablebaseRoot (Color side) const
+        -> optional<SearchResult>
+    {
+        if (my_tablebase == nullptr)
+            return nullopt;
+
+        const auto& board = my_original_board;
+        if (board.getMaterial().totalPieceCount() > my_tablebase->maxPieces()
+            || !my_tablebase->probe (board, side).has_value())
+        {
+            return nullopt;
+        }
+
+        // The best move wins the fastest, or failing that draws, or failing
+        // that loses the slowest.
+        optional<SearchResult> best_result;
+        for (auto move : generateLegalMoves (board, side))
+        {
+            if (!isSearchMove (move))
+                continue;
+
+            auto child_board = board.withMove (side, move);
+            auto child_result = my_tablebase->probe (child_board, colorInvert (side));
+            if (!child_result.has_value())
+                return nullopt;
+
+            int score = 0;
+            switch (child_result->outcome)
+            {
+                case TablebaseOutcome::Loss:
+                    score = checkmateScoreInMoves (child_result->plies + 1);
+                    break;
+                case TablebaseOutcome::Win:
+                    score = -checkmateScoreInMoves (child_result->plies + 1);
+                    break;
+                case TablebaseOutcome::Draw:
+                    score = -drawingScore (my_searching_color, colorInvert (side));
+                    break;
+            }
+
+            if (!best_result.has_value() || score > best_result->score)
+                best_result = SearchResult { score, 1, move, false };
+        }
+
+        return best_result;
+    }
+
+    auto
+    IterativeSearchImpl::staticEvaluation (
+        const Board& board,
+        Color side,
+        int moves_away,
+        int ply,
+        int alpha,
+        int beta
+    )
+        -> int
+    {
+        if (my_network != nullptr)
+            return evaluate (board, side, moves_away, *my_network, my_accumulators[ply]);
+
+        if (my_lazy_evaluation_margin.has_value())
+        {
+            return evaluate (
+                board, side, moves_away, *my_pawn_table,
+                alpha, beta, *my_lazy_evaluation_margin, my_lazy_evaluation_stats
+            );
+        }
+
+        return evaluate (board, side, moves_away, *my_pawn_table);
+    }
+
+    auto
+    IterativeSearchImpl::evaluateLeaf (
+        const Board& board,
+        Color side,
+        int moves_away,
+        int ply,
+        int alpha,
+        int beta
+    )
+        -> int
+    {
+        if (my_eval_cache == nullptr)
+            return staticEvaluation (board, side, moves_away, ply, alpha, beta);
+
+        auto code = board.getCode().getHashCode();
+        if (auto cached_score = my_eval_cache->probe (code, side))
+            return *cached_score;
+
+        auto cheap_exits = my_lazy_evaluation_stats.cheap_exits;
+        int score = staticEvaluation (board, side, moves_away, ply, alpha, beta);
+
+        // Checkmate scores depend on how far away the checkmate is, so
+        // they can't be reused from other depths. And a lazy evaluation
+        // that stopped early depended on the window it was given.
+        if (!isCheckmatingOpponentScore (-score) && my_lazy_evaluation_stats.cheap_exits == cheap_exits)
+            my_eval_cache->store (code, side, score);
+
+        return score;
+    }
+
     static void
     logSearchTime (
         const Logger& output, 
-        int nodes, 
+        int64_t nodes, 
         SystemClockTime start, 
         SystemClockTime end
     ) {
         auto seconds_duration = chrono::duration<double> (end - start);
         auto seconds = seconds_duration.count();
-        auto rate = nodes / std::max (0.000000001, seconds);
+        auto rate = static_cast<double> (nodes) / std::max (0.000000001, seconds);
 
         std::stringstream progress_str;
         progress_str << "search took " << seconds << "s, " << rate << " nodes/sec";
@@ -274,13 +882,50 @@ namespace wisdom
         SearchResult best_result {};
 
         my_searching_color = side;
+        my_pawn_table = &threadPawnTable();
 
         try
         {
             my_timer.start();
 
+            if (auto tablebase_result = searchTablebaseRoot (side))
+            {
+                std::ostringstream ostr;
+                ostr << "tablebase move = " << asString (*tablebase_result->move)
+                     << " [ score: " << tablebase_result->score << " ]";
+                my_output->info (std::move (ostr).str());
+                tablebase_result->principal_variation = { *tablebase_result->move };
+                if (my_listener != nullptr)
+                    reportLine (1, 1, tablebase_result->score, tablebase_result->principal_variation);
+                return *tablebase_result;
+            }
+
+            buildRootMoves (side);
+
+            // With a soft limit to aim for, adjust it as the search goes.
+            optional<TimeManager> time_manager;
+            if (auto soft_limit = my_timer.getSoftTimeLimit())
+                time_manager.emplace (TimeBudget { *soft_limit, my_timer.getTimeLimit() });
+
             for (int depth = 1; depth <= my_total_depth; depth++)
             {
+                // Past the soft limit, a new depth would most likely be cut
+                // off before it finished, so stop with what's been found.
+                if (best_result.move.has_value())
+                {
+                    if (my_timer.isSoftLimitReached())
+                    {
+                        my_output->info ("Soft time limit reached");
+                        break;
+                    }
+                    if (time_manager.has_value() && !my_timer.isPondering()
+                        && !time_manager->shouldStartIteration (my_timer.elapsed()))
+                    {
+                        my_output->info ("Next depth wouldn't finish in time");
+                        break;
+                    }
+                }
+
                 std::ostringstream ostr;
                 ostr << "Searching depth " << depth;
                 my_output->info (std::move (ostr).str());
@@ -292,6 +937,11 @@ namespace wisdom
             	// Update, but only do so if we saw opponent's reply
             	// (limited version of quiescence)
                 auto next_result = getBestResult();
+                if (time_manager.has_value() && next_result.move.has_value())
+                {
+                    time_manager->iterationFinished (*next_result.move, next_result.score, my_timer.elapsed());
+                    my_timer.setSoftTimeLimit (time_manager->targetTime());
+                }
                 if (next_result.move.has_value() &&
                 	(!best_result.move.has_value() || depth % 2 == 0))
                 {
@@ -301,6 +951,14 @@ namespace wisdom
                 }
             }
 
+            // A search cut short before the first depth finished still has
+            // to come up with a move, unless it was cancelled.
+            if (!best_result.move.has_value() && my_current_result.timed_out && !my_timer.isCancelled())
+            {
+                if (!my_root_moves.empty())
+                    best_result.move = my_root_moves.front().move;
+            }
+
             return best_result;
         }
         catch (const Error& e)
@@ -319,6 +977,84 @@ namespace wisdom
         return my_current_result;
     }
 
+    void
+    IterativeSearchImpl::updatePrincipalVariation (int ply, Move move)
+    {
+        auto row = narrow<size_t> (ply * my_pv_stride);
+        auto child_row = row + narrow<size_t> (my_pv_stride);
+        auto child_length = my_pv_length[narrow<size_t> (ply + 1)];
+
+        my_pv_table[row] = move;
+        std::copy_n (my_pv_table.begin() + narrow<std::ptrdiff_t> (child_row), child_length,
+                     my_pv_table.begin() + narrow<std::ptrdiff_t> (row + 1));
+        my_pv_length[narrow<size_t> (ply)] = child_length + 1;
+    }
+
+    auto
+    IterativeSearchImpl::rootPrincipalVariation() const
+        -> vector<Move>
+    {
+        return { my_pv_table.begin(), my_pv_table.begin() + my_pv_length[0] };
+    }
+
+    void
+    IterativeSearchImpl::extendPrincipalVariation (
+        Color side,
+        vector<Move>& principal_variation,
+        int depth
+    ) const
+    {
+        if (principal_variation.empty() || narrow<int> (principal_variation.size()) >= depth)
+            return;
+
+        Board board = my_original_board;
+        for (auto move : principal_variation)
+        {
+            board = board.withMove (side, move);
+            side = colorInvert (side);
+        }
+
+        while (narrow<int> (principal_variation.size()) < depth)
+        {
+            auto move = my_transposition_table.getBestMove (board.getCode().getHashCode());
+            if (!move.has_value())
+                break;
+
+            // The entry could be for another position with the same hash.
+            auto legal_moves = generateLegalMoves (board, side);
+            if (std::find (legal_moves.begin(), legal_moves.end(), *move) == legal_moves.end())
+                break;
+
+            principal_variation.push_back (*move);
+            board = board.withMove (side, *move);
+            side = colorInvert (side);
+        }
+    }
+
+    void
+    IterativeSearchImpl::reportLine (
+        int depth,
+        int line,
+        int score,
+        const vector<Move>& principal_variation
+    ) const
+    {
+        auto time = chrono::duration_cast<chrono::milliseconds> (my_timer.elapsed());
+        auto nodes = my_total_nodes_visited;
+
+        my_listener->iterationFinished (SearchStats {
+            .depth = depth,
+            .selective_depth = std::max (my_selective_depth, depth),
+            .multi_pv = line,
+            .score = score,
+            .nodes = nodes,
+            .nodes_per_second = nodes * 1000 / std::max<int64_t> (time.count(), 1),
+            .time = time,
+            .hash_full = my_transposition_table.getHashFull(),
+            .principal_variation = principal_variation,
+        });
+    }
+
     auto 
     IterativeSearchImpl::iterate (Color side, int depth) 
         -> SearchResult
@@ -331,21 +1067,39 @@ namespace wisdom
         my_alpha_beta_cutoffs = 0;
 
         auto tt_stats_start = my_transposition_table.getStats();
+        auto pawn_stats_start = my_pawn_table->getStats();
+        auto eval_stats_start = my_eval_cache != nullptr ? my_eval_cache->getStats() : EvalCacheStats {};
+        auto lazy_stats_start = my_lazy_evaluation_stats;
         auto start = std::chrono::system_clock::now();
 
         my_search_depth = depth;
+        my_selective_depth = 0;
         my_current_result = SearchResult {};
-        search (my_original_board, side, depth, -Initial_Alpha, Initial_Alpha, 0);
+        my_following_pv = true;
+        if (my_network != nullptr)
+            my_network->refresh (my_original_board, my_accumulators[0]);
+        searchRoot (side, depth);
 
         auto end = std::chrono::system_clock::now();
 
         auto result = getBestResult();
+        if (!result.timed_out)
+            my_previous_pv = result.principal_variation;
 
         logSearchTime (*my_output, my_nodes_visited, start, end);
 
         my_total_nodes_visited += my_nodes_visited;
         my_total_alpha_beta_cutoffs += my_alpha_beta_cutoffs;
 
+        if (my_listener != nullptr && !result.timed_out && result.move.has_value())
+        {
+            for (size_t line = 0; line < multiPvLines(); line++)
+            {
+                const auto& root_move = my_root_moves[line];
+                reportLine (depth, narrow<int> (line + 1), root_move.score, root_move.principal_variation);
+            }
+        }
+
         {
             std::stringstream progress_str;
             progress_str << "nodes visited = " << my_nodes_visited
@@ -358,7 +1112,29 @@ namespace wisdom
                 << "/" << my_transposition_table.getSize()
                 << ", probes = " << probes_this_iteration
                 << ", hits = "  << hits_this_iteration
-                << ", hit rate = " << hit_rate << "%";
+                << ", hit rate = " << hit_rate << "%\n";
+
+            auto pawn_stats_end = my_pawn_table->getStats();
+            progress_str << "pawn hash table: probes = " << pawn_stats_end.probes - pawn_stats_start.probes
+                << ", hits = " << pawn_stats_end.hits - pawn_stats_start.hits
+                << ", hit rate = " << computeHitRate (pawn_stats_start, pawn_stats_end) << "%";
+
+            if (my_eval_cache != nullptr)
+            {
+                auto eval_stats_end = my_eval_cache->getStats();
+                progress_str << "\neval cache: probes = " << eval_stats_end.probes - eval_stats_start.probes
+                    << ", hits = " << eval_stats_end.hits - eval_stats_start.hits
+                    << ", hit rate = " << computeHitRate (eval_stats_start, eval_stats_end) << "%";
+            }
+
+            if (my_network == nullptr && my_lazy_evaluation_margin.has_value())
+            {
+                auto lazy_stats_end = my_lazy_evaluation_stats;
+                progress_str << "\nlazy evaluation: cheap exits = "
+                    << lazy_stats_end.cheap_exits - lazy_stats_start.cheap_exits
+                    << ", full evaluations = "
+                    << lazy_stats_end.full_evaluations - lazy_stats_start.full_evaluations;
+            }
 
             my_output->debug (std::move (progress_str).str());
         }
@@ -13,6 +13,10 @@ namespace wisdom
     class Logger;
     class History;
     class TranspositionTable;
+    class EvalCache;
+    class NnueNetwork;
+    class Tablebase;
+    struct LazyEvaluationStats;
 
     struct SearchResult
     {
@@ -20,6 +24,76 @@ namespace wisdom
         int depth { 0 };
         optional<Move> move { nullopt };
         bool timed_out { false };
+
+        // The line of best play the search expects, starting with the move.
+        vector<Move> principal_variation {};
+    };
+
+    // A move at the root, and what the search found out about it.
+    struct RootMove
+    {
+        Move move {};
+
+        // The score at the last depth that searched the move. Only the best
+        // move's score is exact: the others are upper bounds.
+        int score = -Initial_Alpha;
+
+        // Positions searched under the move at the last depth.
+        int64_t nodes = 0;
+
+        // The line the move leads to, from the last time it was the best
+        // of the moves searched with it.
+        vector<Move> principal_variation {};
+    };
+
+    // The progress of a search after it finishes a depth.
+    struct SearchStats
+    {
+        int depth = 0;
+
+        // The furthest ply from the root the search reached.
+        int selective_depth = 0;
+
+        // Which of the best lines this is, counting from one.
+        int multi_pv = 1;
+
+        // From the point of view of the side searching.
+        int score = 0;
+
+        // Over all depths so far.
+        int64_t nodes = 0;
+        int64_t nodes_per_second = 0;
+        chrono::milliseconds time { 0 };
+
+        // How full the transposition table is, in thousandths.
+        int hash_full = 0;
+
+        vector<Move> principal_variation {};
+    };
+
+    // The search starting on a move at the root.
+    struct RootMoveStats
+    {
+        int depth = 0;
+        Move move {};
+
+        // Counting from one, in the order the moves are searched.
+        int move_number = 0;
+
+        chrono::milliseconds time { 0 };
+    };
+
+    // Receives the progress of a search as it runs. The search only
+    // gathers the stats when there is a listener.
+    class SearchListener
+    {
+    public:
+        // Put virtual destructor in the .cpp file to put vtable there:
+        virtual ~SearchListener();
+
+        virtual void iterationFinished (const SearchStats& stats) = 0;
+
+        virtual void rootMoveStarted (const RootMoveStats& stats) = 0;
     };
 
     class IterativeSearch
@@ -35,6 +109,21 @@ namespace wisdom
             TranspositionTable& transposition_table
         ) -> IterativeSearch;
 
+        // Create a search that caches the evaluation of the positions it
+        // reaches in the given cache, and evaluates them with the network if
+        // one is given.
+        [[nodiscard]] static auto
+        create (
+            const Board& board,
+            const History& history,
+            shared_ptr<Logger> logger,
+            const MoveTimer& timer,
+            int max_depth,
+            TranspositionTable& transposition_table,
+            EvalCache& eval_cache,
+            const NnueNetwork* network = nullptr
+        ) -> IterativeSearch;
+
         // Copy and move constructors
         IterativeSearch (const IterativeSearch& other) = delete;
         IterativeSearch& operator= (const IterativeSearch& other) = delete;
@@ -52,6 +141,45 @@ namespace wisdom
         isCancelled()
             -> bool;
 
+        // The number of positions searched, over all depths.
+        [[nodiscard]] auto
+        getNodesVisited() const
+            -> int64_t;
+
+        // Stop evaluating leaves after the cheap terms when they're this far
+        // outside the window, or always evaluate them fully if not set. See
+        // the lazy evaluate().
+        void setLazyEvaluationMargin (optional<int> margin);
+
+        [[nodiscard]] auto
+        getLazyEvaluationStats() const
+            -> LazyEvaluationStats;
+
+        // Look up the endings with few pieces left in the tablebase instead
+        // of searching them. The tablebase has to outlive the search.
+        void setTablebase (const Tablebase* tablebase);
+
+        // Stop once this many nodes have been searched over all depths. The
+        // result depends only on the limit, not on the speed of the machine.
+        void setNodeLimit (optional<int64_t> node_limit);
+
+        // Only consider these moves at the root, or all moves if empty.
+        void setSearchMoves (vector<Move> search_moves);
+
+        // Report the progress of the search to the listener, if not null.
+        void setListener (shared_ptr<SearchListener> listener);
+
+        // Find this many of the best moves at the root, each with its own
+        // score and line, instead of only the best one. Each extra line is
+        // another search of the root without the moves already found.
+        void setMultiPv (int lines);
+
+        // The moves at the root in the order the next depth would search
+        // them: the best moves first, and the others by their node counts.
+        [[nodiscard]] auto
+        getRootMoves() const
+            -> vector<RootMove>;
+
         [[nodiscard]] auto
         moveTimer() const&
             -> const MoveTimer&;
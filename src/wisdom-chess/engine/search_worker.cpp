@@ -0,0 +1,77 @@
+#include "wisdom-chess/engine/search_worker.hpp"
+
+namespace wisdom
+{
+    SearchWorker::SearchWorker()
+        : my_thread { [this] (std::stop_token thread_stop) { run (std::move (thread_stop)); } }
+    {
+    }
+
+    SearchWorker::~SearchWorker()
+    {
+        requestStop();
+        my_thread.request_stop();
+    }
+
+    void
+    SearchWorker::start (Job job)
+    {
+        {
+            std::lock_guard<std::mutex> lock { my_mutex };
+            Expects (!my_busy);
+
+            my_job = std::move (job);
+            my_job_stop = std::stop_source {};
+            my_busy = true;
+        }
+        my_condition.notify_all();
+    }
+
+    void
+    SearchWorker::requestStop()
+    {
+        std::lock_guard<std::mutex> lock { my_mutex };
+        my_job_stop.request_stop();
+    }
+
+    void
+    SearchWorker::wait()
+    {
+        std::unique_lock<std::mutex> lock { my_mutex };
+        my_condition.wait (lock, [this] { return !my_busy; });
+    }
+
+    auto
+    SearchWorker::isBusy() const
+        -> bool
+    {
+        std::lock_guard<std::mutex> lock { my_mutex };
+        return my_busy;
+    }
+
+    void
+    SearchWorker::run (std::stop_token thread_stop)
+    {
+        while (true)
+        {
+            Job job;
+            std::stop_token job_stop;
+            {
+                std::unique_lock<std::mutex> lock { my_mutex };
+                if (!my_condition.wait (lock, thread_stop, [this] { return my_job != nullptr; }))
+                    return;
+
+                job = std::exchange (my_job, nullptr);
+                job_stop = my_job_stop.get_token();
+            }
+
+            job (std::move (job_stop));
+
+            {
+                std::lock_guard<std::mutex> lock { my_mutex };
+                my_busy = false;
+            }
+            my_condition.notify_all();
+        }
+    }
+}
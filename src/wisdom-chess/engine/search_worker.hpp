@@ -0,0 +1,59 @@
+#pragma once
+
+#include <condition_variable>
+#include <mutex>
+#include <stop_token>
+#include <thread>
+
+#include "wisdom-chess/engine/global.hpp"
+
+namespace wisdom
+{
+    // A thread that stays around between searches, parked on a condition
+    // variable until it's given the next one. Starting a search then doesn't
+    // pay for creating a thread, and whatever the thread keeps warm, such as
+    // the search's pawn hash table, carries over to the next search.
+    class SearchWorker
+    {
+    public:
+        using Job = std::function<void (std::stop_token)>;
+
+        SearchWorker();
+
+        // Stop the job that's running, if any, and end the thread.
+        ~SearchWorker();
+
+        SearchWorker (const SearchWorker& other) = delete;
+        SearchWorker& operator= (const SearchWorker& other) = delete;
+
+        SearchWorker (SearchWorker&& other) = delete;
+        SearchWorker& operator= (SearchWorker&& other) = delete;
+
+        // Run the job on the worker's thread. The worker has to be idle. The
+        // job gets a token that requestStop() stops.
+        void start (Job job);
+
+        // Ask the running job to stop. It's up to the job to check its token.
+        void requestStop();
+
+        // Block until the worker has finished its job.
+        void wait();
+
+        [[nodiscard]] auto
+        isBusy() const
+            -> bool;
+
+    private:
+        void run (std::stop_token thread_stop);
+
+        mutable std::mutex my_mutex;
+        std::condition_variable_any my_condition;
+        Job my_job {};
+        std::stop_source my_job_stop {};
+        bool my_busy = false;
+
+        // Declared last, so that it starts after the rest is initialized and
+        // is joined before the rest is destroyed.
+        std::jthread my_thread;
+    };
+}
@@ -0,0 +1,625 @@
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "wisdom-chess/engine/tablebase.hpp"
+#include "wisdom-chess/engine/board.hpp"
+#include "wisdom-chess/engine/material.hpp"
+
+namespace wisdom
+{
+    struct TablebaseFileHeader
+    {
+        char magic[8];
+        uint32_t version;
+        uint32_t reserved0;
+        char name[16];
+        uint64_t entry_count;
+        uint8_t reserved[24];
+    };
+    static_assert (sizeof (TablebaseFileHeader) == 64);
+
+    static constexpr char Tablebase_File_Magic[8] = { 'W', 'I', 'S', 'D', 'O', 'M', 'T', 'B' };
+    static constexpr uint32_t Tablebase_File_Version = 1;
+
+    // The pieces besides the king, strongest first, which is the order they
+    // appear in the names and layouts of the tables.
+    static constexpr array<Piece, 5> Tablebase_Piece_Order = {
+        Piece::Queen, Piece::Rook, Piece::Bishop, Piece::Knight, Piece::Pawn,
+    };
+
+    [[nodiscard]] static constexpr auto
+    tablebasePieceChar (Piece type)
+        -> char
+    {
+        // Unlike pieceToChar(), pawns are upper case like the other pieces.
+        return type == Piece::Pawn ? 'P' : pieceToChar (type);
+    }
+
+    // The squares the white king is kept in, and its index within them.
+    struct KingRegion
+    {
+        array<int8_t, Num_Squares> reduced;
+        array<int8_t, Num_Squares> squares;
+        int size;
+    };
+
+    [[nodiscard]] static consteval auto
+    makeKingRegion (bool with_pawns)
+        -> KingRegion
+    {
+        KingRegion result {};
+        for (int square = 0; square < Num_Squares; square++)
+        {
+            int row = square / Num_Columns;
+            int col = square % Num_Columns;
+
+            // Row 7 is the first rank, so the triangle is a1-d1-d4.
+            bool in_region = with_pawns
+                ? col < Num_Columns / 2
+                : col < Num_Columns / 2 && row >= Num_Rows / 2 && col >= Last_Row - row;
+
+            result.reduced[square] = -1;
+            if (in_region)
+            {
+                result.reduced[square] = narrow_cast<int8_t> (result.size);
+                result.squares[result.size++] = narrow_cast<int8_t> (square);
+            }
+        }
+        return result;
+    }
+
+    static constexpr KingRegion Pawnless_King_Region = makeKingRegion (false);
+    static constexpr KingRegion Pawn_King_Region = makeKingRegion (true);
+    static_assert (Pawnless_King_Region.size == 10);
+    static_assert (Pawn_King_Region.size == 32);
+
+    // The symmetries of the board: bit 0 mirrors the columns, bit 1 mirrors
+    // the rows, and bit 2 swaps the rows and the columns. With pawns, only
+    // mirroring the columns keeps the position the same.
+    [[nodiscard]] static constexpr auto
+    transformSquare (int square, int symmetry)
+        -> int
+    {
+        int row = square / Num_Columns;
+        int col = square % Num_Columns;
+        if (symmetry & 4)
+            std::swap (row, col);
+        if (symmetry & 2)
+            row = Last_Row - row;
+        if (symmetry & 1)
+            col = Last_Column - col;
+        return row * Num_Columns + col;
+    }
+
+    [[nodiscard]] static auto
+    kingRegion (bool with_pawns)
+        -> const KingRegion&
+    {
+        return with_pawns ? Pawn_King_Region : Pawnless_King_Region;
+    }
+
+    // The number of each piece one side has, indexed by piece type.
+    using TablebaseMaterial = array<int, Num_Piece_Types>;
+
+    [[nodiscard]] static auto
+    materialValue (const TablebaseMaterial& material)
+        -> int
+    {
+        int result = 0;
+        for (auto type : Tablebase_Piece_Order)
+            result += material[toInt (type)] * Material::weight (type);
+        return result;
+    }
+
+    // Whether the first side's material belongs on the white side of a
+    // table against the second's: it's worth more, or it's worth the same and
+    // has more of the stronger pieces.
+    [[nodiscard]] static auto
+    isCanonicalOrientation (const TablebaseMaterial& first, const TablebaseMaterial& second)
+        -> bool
+    {
+        auto first_value = materialValue (first);
+        auto second_value = materialValue (second);
+        if (first_value != second_value)
+            return first_value > second_value;
+
+        for (auto type : Tablebase_Piece_Order)
+        {
+            if (first[toInt (type)] != second[toInt (type)])
+                return first[toInt (type)] > second[toInt (type)];
+        }
+        return true;
+    }
+
+    // Three bits for each piece type on each side.
+    [[nodiscard]] static auto
+    materialKey (const TablebaseMaterial& white, const TablebaseMaterial& black)
+        -> uint32_t
+    {
+        uint32_t result = 0;
+        for (auto type : Tablebase_Piece_Order)
+        {
+            result = (result << 3) | narrow_cast<uint32_t> (white[toInt (type)]);
+            result = (result << 3) | narrow_cast<uint32_t> (black[toInt (type)]);
+        }
+        return result;
+    }
+
+    [[nodiscard]] static auto
+    tablebaseName (const TablebaseMaterial& white, const TablebaseMaterial& black)
+        -> string
+    {
+        string result = "K";
+        for (auto type : Tablebase_Piece_Order)
+            result.append (narrow<size_t> (white[toInt (type)]), tablebasePieceChar (type));
+        result += "vK";
+        for (auto type : Tablebase_Piece_Order)
+            result.append (narrow<size_t> (black[toInt (type)]), tablebasePieceChar (type));
+        return result;
+    }
+
+    auto
+    TablebaseLayout::fromName (const string& name)
+        -> optional<TablebaseLayout>
+    {
+        auto separator = name.find ('v');
+        if (separator == string::npos || name.size() < 3 || name[0] != 'K'
+            || separator + 1 >= name.size() || name[separator + 1] != 'K')
+        {
+            return nullopt;
+        }
+
+        array<TablebaseMaterial, Num_Players> material {};
+        int piece_count = 2;
+        for (size_t i = 1; i < name.size(); i++)
+        {
+            if (i == separator || i == separator + 1)
+                continue;
+
+            auto type = Piece::None;
+            for (auto candidate : Tablebase_Piece_Order)
+            {
+                if (tablebasePieceChar (candidate) == name[i])
+                    type = candidate;
+            }
+
+            if (type == Piece::None || ++piece_count > Max_Tablebase_Pieces)
+                return nullopt;
+
+            material[i < separator ? Color_Index_White : Color_Index_Black][toInt (type)]++;
+        }
+
+        if (!isCanonicalOrientation (material[Color_Index_White], material[Color_Index_Black]))
+            return nullopt;
+
+        TablebaseLayout result;
+        result.my_name = tablebaseName (material[Color_Index_White], material[Color_Index_Black]);
+        result.my_pieces[0] = ColoredPiece::make (Color::White, Piece::King);
+        result.my_pieces[1] = ColoredPiece::make (Color::Black, Piece::King);
+        result.my_piece_count = 2;
+
+        for (auto who : { Color::White, Color::Black })
+        {
+            for (auto type : Tablebase_Piece_Order)
+            {
+                for (int i = 0; i < material[colorIndex (who)][toInt (type)]; i++)
+                    result.my_pieces[result.my_piece_count++] = ColoredPiece::make (who, type);
+            }
+        }
+
+        result.my_has_pawns = material[Color_Index_White][toInt (Piece::Pawn)] > 0
+            || material[Color_Index_Black][toInt (Piece::Pawn)] > 0;
+
+        result.my_size = Num_Players * narrow<size_t> (kingRegion (result.my_has_pawns).size);
+        for (int i = 1; i < result.my_piece_count; i++)
+            result.my_size *= Num_Squares;
+
+        return result;
+    }
+
+    auto
+    TablebaseLayout::rawIndex (span<const int> squares, Color to_move) const
+        -> size_t
+    {
+        const auto& region = kingRegion (my_has_pawns);
+
+        auto result = narrow_cast<size_t> (colorIndex (to_move));
+        result = result * region.size + narrow_cast<size_t> (region.reduced[squares[0]]);
+        for (int i = 1; i < my_piece_count; i++)
+            result = result * Num_Squares + narrow_cast<size_t> (squares[i]);
+        return result;
+    }
+
+    auto
+    TablebaseLayout::index (span<const int> squares, Color to_move) const
+        -> size_t
+    {
+        Expects (narrow<int> (squares.size()) == my_piece_count);
+
+        const auto& region = kingRegion (my_has_pawns);
+        int symmetry_count = my_has_pawns ? 2 : 8;
+        auto result = std::numeric_limits<size_t>::max();
+
+        // Every symmetry that puts the white king in its region gives an
+        // index for the position, so use the lowest.
+        for (int symmetry = 0; symmetry < symmetry_count; symmetry++)
+        {
+            if (region.reduced[transformSquare (squares[0], symmetry)] < 0)
+                continue;
+
+            array<int, Max_Tablebase_Pieces> transformed {};
+            for (int i = 0; i < my_piece_count; i++)
+                transformed[i] = transformSquare (squares[i], symmetry);
+
+            // Identical pieces can swap squares without changing the
+            // position, so keep them in order of their squares.
+            for (int i = 3; i < my_piece_count; i++)
+            {
+                for (int j = i; j > 2 && my_pieces[j] == my_pieces[j - 1]
+                                && transformed[j] < transformed[j - 1]; j--)
+                {
+                    std::swap (transformed[j], transformed[j - 1]);
+                }
+            }
+
+            result = std::min (result, rawIndex ({ transformed.data(), squares.size() }, to_move));
+        }
+
+        return result;
+    }
+
+    auto
+    TablebaseLayout::decode (size_t index, span<int> squares) const
+        -> Color
+    {
+        Expects (index < my_size && narrow<int> (squares.size()) == my_piece_count);
+
+        const auto& region = kingRegion (my_has_pawns);
+        for (int i = my_piece_count - 1; i > 0; i--)
+        {
+            squares[i] = narrow_cast<int> (index % Num_Squares);
+            index /= Num_Squares;
+        }
+        squares[0] = region.squares[index % narrow_cast<size_t> (region.size)];
+        index /= narrow_cast<size_t> (region.size);
+
+        return colorFromColorIndex (narrow_cast<ColorIndex> (index));
+    }
+
+    auto
+    tablebaseNames (int max_pieces)
+        -> vector<string>
+    {
+        // Every combination of up to two pieces for one side, which is all a
+        // side can have besides its king in a four piece ending.
+        static_assert (Max_Tablebase_Pieces == 4);
+        vector<TablebaseMaterial> sides;
+        sides.push_back ({});
+        for (size_t first = 0; first < Tablebase_Piece_Order.size(); first++)
+        {
+            TablebaseMaterial one {};
+            one[toInt (Tablebase_Piece_Order[first])]++;
+            sides.push_back (one);
+
+            for (size_t second = first; second < Tablebase_Piece_Order.size(); second++)
+            {
+                auto two = one;
+                two[toInt (Tablebase_Piece_Order[second])]++;
+                sides.push_back (two);
+            }
+        }
+
+        auto count = [] (const TablebaseMaterial& material, optional<Piece> type = nullopt)
+        {
+            int result = 0;
+            for (auto piece : Tablebase_Piece_Order)
+            {
+                if (!type.has_value() || *type == piece)
+                    result += material[toInt (piece)];
+            }
+            return result;
+        };
+
+        struct Entry
+        {
+            int pieces;
+            int pawns;
+            string name;
+        };
+
+        vector<Entry> entries;
+        for (const auto& white : sides)
+        {
+            for (const auto& black : sides)
+            {
+                auto pieces = 2 + count (white) + count (black);
+                if (pieces < 3 || pieces > max_pieces || !isCanonicalOrientation (white, black))
+                    continue;
+
+                // The reversed material is the same ending, so only one
+                // of the two orientations of different material is kept.
+                if (white != black && isCanonicalOrientation (black, white))
+                    continue;
+
+                auto pawns = count (white, Piece::Pawn) + count (black, Piece::Pawn);
+                entries.push_back ({ pieces, pawns, tablebaseName (white, black) });
+            }
+        }
+
+        // Captures lead to endings with fewer pieces, and promotions to
+        // endings with fewer pawns.
+        std::sort (entries.begin(), entries.end(), [] (const Entry& first, const Entry& second) {
+            return std::tie (first.pieces, first.pawns, first.name)
+                < std::tie (second.pieces, second.pawns, second.name);
+        });
+
+        vector<string> result;
+        for (auto& entry : entries)
+            result.push_back (std::move (entry.name));
+        return result;
+    }
+
+    Tablebase::~Tablebase()
+    {
+#ifndef _WIN32
+        for (auto mapping : my_mappings)
+            ::munmap (mapping.address, mapping.size);
+#endif
+    }
+
+    void
+    Tablebase::addValues (const TablebaseLayout& layout, const uint8_t* values)
+    {
+        array<TablebaseMaterial, Num_Players> material {};
+        for (auto piece : layout.pieces())
+            material[colorIndex (pieceColor (piece))][toInt (pieceType (piece))]++;
+
+        auto key = materialKey (material[Color_Index_White], material[Color_Index_Black]);
+        my_tables.insert_or_assign (key, Table { layout, values });
+        my_max_pieces = std::max (my_max_pieces, layout.pieceCount());
+    }
+
+    void
+    Tablebase::addTable (const string& name, vector<uint8_t> values)
+    {
+        auto layout = TablebaseLayout::fromName (name);
+        Expects (layout.has_value() && values.size() == layout->size());
+
+        my_owned_values.push_back (std::move (values));
+        addValues (*layout, my_owned_values.back().data());
+    }
+
+    auto
+    Tablebase::hasTable (const string& name) const
+        -> bool
+    {
+        auto layout = TablebaseLayout::fromName (name);
+        if (!layout.has_value())
+            return false;
+
+        return std::any_of (my_tables.begin(), my_tables.end(), [&layout] (const auto& entry) {
+            return entry.second.layout.name() == layout->name();
+        });
+    }
+
+    auto
+    Tablebase::probe (const Board& board, Color who) const
+        -> optional<TablebaseResult>
+    {
+        // The tables don't know about castling or en passant captures.
+        if (board.getEnPassantTarget().has_value())
+            return nullopt;
+
+        for (auto color : { Color::White, Color::Black })
+        {
+            auto castling = board.getCastlingEligibility (color);
+            if (castling.canCastleKingside() || castling.canCastleQueenside())
+                return nullopt;
+        }
+
+        array<ColoredPiece, Max_Tablebase_Pieces> pieces {};
+        array<int, Max_Tablebase_Pieces> squares {};
+        size_t count = 0;
+
+        auto square_data = board.squareData();
+        for (int index = 0; index < Num_Squares; index++)
+        {
+            if (square_data[index] == Piece_And_Color_None)
+                continue;
+            if (count == Max_Tablebase_Pieces)
+                return nullopt;
+
+            pieces[count] = square_data[index];
+            squares[count] = index;
+            count++;
+        }
+
+        return probe ({ pieces.data(), count }, { squares.data(), count }, who);
+    }
+
+    auto
+    Tablebase::probe (span<const ColoredPiece> pieces, span<const int> squares, Color who) const
+        -> optional<TablebaseResult>
+    {
+        Expects (pieces.size() == squares.size());
+
+        // Nothing but the kings.
+        if (pieces.size() == 2)
+            return TablebaseResult {};
+        if (pieces.size() > Max_Tablebase_Pieces)
+            return nullopt;
+
+        array<TablebaseMaterial, Num_Players> material {};
+        for (auto piece : pieces)
+            material[colorIndex (pieceColor (piece))][toInt (pieceType (piece))]++;
+
+        // The tables have the stronger side as white, so look up black's
+        // material with the board upside down and the colors reversed.
+        bool flip = !isCanonicalOrientation (material[Color_Index_White], material[Color_Index_Black]);
+        if (flip)
+            std::swap (material[Color_Index_White], material[Color_Index_Black]);
+
+        auto table_it = my_tables.find (materialKey (material[Color_Index_White], material[Color_Index_Black]));
+        if (table_it == my_tables.end())
+            return nullopt;
+
+        const auto& table = table_it->second;
+        auto layout_pieces = table.layout.pieces();
+
+        array<int, Max_Tablebase_Pieces> ordered {};
+        array<bool, Max_Tablebase_Pieces> used {};
+        for (size_t slot = 0; slot < layout_pieces.size(); slot++)
+        {
+            for (size_t i = 0; i < pieces.size(); i++)
+            {
+                auto piece = pieces[i];
+                if (flip)
+                    piece = ColoredPiece::make (colorInvert (pieceColor (piece)), pieceType (piece));
+
+                if (!used[i] && piece == layout_pieces[slot])
+                {
+                    used[i] = true;
+                    ordered[slot] = flip ? squares[i] ^ (Last_Row * Num_Columns) : squares[i];
+                    break;
+                }
+            }
+        }
+
+        auto index = table.layout.index ({ ordered.data(), layout_pieces.size() }, flip ? colorInvert (who) : who);
+        return decodeTablebaseResult (table.values[index]);
+    }
+
+    [[nodiscard]] static auto
+    validateHeader (const TablebaseFileHeader& header, uint64_t file_size, const string& path)
+        -> TablebaseLayout
+    {
+        if (std::memcmp (header.magic, Tablebase_File_Magic, sizeof (header.magic)) != 0)
+            throw TablebaseFileError { "Not a tablebase file", path };
+
+        if (header.version != Tablebase_File_Version)
+            throw TablebaseFileError { "Unsupported tablebase file version", path };
+
+        string name { header.name, strnlen (header.name, sizeof (header.name)) };
+        auto layout = TablebaseLayout::fromName (name);
+        if (!layout.has_value() || layout->name() != name)
+            throw TablebaseFileError { "Tablebase file is for an unknown ending", path };
+
+        if (header.entry_count != layout->size() || file_size != sizeof (header) + layout->size())
+            throw TablebaseFileError { "Tablebase file has the wrong size", path };
+
+        return *layout;
+    }
+
+    auto
+    Tablebase::open (const string& directory)
+        -> shared_ptr<Tablebase>
+    {
+        std::error_code error;
+        std::filesystem::directory_iterator entries { directory, error };
+        if (error)
+            throw TablebaseFileError { "Unable to open tablebase directory", directory };
+
+        auto result = make_shared<Tablebase>();
+        result->my_directory = directory;
+
+        for (const auto& entry : entries)
+        {
+            if (!entry.is_regular_file() || entry.path().extension() != Tablebase_File_Extension)
+                continue;
+
+            auto path = entry.path().string();
+
+#ifndef _WIN32
+            int fd = ::open (path.c_str(), O_RDONLY);
+            if (fd < 0)
+                throw TablebaseFileError { "Unable to open tablebase file", path };
+
+            auto close_file = gsl::finally ([fd] { ::close (fd); });
+
+            struct stat file_stat {};
+            if (::fstat (fd, &file_stat) != 0)
+                throw TablebaseFileError { "Unable to open tablebase file", path };
+
+            auto file_size = static_cast<uint64_t> (file_stat.st_size);
+
+            TablebaseFileHeader header {};
+            if (file_size < sizeof (header)
+                || ::pread (fd, &header, sizeof (header), 0) != static_cast<ssize_t> (sizeof (header)))
+            {
+                throw TablebaseFileError { "Not a tablebase file", path };
+            }
+
+            auto layout = validateHeader (header, file_size, path);
+
+            // Probes jump all over the table, so reading ahead only wastes
+            // memory.
+            auto mapped_length = narrow<size_t> (file_size);
+            void* mapping = ::mmap (nullptr, mapped_length, PROT_READ, MAP_SHARED, fd, 0);
+            if (mapping == MAP_FAILED)
+                throw TablebaseFileError { "Unable to map tablebase file", path };
+
+            result->my_mappings.push_back ({ mapping, mapped_length });
+            ::madvise (mapping, mapped_length, MADV_RANDOM);
+
+            auto* values = static_cast<const uint8_t*> (mapping) + sizeof (TablebaseFileHeader);
+            result->addValues (layout, values);
+#else
+            // No mmap() here, so read the tables into memory instead.
+            std::ifstream input { path, std::ios::binary };
+            auto file_size = static_cast<uint64_t> (std::filesystem::file_size (path, error));
+            if (!input || error)
+                throw TablebaseFileError { "Unable to open tablebase file", path };
+
+            TablebaseFileHeader header {};
+            if (file_size < sizeof (header) || !input.read (reinterpret_cast<char*> (&header), sizeof (header)))
+                throw TablebaseFileError { "Not a tablebase file", path };
+
+            auto layout = validateHeader (header, file_size, path);
+
+            vector<uint8_t> values (layout.size());
+            if (!input.read (reinterpret_cast<char*> (values.data()), narrow<std::streamsize> (values.size())))
+                throw TablebaseFileError { "Tablebase file is truncated", path };
+
+            result->my_owned_values.push_back (std::move (values));
+            result->addValues (layout, result->my_owned_values.back().data());
+#endif
+        }
+
+        if (result->tableCount() == 0)
+            throw TablebaseFileError { "No tablebase files found", directory };
+
+        return result;
+    }
+
+    void
+    writeTablebaseFile (const string& path, const string& name, span<const uint8_t> values)
+    {
+        auto layout = TablebaseLayout::fromName (name);
+        Expects (layout.has_value() && values.size() == layout->size());
+
+        TablebaseFileHeader header {};
+        std::memcpy (header.magic, Tablebase_File_Magic, sizeof (header.magic));
+        header.version = Tablebase_File_Version;
+        std::memcpy (header.name, layout->name().data(), std::min (layout->name().size(), sizeof (header.name)));
+        header.entry_count = values.size();
+
+        std::ofstream output { path, std::ios::binary | std::ios::trunc };
+        if (!output)
+            throw TablebaseFileError { "Unable to create tablebase file", path };
+
+        output.write (reinterpret_cast<const char*> (&header), sizeof (header));
+        output.write (reinterpret_cast<const char*> (values.data()), narrow<std::streamsize> (values.size()));
+        output.close();
+
+        if (!output)
+            throw TablebaseFileError { "Unable to write tablebase file", path };
+    }
+}
@@ -0,0 +1,249 @@
+#pragma once
+
+#include "wisdom-chess/engine/global.hpp"
+#include "wisdom-chess/engine/piece.hpp"
+
+namespace wisdom
+{
+    class Board;
+
+    class TablebaseFileError : public Error
+    {
+    public:
+        TablebaseFileError (string message, string path) noexcept
+            : Error { std::move (message), std::move (path) }
+        {
+        }
+    };
+
+    // Tablebases cover the endings with up to this many pieces, counting the
+    // kings.
+    inline constexpr int Max_Tablebase_Pieces = 4;
+
+    inline constexpr string_view Tablebase_File_Extension = ".wtb";
+
+    enum class TablebaseOutcome : int8_t
+    {
+        Draw,
+        Win,
+        Loss,
+    };
+
+    // What a tablebase knows about a position, from the point of view of the
+    // player to move.
+    struct TablebaseResult
+    {
+        TablebaseOutcome outcome = TablebaseOutcome::Draw;
+
+        // Plies until checkmate with the best play from both sides, or zero
+        // for a draw.
+        int plies = 0;
+
+        friend auto operator== (const TablebaseResult&, const TablebaseResult&) -> bool = default;
+    };
+
+    // Each position takes one byte in a table: zero for a draw, the number of
+    // plies for a win, which is always odd, and the number of plies plus two
+    // for a loss, which is always even.
+    inline constexpr int Max_Tablebase_Plies = 253;
+
+    [[nodiscard]] constexpr auto
+    encodeTablebaseResult (TablebaseResult result)
+        -> uint8_t
+    {
+        switch (result.outcome)
+        {
+            case TablebaseOutcome::Win:
+                return narrow_cast<uint8_t> (result.plies);
+            case TablebaseOutcome::Loss:
+                return narrow_cast<uint8_t> (result.plies + 2);
+            default:
+                return 0;
+        }
+    }
+
+    [[nodiscard]] constexpr auto
+    decodeTablebaseResult (uint8_t value)
+        -> TablebaseResult
+    {
+        if (value == 0)
+            return {};
+        if (value % 2 == 1)
+            return { TablebaseOutcome::Win, value };
+        return { TablebaseOutcome::Loss, value - 2 };
+    }
+
+    // How the positions of one ending are laid out in its table.
+    //
+    // The pieces are ordered white king, black king, and then the other white
+    // and black pieces, strongest first. White always has the stronger
+    // material, so black's endings are looked up with the colors reversed.
+    //
+    // The white king is kept in a region of the board that the symmetries of
+    // the ending map every square into: the a1-d1-d4 triangle without pawns,
+    // and the a-d files with them, since pawns only allow mirroring the files.
+    class TablebaseLayout
+    {
+    public:
+        // Parse a name like "KRPvKN". Returns nullopt for anything that
+        // isn't an ending with up to Max_Tablebase_Pieces.
+        [[nodiscard]] static auto
+        fromName (const string& name)
+            -> optional<TablebaseLayout>;
+
+        [[nodiscard]] auto
+        name() const
+            -> const string&
+        {
+            return my_name;
+        }
+
+        [[nodiscard]] auto
+        pieces() const
+            -> span<const ColoredPiece>
+        {
+            return { my_pieces.data(), narrow<size_t> (my_piece_count) };
+        }
+
+        [[nodiscard]] auto
+        pieceCount() const
+            -> int
+        {
+            return my_piece_count;
+        }
+
+        [[nodiscard]] auto
+        hasPawns() const
+            -> bool
+        {
+            return my_has_pawns;
+        }
+
+        // Number of entries in the table, including the ones for illegal
+        // positions and for positions equivalent to another.
+        [[nodiscard]] auto
+        size() const
+            -> size_t
+        {
+            return my_size;
+        }
+
+        // The index of a position, with the pieces on the given squares in
+        // the same order as pieces(). Equivalent positions share an index.
+        [[nodiscard]] auto
+        index (span<const int> squares, Color to_move) const
+            -> size_t;
+
+        // The squares of the pieces at an index, and the player to move.
+        auto
+        decode (size_t index, span<int> squares) const
+            -> Color;
+
+    private:
+        TablebaseLayout() = default;
+
+        [[nodiscard]] auto
+        rawIndex (span<const int> squares, Color to_move) const
+            -> size_t;
+
+        string my_name;
+        array<ColoredPiece, Max_Tablebase_Pieces> my_pieces {};
+        int my_piece_count = 0;
+        bool my_has_pawns = false;
+        size_t my_size = 0;
+    };
+
+    // The names of every ending with up to the given number of pieces, in the
+    // order they have to be generated: captures and promotions only lead to
+    // endings earlier in the list.
+    [[nodiscard]] auto
+    tablebaseNames (int max_pieces)
+        -> vector<string>;
+
+    // Tables with the distance to mate of every position in the endings with
+    // few pieces, built by the tablebase generator tool.
+    //
+    // The table files are mapped into memory read-only where the platform
+    // allows, so several engines using the same files share one copy.
+    class Tablebase
+    {
+    public:
+        Tablebase() = default;
+
+        Tablebase (const Tablebase&) = delete;
+        auto operator= (const Tablebase&) -> Tablebase& = delete;
+
+        ~Tablebase();
+
+        // Open every table in a directory.
+        [[nodiscard]] static auto
+        open (const string& directory)
+            -> shared_ptr<Tablebase>;
+
+        // Add a table that's already in memory, like one that was just
+        // generated.
+        void addTable (const string& name, vector<uint8_t> values);
+
+        [[nodiscard]] auto
+        hasTable (const string& name) const
+            -> bool;
+
+        [[nodiscard]] auto
+        tableCount() const
+            -> int
+        {
+            return narrow<int> (my_tables.size());
+        }
+
+        // The most pieces of any ending in the tablebase.
+        [[nodiscard]] auto
+        maxPieces() const
+            -> int
+        {
+            return my_max_pieces;
+        }
+
+        // Look up a position. Returns nullopt if the ending isn't in the
+        // tablebase, or if castling or an en passant capture is possible.
+        [[nodiscard]] auto
+        probe (const Board& board, Color who) const
+            -> optional<TablebaseResult>;
+
+        // Look up the position with the pieces on the given squares.
+        [[nodiscard]] auto
+        probe (span<const ColoredPiece> pieces, span<const int> squares, Color who) const
+            -> optional<TablebaseResult>;
+
+        [[nodiscard]] auto
+        getDirectory() const
+            -> const string&
+        {
+            return my_directory;
+        }
+
+    private:
+        struct Table
+        {
+            TablebaseLayout layout;
+            const uint8_t* values;
+        };
+
+        struct Mapping
+        {
+            void* address;
+            size_t size;
+        };
+
+        void addValues (const TablebaseLayout& layout, const uint8_t* values);
+
+        std::unordered_map<uint32_t, Table> my_tables;
+        vector<vector<uint8_t>> my_owned_values;
+        vector<Mapping> my_mappings;
+        string my_directory;
+        int my_max_pieces = 0;
+    };
+
+    // Write a table in the format Tablebase::open() reads.
+    void
+    writeTablebaseFile (const string& path, const string& name, span<const uint8_t> values);
+}
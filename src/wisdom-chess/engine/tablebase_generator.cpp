@@ -0,0 +1,665 @@
+#include <atomic>
+#include <exception>
+#include <thread>
+
+#include "wisdom-chess/engine/tablebase_generator.hpp"
+#include "wisdom-chess/engine/board.hpp"
+
+namespace wisdom
+{
+    // The square of a piece that's been captured.
+    static constexpr int Off_Board = -1;
+
+    // A position in an ending, with the pieces in the order of the table's
+    // layout. Captures take pieces off the board, and promotions change their
+    // type, which both lead to other tables.
+    struct TablebasePosition
+    {
+        array<ColoredPiece, Max_Tablebase_Pieces> pieces {};
+        array<int, Max_Tablebase_Pieces> squares {};
+        int count = 0;
+        Color to_move = Color::White;
+    };
+
+    enum class TablebaseEntryState : uint8_t
+    {
+        // Illegal, or equivalent to a position with a lower index.
+        Invalid,
+        Unresolved,
+        Resolved,
+    };
+
+    // Positions waiting to be resolved, by distance to mate.
+    using TablebaseBuckets = array<vector<uint32_t>, Max_Tablebase_Plies + 1>;
+
+    static constexpr array<pair<int, int>, 8> King_Offsets = { {
+        { -1, -1 }, { -1, 0 }, { -1, 1 }, { 0, -1 },
+        { 0, 1 }, { 1, -1 }, { 1, 0 }, { 1, 1 },
+    } };
+
+    static constexpr array<pair<int, int>, 8> Knight_Offsets = { {
+        { -2, -1 }, { -2, 1 }, { -1, -2 }, { -1, 2 },
+        { 1, -2 }, { 1, 2 }, { 2, -1 }, { 2, 1 },
+    } };
+
+    // Rook directions first, then bishop directions.
+    static constexpr array<pair<int, int>, 8> Slide_Directions = { {
+        { -1, 0 }, { 1, 0 }, { 0, -1 }, { 0, 1 },
+        { -1, -1 }, { -1, 1 }, { 1, -1 }, { 1, 1 },
+    } };
+
+    [[nodiscard]] static auto
+    slideDirections (Piece type)
+        -> span<const pair<int, int>>
+    {
+        switch (type)
+        {
+            case Piece::Rook:
+                return { Slide_Directions.data(), 4 };
+            case Piece::Bishop:
+                return { Slide_Directions.data() + 4, 4 };
+            case Piece::Queen:
+                return { Slide_Directions.data(), 8 };
+            default:
+                return {};
+        }
+    }
+
+    [[nodiscard]] static auto
+    pieceOn (const TablebasePosition& position, int square)
+        -> int
+    {
+        for (int i = 0; i < position.count; i++)
+        {
+            if (position.squares[i] == square)
+                return i;
+        }
+        return -1;
+    }
+
+    [[nodiscard]] static auto
+    isPathClear (const TablebasePosition& position, int from, int to)
+        -> bool
+    {
+        int row_step = (to / Num_Columns > from / Num_Columns) - (to / Num_Columns < from / Num_Columns);
+        int col_step = (to % Num_Columns > from % Num_Columns) - (to % Num_Columns < from % Num_Columns);
+        int step = row_step * Num_Columns + col_step;
+
+        for (int square = from + step; square != to; square += step)
+        {
+            if (pieceOn (position, square) >= 0)
+                return false;
+        }
+        return true;
+    }
+
+    [[nodiscard]] static auto
+    isSquareAttacked (const TablebasePosition& position, int target, Color attacker)
+        -> bool
+    {
+        for (int i = 0; i < position.count; i++)
+        {
+            auto from = position.squares[i];
+            if (from == Off_Board || pieceColor (position.pieces[i]) != attacker)
+                continue;
+
+            int row_diff = target / Num_Columns - from / Num_Columns;
+            int col_diff = target % Num_Columns - from % Num_Columns;
+            int abs_row = std::abs (row_diff);
+            int abs_col = std::abs (col_diff);
+
+            bool straight = (row_diff == 0) != (col_diff == 0);
+            bool diagonal = abs_row == abs_col && abs_row != 0;
+
+            switch (pieceType (position.pieces[i]))
+            {
+                case Piece::Pawn:
+                    if (row_diff == pawnDirection<int> (attacker) && abs_col == 1)
+                        return true;
+                    break;
+                case Piece::Knight:
+                    if ((abs_row == 1 && abs_col == 2) || (abs_row == 2 && abs_col == 1))
+                        return true;
+                    break;
+                case Piece::King:
+                    if (std::max (abs_row, abs_col) == 1)
+                        return true;
+                    break;
+                case Piece::Bishop:
+                    if (diagonal && isPathClear (position, from, target))
+                        return true;
+                    break;
+                case Piece::Rook:
+                    if (straight && isPathClear (position, from, target))
+                        return true;
+                    break;
+                case Piece::Queen:
+                    if ((straight || diagonal) && isPathClear (position, from, target))
+                        return true;
+                    break;
+                default:
+                    break;
+            }
+        }
+        return false;
+    }
+
+    [[nodiscard]] static auto
+    isInCheck (const TablebasePosition& position, Color who)
+        -> bool
+    {
+        auto king = ColoredPiece::make (who, Piece::King);
+        for (int i = 0; i < position.count; i++)
+        {
+            if (position.pieces[i] == king)
+                return isSquareAttacked (position, position.squares[i], colorInvert (who));
+        }
+        return false;
+    }
+
+    // Whether a decoded position could come up in a game: no two pieces on
+    // the same square, no pawns on the first or last rows, and the player
+    // who just moved isn't left in check.
+    [[nodiscard]] static auto
+    isLegalPosition (const TablebasePosition& position)
+        -> bool
+    {
+        for (int i = 0; i < position.count; i++)
+        {
+            auto row = position.squares[i] / Num_Columns;
+            if (pieceType (position.pieces[i]) == Piece::Pawn && (row == First_Row || row == Last_Row))
+                return false;
+
+            for (int j = i + 1; j < position.count; j++)
+            {
+                if (position.squares[i] == position.squares[j])
+                    return false;
+            }
+        }
+
+        return !isInCheck (position, colorInvert (position.to_move));
+    }
+
+    // Call the function with the position after each legal move, and whether
+    // the move was a capture or promotion.
+    template <typename Function>
+    static void
+    forEachMove (const TablebasePosition& position, Function&& function)
+    {
+        auto who = position.to_move;
+
+        auto addMove = [&] (int piece_index, int target, Piece promotion)
+        {
+            TablebasePosition child = position;
+            bool conversion = promotion != Piece::None;
+
+            auto captured = pieceOn (position, target);
+            if (captured >= 0)
+            {
+                child.squares[captured] = Off_Board;
+                conversion = true;
+            }
+
+            child.squares[piece_index] = target;
+            if (promotion != Piece::None)
+                child.pieces[piece_index] = ColoredPiece::make (who, promotion);
+            child.to_move = colorInvert (who);
+
+            if (!isInCheck (child, who))
+                function (child, conversion);
+        };
+
+        // Empty squares and enemy pieces besides the king can be moved to.
+        auto canMoveTo = [&] (int target)
+        {
+            auto occupant = pieceOn (position, target);
+            return occupant < 0
+                || (pieceColor (position.pieces[occupant]) != who
+                    && pieceType (position.pieces[occupant]) != Piece::King);
+        };
+
+        for (int i = 0; i < position.count; i++)
+        {
+            auto from = position.squares[i];
+            if (from == Off_Board || pieceColor (position.pieces[i]) != who)
+                continue;
+
+            int row = from / Num_Columns;
+            int col = from % Num_Columns;
+            auto type = pieceType (position.pieces[i]);
+
+            if (type == Piece::King || type == Piece::Knight)
+            {
+                for (auto [row_offset, col_offset] : type == Piece::King ? King_Offsets : Knight_Offsets)
+                {
+                    if (!isValidRow (row + row_offset) || !isValidColumn (col + col_offset))
+                        continue;
+
+                    auto target = (row + row_offset) * Num_Columns + col + col_offset;
+                    if (canMoveTo (target))
+                        addMove (i, target, Piece::None);
+                }
+            }
+            else if (type == Piece::Pawn)
+            {
+                auto direction = pawnDirection<int> (who);
+                auto next_row = row + direction;
+                bool promotes = next_row == First_Row || next_row == Last_Row;
+
+                auto addPawnMove = [&] (int target)
+                {
+                    if (!promotes)
+                    {
+                        addMove (i, target, Piece::None);
+                        return;
+                    }
+                    for (auto promotion : { Piece::Queen, Piece::Rook, Piece::Bishop, Piece::Knight })
+                        addMove (i, target, promotion);
+                };
+
+                auto forward = next_row * Num_Columns + col;
+                if (pieceOn (position, forward) < 0)
+                {
+                    addPawnMove (forward);
+
+                    auto start_row = who == Color::White ? Last_Row - 1 : First_Row + 1;
+                    auto double_forward = forward + direction * Num_Columns;
+                    if (row == start_row && pieceOn (position, double_forward) < 0)
+                        addMove (i, double_forward, Piece::None);
+                }
+
+                for (auto col_offset : { -1, 1 })
+                {
+                    if (!isValidColumn (col + col_offset))
+                        continue;
+
+                    auto target = forward + col_offset;
+                    if (pieceOn (position, target) >= 0 && canMoveTo (target))
+                        addPawnMove (target);
+                }
+            }
+            else
+            {
+                for (auto [row_step, col_step] : slideDirections (type))
+                {
+                    for (int target_row = row + row_step, target_col = col + col_step;
+                         isValidRow (target_row) && isValidColumn (target_col);
+                         target_row += row_step, target_col += col_step)
+                    {
+                        auto target = target_row * Num_Columns + target_col;
+                        if (canMoveTo (target))
+                            addMove (i, target, Piece::None);
+                        if (pieceOn (position, target) >= 0)
+                            break;
+                    }
+                }
+            }
+        }
+    }
+
+    // Call the function with each position that could have come before this
+    // one, by a move that wasn't a capture or promotion.
+    template <typename Function>
+    static void
+    forEachUnmove (const TablebasePosition& position, Function&& function)
+    {
+        auto who = colorInvert (position.to_move);
+
+        auto addUnmove = [&] (int piece_index, int origin)
+        {
+            TablebasePosition parent = position;
+            parent.squares[piece_index] = origin;
+            parent.to_move = who;
+
+            if (!isInCheck (parent, position.to_move))
+                function (parent);
+        };
+
+        for (int i = 0; i < position.count; i++)
+        {
+            auto to = position.squares[i];
+            if (to == Off_Board || pieceColor (position.pieces[i]) != who)
+                continue;
+
+            int row = to / Num_Columns;
+            int col = to % Num_Columns;
+            auto type = pieceType (position.pieces[i]);
+
+            if (type == Piece::King || type == Piece::Knight)
+            {
+                for (auto [row_offset, col_offset] : type == Piece::King ? King_Offsets : Knight_Offsets)
+                {
+                    if (!isValidRow (row + row_offset) || !isValidColumn (col + col_offset))
+                        continue;
+
+                    auto origin = (row + row_offset) * Num_Columns + col + col_offset;
+                    if (pieceOn (position, origin) < 0)
+                        addUnmove (i, origin);
+                }
+            }
+            else if (type == Piece::Pawn)
+            {
+                auto direction = pawnDirection<int> (who);
+                auto origin_row = row - direction;
+                auto home_row = who == Color::White ? Last_Row : First_Row;
+                if (origin_row == home_row)
+                    continue;
+
+                auto origin = origin_row * Num_Columns + col;
+                if (pieceOn (position, origin) >= 0)
+                    continue;
+
+                addUnmove (i, origin);
+
+                auto start_row = who == Color::White ? Last_Row - 1 : First_Row + 1;
+                auto double_origin = origin - direction * Num_Columns;
+                if (origin_row - direction == start_row && pieceOn (position, double_origin) < 0)
+                    addUnmove (i, double_origin);
+            }
+            else
+            {
+                for (auto [row_step, col_step] : slideDirections (type))
+                {
+                    for (int origin_row = row + row_step, origin_col = col + col_step;
+                         isValidRow (origin_row) && isValidColumn (origin_col);
+                         origin_row += row_step, origin_col += col_step)
+                    {
+                        auto origin = origin_row * Num_Columns + origin_col;
+                        if (pieceOn (position, origin) >= 0)
+                            break;
+                        addUnmove (i, origin);
+                    }
+                }
+            }
+        }
+    }
+
+    [[nodiscard]] static auto
+    decodePosition (const TablebaseLayout& layout, size_t index)
+        -> TablebasePosition
+    {
+        TablebasePosition result;
+        result.count = layout.pieceCount();
+        std::copy (layout.pieces().begin(), layout.pieces().end(), result.pieces.begin());
+        result.to_move = layout.decode (index, { result.squares.data(), layout.pieces().size() });
+        return result;
+    }
+
+    [[nodiscard]] static auto
+    positionIndex (const TablebaseLayout& layout, const TablebasePosition& position)
+        -> uint32_t
+    {
+        return narrow_cast<uint32_t> (
+            layout.index ({ position.squares.data(), layout.pieces().size() }, position.to_move)
+        );
+    }
+
+    // Split the range into one chunk for each thread.
+    template <typename Function>
+    static void
+    parallelFor (size_t count, int thread_count, Function&& function)
+    {
+        if (thread_count <= 1 || count < 1024)
+        {
+            function (0, count, 0);
+            return;
+        }
+
+        vector<std::thread> threads;
+        vector<std::exception_ptr> errors (narrow<size_t> (thread_count));
+        threads.reserve (narrow<size_t> (thread_count));
+
+        auto chunk_size = (count + narrow<size_t> (thread_count) - 1) / narrow<size_t> (thread_count);
+        for (int thread_index = 0; thread_index < thread_count; thread_index++)
+        {
+            auto start = narrow<size_t> (thread_index) * chunk_size;
+            auto end = std::min (start + chunk_size, count);
+            threads.emplace_back ([&function, &errors, start, end, thread_index]
+            {
+                try
+                {
+                    function (start, end, thread_index);
+                }
+                catch (...)
+                {
+                    errors[narrow<size_t> (thread_index)] = std::current_exception();
+                }
+            });
+        }
+
+        for (auto& thread : threads)
+            thread.join();
+
+        for (const auto& error : errors)
+        {
+            if (error)
+                std::rethrow_exception (error);
+        }
+    }
+
+    static void
+    pushToBucket (TablebaseBuckets& buckets, uint32_t index, int plies, const string& name)
+    {
+        if (plies > Max_Tablebase_Plies)
+            throw Error { "Distance to mate is too long for the tablebase format", name };
+
+        buckets[narrow<size_t> (plies)].push_back (index);
+    }
+
+    static void
+    mergeBuckets (TablebaseBuckets& target, vector<TablebaseBuckets>& sources, int first_plies)
+    {
+        for (auto& source : sources)
+        {
+            for (auto plies = narrow<size_t> (first_plies); plies < source.size(); plies++)
+            {
+                target[plies].insert (target[plies].end(), source[plies].begin(), source[plies].end());
+                source[plies].clear();
+            }
+        }
+    }
+
+    auto
+    generateTablebase (const string& name, const Tablebase& converted_endings, int thread_count)
+        -> TablebaseGenerationResult
+    {
+        auto layout = TablebaseLayout::fromName (name);
+        if (!layout.has_value())
+            throw Error { "Invalid tablebase name", name };
+
+        Expects (layout->size() <= std::numeric_limits<uint32_t>::max());
+        thread_count = std::max (thread_count, 1);
+
+        auto size = layout->size();
+        TablebaseGenerationResult result;
+        result.values.resize (size);
+
+        vector<TablebaseEntryState> states (size, TablebaseEntryState::Invalid);
+
+        // Moves that don't lose yet, and the shortest loss any of the other
+        // moves lead to. A position is lost once it runs out of escapes.
+        vector<uint8_t> escapes (size);
+        vector<uint8_t> loss_floors (size);
+
+        TablebaseBuckets buckets;
+        vector<TablebaseBuckets> thread_buckets (narrow<size_t> (thread_count));
+
+        // Find the legal positions and their moves. Mates and the results of
+        // captures and promotions are known right away.
+        parallelFor (size, thread_count, [&] (size_t start, size_t end, int thread_index)
+        {
+            auto& local_buckets = thread_buckets[narrow<size_t> (thread_index)];
+            vector<uint32_t> children;
+
+            for (auto index = start; index < end; index++)
+            {
+                auto position = decodePosition (*layout, index);
+                if (!isLegalPosition (position) || positionIndex (*layout, position) != index)
+                    continue;
+
+                int legal_moves = 0;
+                int escape_count = 0;
+                int loss_floor = 0;
+                optional<int> fastest_win;
+                children.clear();
+
+                forEachMove (position, [&] (const TablebasePosition& child, bool conversion)
+                {
+                    legal_moves++;
+                    if (!conversion)
+                    {
+                        children.push_back (positionIndex (*layout, child));
+                        return;
+                    }
+
+                    array<ColoredPiece, Max_Tablebase_Pieces> pieces {};
+                    array<int, Max_Tablebase_Pieces> squares {};
+                    size_t count = 0;
+                    for (int i = 0; i < child.count; i++)
+                    {
+                        if (child.squares[i] == Off_Board)
+                            continue;
+                        pieces[count] = child.pieces[i];
+                        squares[count++] = child.squares[i];
+                    }
+
+                    auto child_result = converted_endings.probe (
+                        { pieces.data(), count }, { squares.data(), count }, child.to_move
+                    );
+                    if (!child_result.has_value())
+                        throw Error { "Missing the tablebase for a capture or promotion", name };
+
+                    switch (child_result->outcome)
+                    {
+                        case TablebaseOutcome::Loss:
+                            fastest_win = std::min (fastest_win.value_or (child_result->plies + 1),
+                                                    child_result->plies + 1);
+                            escape_count++;
+                            break;
+                        case TablebaseOutcome::Draw:
+                            escape_count++;
+                            break;
+                        case TablebaseOutcome::Win:
+                            loss_floor = std::max (loss_floor, child_result->plies + 1);
+                            break;
+                    }
+                });
+
+                std::sort (children.begin(), children.end());
+                children.erase (std::unique (children.begin(), children.end()), children.end());
+                escape_count += narrow<int> (children.size());
+
+                auto position_index = narrow_cast<uint32_t> (index);
+                if (legal_moves == 0 && !isInCheck (position, position.to_move))
+                {
+                    // Stalemate.
+                    states[index] = TablebaseEntryState::Resolved;
+                    continue;
+                }
+
+                states[index] = TablebaseEntryState::Unresolved;
+                escapes[index] = narrow<uint8_t> (escape_count);
+                loss_floors[index] = narrow<uint8_t> (loss_floor);
+
+                if (fastest_win.has_value())
+                    pushToBucket (local_buckets, position_index, *fastest_win, name);
+                else if (escape_count == 0)
+                    pushToBucket (local_buckets, position_index, loss_floor, name);
+            }
+        });
+
+        mergeBuckets (buckets, thread_buckets, 0);
+
+        // Resolve the positions in order of their distance to mate. A loss
+        // makes each position before it a win one ply further away, and a
+        // win takes away one of the escapes of the positions before it.
+        for (int plies = 0; plies <= Max_Tablebase_Plies; plies++)
+        {
+            auto& candidates = buckets[narrow<size_t> (plies)];
+            bool is_win = plies % 2 == 1;
+
+            parallelFor (candidates.size(), thread_count, [&] (size_t start, size_t end, int thread_index)
+            {
+                auto& local_buckets = thread_buckets[narrow<size_t> (thread_index)];
+                vector<uint32_t> parents;
+
+                for (auto i = start; i < end; i++)
+                {
+                    auto index = candidates[i];
+                    auto expected = TablebaseEntryState::Unresolved;
+                    if (!std::atomic_ref { states[index] }.compare_exchange_strong (
+                            expected, TablebaseEntryState::Resolved))
+                    {
+                        continue;
+                    }
+
+                    result.values[index] = encodeTablebaseResult (
+                        { is_win ? TablebaseOutcome::Win : TablebaseOutcome::Loss, plies }
+                    );
+
+                    parents.clear();
+                    forEachUnmove (decodePosition (*layout, index), [&] (const TablebasePosition& parent)
+                    {
+                        parents.push_back (positionIndex (*layout, parent));
+                    });
+
+                    std::sort (parents.begin(), parents.end());
+                    parents.erase (std::unique (parents.begin(), parents.end()), parents.end());
+
+                    for (auto parent : parents)
+                    {
+                        if (std::atomic_ref { states[parent] }.load (std::memory_order_relaxed)
+                            != TablebaseEntryState::Unresolved)
+                        {
+                            continue;
+                        }
+
+                        if (!is_win)
+                        {
+                            pushToBucket (local_buckets, parent, plies + 1, name);
+                            continue;
+                        }
+
+                        std::atomic_ref loss_floor { loss_floors[parent] };
+                        auto floor = loss_floor.load();
+                        while (floor < plies + 1 && !loss_floor.compare_exchange_weak (
+                                   floor, narrow_cast<uint8_t> (plies + 1)))
+                        {
+                        }
+
+                        if (std::atomic_ref { escapes[parent] }.fetch_sub (1) == 1)
+                            pushToBucket (local_buckets, parent, std::max<int> (loss_floor.load(), plies + 1), name);
+                    }
+                }
+            });
+
+            candidates.clear();
+            candidates.shrink_to_fit();
+            mergeBuckets (buckets, thread_buckets, plies + 1);
+        }
+
+        for (size_t index = 0; index < size; index++)
+        {
+            if (states[index] == TablebaseEntryState::Invalid)
+                continue;
+
+            result.positions++;
+            auto value = decodeTablebaseResult (result.values[index]);
+            switch (value.outcome)
+            {
+                case TablebaseOutcome::Win:
+                    result.wins++;
+                    break;
+                case TablebaseOutcome::Loss:
+                    result.losses++;
+                    break;
+                case TablebaseOutcome::Draw:
+                    result.draws++;
+                    break;
+            }
+            result.longest_mate = std::max (result.longest_mate, value.plies);
+        }
+
+        return result;
+    }
+}
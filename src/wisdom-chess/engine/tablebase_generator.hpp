@@ -0,0 +1,32 @@
+#pragma once
+
+#include "wisdom-chess/engine/global.hpp"
+#include "wisdom-chess/engine/tablebase.hpp"
+
+namespace wisdom
+{
+    struct TablebaseGenerationResult
+    {
+        vector<uint8_t> values;
+
+        // Legal positions in the ending, counting equivalent positions once.
+        size_t positions = 0;
+        size_t wins = 0;
+        size_t losses = 0;
+        size_t draws = 0;
+
+        // The longest distance to mate in plies.
+        int longest_mate = 0;
+    };
+
+    // Work out the distance to mate of every position in an ending by
+    // retrograde analysis: starting from the checkmates, each round finds the
+    // positions one ply further from mate by unmaking moves.
+    //
+    // Captures and promotions are looked up in the tables of the endings they
+    // lead to, which must already be in the tablebase. Castling and en
+    // passant captures are left out.
+    [[nodiscard]] auto
+    generateTablebase (const string& name, const Tablebase& converted_endings, int thread_count)
+        -> TablebaseGenerationResult;
+}
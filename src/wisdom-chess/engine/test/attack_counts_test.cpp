@@ -0,0 +1,95 @@
+#include "wisdom-chess/engine/attack_counts.hpp"
+#include "wisdom-chess/engine/board.hpp"
+#include "wisdom-chess/engine/board_builder.hpp"
+#include "wisdom-chess/engine/fen_parser.hpp"
+
+#include "wisdom-chess-tests.hpp"
+
+using namespace wisdom;
+
+TEST_CASE( "Attack counts at the starting position" )
+{
+    Board board;
+    auto counts = countAttacks (board);
+
+    for (auto who : { Color::White, Color::Black })
+    {
+        auto index = colorIndex (who);
+
+        // Only the knights can move, each to two squares.
+        CHECK( counts.mobility[index][toInt (Piece::Knight)] == 4 );
+        CHECK( counts.mobility[index][toInt (Piece::Bishop)] == 0 );
+        CHECK( counts.mobility[index][toInt (Piece::Rook)] == 0 );
+        CHECK( counts.mobility[index][toInt (Piece::Queen)] == 0 );
+        CHECK( counts.pieces[index][toInt (Piece::Knight)] == 2 );
+        CHECK( counts.king_attackers[index] == 0 );
+    }
+
+    CHECK( counts.overallScore (Color::White, Max_Game_Phase) == 0 );
+}
+
+TEST_CASE( "Knight mobility depends on where the knight is" )
+{
+    auto knightMobility = [] (const char* square)
+    {
+        BoardBuilder builder;
+        builder.addPiece ("e1", Color::White, Piece::King);
+        builder.addPiece ("e8", Color::Black, Piece::King);
+        builder.addPiece (square, Color::White, Piece::Knight);
+
+        auto counts = countAttacks (Board { builder });
+        return counts.mobility[Color_Index_White][toInt (Piece::Knight)];
+    };
+
+    CHECK( knightMobility ("a1") == 2 );
+    CHECK( knightMobility ("d4") == 8 );
+}
+
+TEST_CASE( "Mobility excludes squares attacked by enemy pawns" )
+{
+    BoardBuilder builder;
+    builder.addPiece ("a1", Color::White, Piece::King);
+    builder.addPiece ("h8", Color::Black, Piece::King);
+    builder.addPiece ("d4", Color::White, Piece::Knight);
+    builder.addPiece ("d7", Color::Black, Piece::Pawn);
+
+    auto counts = countAttacks (Board { builder });
+
+    // The pawn on d7 covers c6 and e6.
+    CHECK( counts.mobility[Color_Index_White][toInt (Piece::Knight)] == 6 );
+}
+
+TEST_CASE( "Sliding pieces stop at the first piece in the way" )
+{
+    BoardBuilder builder;
+    builder.addPiece ("h1", Color::White, Piece::King);
+    builder.addPiece ("h8", Color::Black, Piece::King);
+    builder.addPiece ("a1", Color::White, Piece::Rook);
+    builder.addPiece ("a4", Color::White, Piece::Pawn);
+    builder.addPiece ("d1", Color::Black, Piece::Knight);
+
+    auto counts = countAttacks (Board { builder });
+
+    // a2, a3, b1, c1 and the capture on d1.
+    CHECK( counts.mobility[Color_Index_White][toInt (Piece::Rook)] == 5 );
+}
+
+TEST_CASE( "Attacks on the squares around the king" )
+{
+    FenParser parser { "6k1/5ppp/8/8/8/8/R2Q4/6K1 w - - 0 1" };
+    auto board = parser.buildBoard();
+    auto safe_counts = countAttacks (board);
+
+    CHECK( safe_counts.king_attackers[Color_Index_Black] == 0 );
+
+    FenParser attack_parser { "6k1/5ppp/8/6Q1/8/8/5R2/6K1 w - - 0 1" };
+    auto attacked_board = attack_parser.buildBoard();
+    auto attacked_counts = countAttacks (attacked_board);
+
+    CHECK( attacked_counts.king_attackers[Color_Index_Black] == 2 );
+    CHECK( attacked_counts.king_attack_weight[Color_Index_Black] > 0 );
+    CHECK( attacked_counts.king_attackers[Color_Index_White] == 0 );
+
+    // Two attackers count against the defending king.
+    CHECK( attacked_counts.overallScore (Color::Black, Max_Game_Phase) < 0 );
+}
@@ -0,0 +1,123 @@
+#include "wisdom-chess/engine/endgame.hpp"
+#include "wisdom-chess/engine/board.hpp"
+#include "wisdom-chess/engine/evaluate.hpp"
+#include "wisdom-chess/engine/fen_parser.hpp"
+
+#include "wisdom-chess-tests.hpp"
+
+using namespace wisdom;
+
+namespace
+{
+    auto kingPawnVsKingIsWin (const char* fen)
+        -> bool
+    {
+        FenParser parser { fen };
+        auto board = parser.buildBoard();
+        auto strong_side = board.getMaterial().info().strong_side;
+        auto pawn = ColoredPiece::make (strong_side, Piece::Pawn);
+
+        for (auto coord : Board::allCoords())
+        {
+            if (board.pieceAt (coord) == pawn)
+            {
+                return isKingPawnVsKingWin (
+                    board.getKingPosition (strong_side),
+                    coord,
+                    board.getKingPosition (colorInvert (strong_side)),
+                    strong_side,
+                    parser.getActivePlayer()
+                );
+            }
+        }
+
+        FAIL( "No pawn on the board" );
+        return false;
+    }
+}
+
+TEST_CASE( "King and pawn against king bitbase" )
+{
+    SUBCASE( "King on the sixth row in front of the pawn wins with either side to move" )
+    {
+        CHECK( kingPawnVsKingIsWin ("4k3/8/4K3/4P3/8/8/8/8 w - - 0 1") );
+        CHECK( kingPawnVsKingIsWin ("4k3/8/4K3/4P3/8/8/8/8 b - - 0 1") );
+    }
+
+    SUBCASE( "Rook pawn with the lone king in the corner is a draw" )
+    {
+        CHECK( !kingPawnVsKingIsWin ("7k/8/8/6KP/8/8/8/8 w - - 0 1") );
+        CHECK( !kingPawnVsKingIsWin ("7k/8/8/6KP/8/8/8/8 b - - 0 1") );
+    }
+
+    SUBCASE( "A pawn that can be captured is a draw" )
+    {
+        CHECK( !kingPawnVsKingIsWin ("8/8/8/3kP3/8/8/8/K7 b - - 0 1") );
+    }
+
+    SUBCASE( "A pawn the lone king can't catch wins" )
+    {
+        CHECK( kingPawnVsKingIsWin ("8/8/8/P7/8/8/8/K6k w - - 0 1") );
+        CHECK( kingPawnVsKingIsWin ("8/8/8/P7/8/8/8/K6k b - - 0 1") );
+    }
+
+    SUBCASE( "Gives the same results for black and for the other side of the board" )
+    {
+        CHECK( kingPawnVsKingIsWin ("8/8/8/8/4p3/4k3/8/4K3 b - - 0 1") );
+        CHECK( kingPawnVsKingIsWin ("3k4/8/3K4/3P4/8/8/8/8 b - - 0 1") );
+        CHECK( !kingPawnVsKingIsWin ("8/8/8/8/pk6/8/8/K7 b - - 0 1") );
+    }
+}
+
+TEST_CASE( "Specialized endgame evaluation" )
+{
+    SUBCASE( "Is only used for endings with an evaluator" )
+    {
+        Board board;
+        CHECK( !evaluateEndgame (board, Color::White).has_value() );
+    }
+
+    SUBCASE( "Scores a drawn king and pawn ending as a draw" )
+    {
+        FenParser parser { "7k/8/8/6KP/8/8/8/8 w - - 0 1" };
+        auto board = parser.buildBoard();
+
+        CHECK( evaluate (board, Color::White, 0) == 0 );
+        CHECK( isKnownEndgameDraw (board, Color::White) );
+    }
+
+    SUBCASE( "Scores a won king and pawn ending as a win for the side with the pawn" )
+    {
+        FenParser parser { "4k3/8/4K3/4P3/8/8/8/8 b - - 0 1" };
+        auto board = parser.buildBoard();
+
+        CHECK( evaluate (board, Color::White, 0) > Known_Win_Score );
+        CHECK( evaluate (board, Color::Black, 0) < -Known_Win_Score );
+        CHECK( !isKnownEndgameDraw (board, Color::Black) );
+    }
+
+    SUBCASE( "Drives the lone king to the edge against a rook" )
+    {
+        FenParser edge_parser { "4k3/8/4K3/8/8/8/8/R7 w - - 0 1" };
+        FenParser center_parser { "8/8/8/4k3/8/2K5/8/R7 w - - 0 1" };
+
+        auto edge_score = evaluate (edge_parser.buildBoard(), Color::White, 0);
+        auto center_score = evaluate (center_parser.buildBoard(), Color::White, 0);
+
+        CHECK( center_score > Known_Win_Score );
+        CHECK( edge_score > center_score );
+    }
+
+    SUBCASE( "Drives the lone king to a corner the bishop controls" )
+    {
+        // The bishop on c1 is on the dark squares, like a1 and h8.
+        FenParser right_parser { "7k/8/5K2/8/8/8/8/2BN4 w - - 0 1" };
+        FenParser wrong_parser { "k7/8/2K5/8/8/8/8/2BN4 w - - 0 1" };
+
+        auto right_score = evaluate (right_parser.buildBoard(), Color::White, 0);
+        auto wrong_score = evaluate (wrong_parser.buildBoard(), Color::White, 0);
+
+        CHECK( wrong_score > Known_Win_Score );
+        CHECK( right_score > wrong_score );
+    }
+}
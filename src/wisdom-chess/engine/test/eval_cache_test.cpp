@@ -0,0 +1,85 @@
+#include "wisdom-chess/engine/eval_cache.hpp"
+#include "wisdom-chess/engine/board.hpp"
+#include "wisdom-chess/engine/fen_parser.hpp"
+#include "wisdom-chess/engine/history.hpp"
+#include "wisdom-chess/engine/logger.hpp"
+#include "wisdom-chess/engine/search.hpp"
+#include "wisdom-chess/engine/transposition_table.hpp"
+
+#include "wisdom-chess-tests.hpp"
+
+using namespace wisdom;
+
+TEST_CASE( "Eval cache" )
+{
+    auto cache = EvalCache::fromMegabytes (1);
+    auto code = Board {}.getCode().getHashCode();
+
+    SUBCASE( "Returns a stored score" )
+    {
+        CHECK( !cache.probe (code, Color::White).has_value() );
+
+        cache.store (code, Color::White, -123);
+        auto score = cache.probe (code, Color::White);
+
+        REQUIRE( score.has_value() );
+        CHECK( *score == -123 );
+
+        auto stats = cache.getStats();
+        CHECK( stats.probes == 2 );
+        CHECK( stats.hits == 1 );
+    }
+
+    SUBCASE( "Keeps the scores for each side apart" )
+    {
+        cache.store (code, Color::White, 50);
+
+        CHECK( !cache.probe (code, Color::Black).has_value() );
+    }
+
+    SUBCASE( "Is emptied by clearing it" )
+    {
+        cache.store (code, Color::White, 50);
+        cache.clear();
+
+        CHECK( !cache.probe (code, Color::White).has_value() );
+    }
+
+    SUBCASE( "Stores nothing when its size is zero" )
+    {
+        cache.resize (0);
+        cache.store (code, Color::White, 50);
+
+        CHECK( !cache.isEnabled() );
+        CHECK( !cache.probe (code, Color::White).has_value() );
+        CHECK( cache.getStats().probes == 0 );
+    }
+}
+
+TEST_CASE( "Searching with the eval cache finds the same move as without it" )
+{
+    FenParser parser { "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1" };
+    auto board = parser.buildBoard();
+    auto history = History::fromInitialBoard (board);
+    auto logger = makeNullLogger();
+    MoveTimer timer { 30 };
+
+    auto table_without_cache = TranspositionTable::fromMegabytes (1);
+    auto search_without_cache = IterativeSearch::create (
+        board, history, logger, timer, 3, table_without_cache
+    );
+    auto expected = search_without_cache.iterativelyDeepen (Color::White);
+
+    auto table_with_cache = TranspositionTable::fromMegabytes (1);
+    auto cache = EvalCache::fromMegabytes (1);
+    auto search_with_cache = IterativeSearch::create (
+        board, history, logger, timer, 3, table_with_cache, cache
+    );
+    auto result = search_with_cache.iterativelyDeepen (Color::White);
+
+    REQUIRE( result.move.has_value() );
+    CHECK( *result.move == *expected.move );
+    CHECK( result.score == expected.score );
+    CHECK( search_with_cache.getNodesVisited() == search_without_cache.getNodesVisited() );
+    CHECK( cache.getStats().hits > 0 );
+}
@@ -0,0 +1,116 @@
+#include "wisdom-chess/engine/evaluate.hpp"
+#include "wisdom-chess/engine/board.hpp"
+#include "wisdom-chess/engine/fen_parser.hpp"
+#include "wisdom-chess/engine/generate.hpp"
+#include "wisdom-chess/engine/pawn_structure.hpp"
+
+#include "wisdom-chess-tests.hpp"
+
+using namespace wisdom;
+
+TEST_CASE( "Batch evaluation gives the same scores as evaluating one board at a time" )
+{
+    vector<Board> boards;
+    vector<Color> colors;
+
+    auto add = [&] (const Board& board, Color who)
+    {
+        boards.push_back (board);
+        colors.push_back (who);
+    };
+
+    SUBCASE( "For special positions" )
+    {
+        for (const auto* fen : {
+            // Castled on both sides, and unable to castle:
+            "r4rk1/pppq1ppp/2n2n2/3p4/3P4/2N2N2/PPPQ1PPP/2KR3R w - - 0 1",
+            // Checkmated:
+            "rnb1kbnr/pppp1ppp/8/4p3/6Pq/5P2/PPPPP2P/RNBQKBNR w KQkq - 1 3",
+            // Bare kings:
+            "7k/8/8/8/8/8/8/K7 w - - 0 1" })
+        {
+            FenParser parser { fen };
+            auto board = parser.buildBoard();
+            add (board, Color::White);
+            add (board, Color::Black);
+        }
+    }
+
+    SUBCASE( "For more boards than fit in one batch" )
+    {
+        std::mt19937 generator { 7 };
+
+        FenParser parser { "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1" };
+        auto board = parser.buildBoard();
+        auto who = parser.getActivePlayer();
+
+        for (int i = 0; i < 150; i++)
+        {
+            auto moves = generateLegalMoves (board, who);
+            if (moves.isEmpty())
+                break;
+
+            std::uniform_int_distribution<size_t> pick { 0, moves.size() - 1 };
+            auto move = *(moves.begin() + narrow<std::ptrdiff_t> (pick (generator)));
+
+            board = board.withMove (who, move);
+            who = colorInvert (who);
+            add (board, who);
+        }
+    }
+
+    vector<int> scores (boards.size());
+    evaluateBatch (boards, colors, scores);
+
+    for (size_t i = 0; i < boards.size(); i++)
+        CHECK( scores[i] == evaluate (boards[i], colors[i], 0) );
+}
+
+TEST_CASE( "Lazy evaluation" )
+{
+    PawnHashTable pawn_table;
+    LazyEvaluationStats stats;
+
+    FenParser parser { "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1" };
+    auto board = parser.buildBoard();
+    auto full_score = evaluate (board, Color::White, 0);
+
+    SUBCASE( "Gives the full score inside the window" )
+    {
+        auto score = evaluate (
+            board, Color::White, 0, pawn_table,
+            full_score - 10, full_score + 10, Default_Lazy_Evaluation_Margin, stats
+        );
+
+        CHECK( score == full_score );
+        CHECK( stats.full_evaluations == 1 );
+        CHECK( stats.cheap_exits == 0 );
+    }
+
+    SUBCASE( "Stops after the cheap terms far outside the window" )
+    {
+        auto alpha = full_score + 10 * Default_Lazy_Evaluation_Margin;
+        auto score = evaluate (
+            board, Color::White, 0, pawn_table,
+            alpha, alpha + 1, Default_Lazy_Evaluation_Margin, stats
+        );
+
+        CHECK( score < alpha );
+        CHECK( stats.full_evaluations == 0 );
+        CHECK( stats.cheap_exits == 1 );
+    }
+
+    SUBCASE( "Always finds a checkmate" )
+    {
+        FenParser mated_parser { "rnb1kbnr/pppp1ppp/8/4p3/6Pq/5P2/PPPPP2P/RNBQKBNR w KQkq - 1 3" };
+        auto mated_board = mated_parser.buildBoard();
+
+        auto score = evaluate (
+            mated_board, Color::White, 0, pawn_table,
+            Initial_Alpha - 1, Initial_Alpha, Default_Lazy_Evaluation_Margin, stats
+        );
+
+        CHECK( score == -checkmateScoreInMoves (0) );
+        CHECK( stats.full_evaluations == 1 );
+    }
+}
@@ -1,7 +1,12 @@
+#include <thread>
+
 #include "wisdom-chess/engine/board_builder.hpp"
+#include "wisdom-chess/engine/eval_cache.hpp"
 #include "wisdom-chess/engine/game.hpp"
 #include "wisdom-chess/engine/fen_parser.hpp"
+#include "wisdom-chess/engine/generate.hpp"
 #include "wisdom-chess/engine/history.hpp"
+#include "wisdom-chess/engine/logger.hpp"
 
 #include "wisdom-chess-tests.hpp"
 
@@ -79,3 +84,148 @@ TEST_CASE( "Initial board position is added to history" )
         run_test (game);
     }
 }
+
+TEST_CASE( "Transposition table size can be configured on a game" )
+{
+    Game game = Game::createStandardGame();
+
+    SUBCASE( "Defaults to the default transposition table size" )
+    {
+        CHECK( game.getTranspositionTableSize() == 16 );
+    }
+
+    SUBCASE( "Can be resized" )
+    {
+        game.setTranspositionTableSize (2);
+        CHECK( game.getTranspositionTableSize() == 2 );
+    }
+
+    SUBCASE( "Is kept when taken over by a new game" )
+    {
+        game.setTranspositionTableSize (2);
+
+        Game new_game = Game::createGameFromFen ("7k/8/8/8/8/8/8/K7 w - - 0 1");
+        new_game.takeTranspositionTable (std::move (game));
+
+        CHECK( new_game.getTranspositionTableSize() == 2 );
+    }
+}
+
+TEST_CASE( "Eval cache size can be configured on a game" )
+{
+    Game game = Game::createStandardGame();
+
+    CHECK( game.getEvalCacheSize() == EvalCache::Default_Size_In_Megabytes );
+
+    SUBCASE( "Can be resized" )
+    {
+        game.setEvalCacheSize (2);
+        CHECK( game.getEvalCacheSize() == 2 );
+    }
+
+    SUBCASE( "Is kept when taken over by a new game" )
+    {
+        game.setEvalCacheSize (1);
+
+        Game new_game = Game::createGameFromFen ("7k/8/8/8/8/8/8/K7 w - - 0 1");
+        new_game.takeEvalCache (std::move (game));
+
+        CHECK( new_game.getEvalCacheSize() == 1 );
+    }
+}
+
+TEST_CASE( "Transposition table is shared between copies of a game" )
+{
+    Game game = Game::createStandardGame();
+
+    SUBCASE( "Copies share the table" )
+    {
+        Game copy = game;
+        CHECK( copy.sharesTranspositionTableWith (game) );
+
+        copy.setTranspositionTableSize (2);
+        CHECK( game.getTranspositionTableSize() == 2 );
+    }
+
+    SUBCASE( "Copy assignment shares the table" )
+    {
+        Game other = Game::createGameFromFen ("7k/8/8/8/8/8/8/K7 w - - 0 1");
+        other = game;
+        CHECK( other.sharesTranspositionTableWith (game) );
+    }
+
+    SUBCASE( "Detaching gives the game its own table" )
+    {
+        Game copy = game;
+        copy.detachTranspositionTable();
+        CHECK( !copy.sharesTranspositionTableWith (game) );
+        CHECK( copy.getTranspositionTableSize() == game.getTranspositionTableSize() );
+
+        copy.setTranspositionTableSize (2);
+        CHECK( game.getTranspositionTableSize() == 16 );
+    }
+
+    SUBCASE( "Replacing gives the game its own table of a new size" )
+    {
+        Game copy = game;
+        copy.replaceTranspositionTable (2);
+        CHECK( !copy.sharesTranspositionTableWith (game) );
+        CHECK( copy.getTranspositionTableSize() == 2 );
+        CHECK( game.getTranspositionTableSize() == 16 );
+    }
+}
+
+TEST_CASE( "Stopping a search returns its best move right away" )
+{
+    auto game = Game::createGameFromFen ("r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1");
+    game.setSearchTimeout (chrono::seconds { 30 });
+
+    // The latency itself depends on how busy the machine is, and is
+    // measured by the benchmarks. Here it only has to be far short of the
+    // timeout, which it would reach if the stop were missed.
+    constexpr auto Max_Latency = chrono::seconds { 1 };
+
+    SUBCASE( "Stopping partway through" )
+    {
+        std::stop_source stop_source;
+        auto future = game.findBestMoveAsync (makeNullLogger(), stop_source.get_token());
+        std::this_thread::sleep_for (chrono::milliseconds { 100 });
+
+        auto stop_time = chrono::steady_clock::now();
+        stop_source.request_stop();
+        auto best_move = future.get();
+        auto latency = chrono::steady_clock::now() - stop_time;
+
+        CHECK( best_move.has_value() );
+        CHECK( latency < Max_Latency );
+    }
+
+    SUBCASE( "Stopping before the search starts still gives a move" )
+    {
+        std::stop_source stop_source;
+        stop_source.request_stop();
+
+        auto start = chrono::steady_clock::now();
+        auto best_move = game.findBestMove (makeNullLogger(), stop_source.get_token());
+        auto elapsed = chrono::steady_clock::now() - start;
+
+        CHECK( best_move.has_value() );
+        CHECK( elapsed < Max_Latency );
+    }
+}
+
+TEST_CASE( "The expected reply comes from the last search" )
+{
+    auto game = Game::createStandardGame();
+    game.setMaxDepth (4);
+
+    auto best_move = game.findBestMove (makeNullLogger());
+    REQUIRE( best_move.has_value() );
+
+    auto reply = game.expectedReply (*best_move);
+    REQUIRE( reply.has_value() );
+
+    auto board = game.getBoard().withMove (Color::White, *best_move);
+    auto legal_moves = generateLegalMoves (board, Color::Black);
+    CHECK( std::find (legal_moves.begin(), legal_moves.end(), *reply) != legal_moves.end() );
+}
@@ -277,3 +277,127 @@ TEST_CASE( "checkmateIsPossible()" )
         CHECK( material.checkmateIsPossible (brd) == CheckmateIsPossible::No );
     }
 }
+
+TEST_CASE( "Material info" )
+{
+    BoardBuilder builder;
+
+    builder.addPiece ("a1", Color::White, Piece::King);
+    builder.addPiece ("a8", Color::Black, Piece::King);
+
+    SUBCASE( "The default position is in the opening phase with no imbalance" )
+    {
+        Board default_board;
+        auto info = default_board.getMaterial().info();
+
+        CHECK( default_board.getMaterial().hasSignature() );
+        CHECK( info.phase == Max_Game_Phase );
+        CHECK( info.imbalance == 0 );
+        CHECK( info.draw_status == MaterialDrawStatus::Sufficient );
+        CHECK( info.endgame == EndgameType::None );
+    }
+
+    SUBCASE( "Two kings are an insufficient material ending in the final phase" )
+    {
+        auto brd = Board { builder };
+        auto info = brd.getMaterial().info();
+
+        CHECK( brd.getMaterial().signature() == 0 );
+        CHECK( info.phase == 0 );
+        CHECK( info.draw_status == MaterialDrawStatus::Insufficient );
+    }
+
+    SUBCASE( "The bishop pair is worth more than two bishops" )
+    {
+        builder.addPiece ("c1", Color::White, Piece::Bishop);
+        builder.addPiece ("f1", Color::White, Piece::Bishop);
+        builder.addPiece ("c8", Color::Black, Piece::Bishop);
+        builder.addPiece ("b8", Color::Black, Piece::Knight);
+
+        auto brd = Board { builder };
+        const auto& material = brd.getMaterial();
+
+        CHECK( material.imbalanceScore (Color::White) > 0 );
+        CHECK( material.imbalanceScore (Color::Black) == -material.imbalanceScore (Color::White) );
+    }
+
+    SUBCASE( "Specialized endings are tagged with the stronger side" )
+    {
+        builder.addPiece ("e5", Color::Black, Piece::Pawn);
+        auto king_pawn_board = Board { builder };
+        auto king_pawn = king_pawn_board.getMaterial().info();
+
+        CHECK( king_pawn.endgame == EndgameType::KingPawnVsKing );
+        CHECK( king_pawn.strong_side == Color::Black );
+
+        BoardBuilder bishop_knight_builder;
+        bishop_knight_builder.addPiece ("a1", Color::White, Piece::King);
+        bishop_knight_builder.addPiece ("a8", Color::Black, Piece::King);
+        bishop_knight_builder.addPiece ("c1", Color::White, Piece::Bishop);
+        bishop_knight_builder.addPiece ("b1", Color::White, Piece::Knight);
+        auto bishop_knight_board = Board { bishop_knight_builder };
+        auto bishop_knight = bishop_knight_board.getMaterial().info();
+
+        CHECK( bishop_knight.endgame == EndgameType::KingBishopKnightVsKing );
+        CHECK( bishop_knight.strong_side == Color::White );
+    }
+
+    SUBCASE( "The signature is kept up to date by captures and promotions" )
+    {
+        builder.addPiece ("b7", Color::White, Piece::Pawn);
+        builder.addPiece ("c8", Color::Black, Piece::Rook);
+        builder.addPiece ("h1", Color::White, Piece::Rook);
+
+        auto brd = Board { builder };
+        brd = brd.withMove (Color::White, moveParse ("b7xc8 (Q)", Color::White));
+
+        BoardBuilder expected_builder;
+        expected_builder.addPiece ("a1", Color::White, Piece::King);
+        expected_builder.addPiece ("a8", Color::Black, Piece::King);
+        expected_builder.addPiece ("c8", Color::White, Piece::Queen);
+        expected_builder.addPiece ("h1", Color::White, Piece::Rook);
+        auto expected = Board { expected_builder };
+
+        CHECK( brd.getMaterial().signature() == expected.getMaterial().signature() );
+        CHECK( brd.getMaterial().info().endgame == EndgameType::KingAndMajorVsKing );
+    }
+
+    SUBCASE( "Piece counts beyond the signature use the same rules" )
+    {
+        builder.addPiece ("b1", Color::White, Piece::Knight);
+        builder.addPiece ("c1", Color::White, Piece::Knight);
+        builder.addPiece ("d1", Color::White, Piece::Knight);
+
+        auto brd = Board { builder };
+        const auto& material = brd.getMaterial();
+
+        CHECK( !material.hasSignature() );
+        CHECK( material.info().phase == 3 );
+        CHECK( material.checkmateIsPossible (brd) == Material::CheckmateIsPossible::Yes );
+    }
+
+    SUBCASE( "The table agrees with computing the info directly" )
+    {
+        Material::PieceCounts counts {};
+        counts[Color_Index_White][toInt (Piece::Knight)] = 1;
+        counts[Color_Index_Black][toInt (Piece::Bishop)] = 2;
+        counts[Color_Index_Black][toInt (Piece::Queen)] = 1;
+
+        BoardBuilder counts_builder;
+        counts_builder.addPiece ("a1", Color::White, Piece::King);
+        counts_builder.addPiece ("a8", Color::Black, Piece::King);
+        counts_builder.addPiece ("b1", Color::White, Piece::Knight);
+        counts_builder.addPiece ("c8", Color::Black, Piece::Bishop);
+        counts_builder.addPiece ("f8", Color::Black, Piece::Bishop);
+        counts_builder.addPiece ("d8", Color::Black, Piece::Queen);
+
+        auto counts_board = Board { counts_builder };
+        auto from_table = counts_board.getMaterial().info();
+        auto computed = Material::computeInfo (counts);
+
+        CHECK( from_table.imbalance == computed.imbalance );
+        CHECK( from_table.phase == computed.phase );
+        CHECK( from_table.draw_status == computed.draw_status );
+        CHECK( from_table.endgame == computed.endgame );
+    }
+}
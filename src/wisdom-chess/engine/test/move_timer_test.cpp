@@ -0,0 +1,134 @@
+#include <thread>
+
+#include "wisdom-chess/engine/board.hpp"
+#include "wisdom-chess/engine/fen_parser.hpp"
+#include "wisdom-chess/engine/history.hpp"
+#include "wisdom-chess/engine/logger.hpp"
+#include "wisdom-chess/engine/move_timer.hpp"
+#include "wisdom-chess/engine/search.hpp"
+#include "wisdom-chess/engine/transposition_table.hpp"
+
+#include "wisdom-chess-tests.hpp"
+
+using namespace wisdom;
+
+namespace
+{
+    using Clock = chrono::steady_clock;
+
+    constexpr auto Kiwipete = "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1";
+
+    // Run a search on a position with many moves deep enough that only the
+    // timer stops it, and return how long it took.
+    auto
+    timeSearch (MoveTimer timer)
+        -> std::pair<Clock::duration, SearchResult>
+    {
+        FenParser parser { Kiwipete };
+        auto board = parser.buildBoard();
+        auto history = History::fromInitialBoard (board);
+        auto table = TranspositionTable::fromMegabytes (1);
+
+        auto search = IterativeSearch::create (board, history, makeNullLogger(), timer, 64, table);
+        auto start = Clock::now();
+        auto result = search.iterativelyDeepen (Color::White);
+        return { Clock::now() - start, result };
+    }
+}
+
+TEST_CASE( "Move timer" )
+{
+    SUBCASE( "Limits have millisecond resolution" )
+    {
+        MoveTimer timer { chrono::milliseconds { 1500 } };
+        CHECK( timer.getTimeLimit() == chrono::milliseconds { 1500 } );
+        CHECK( !timer.getSoftTimeLimit().has_value() );
+
+        timer.setSoftTimeLimit (chrono::milliseconds { 750 });
+        CHECK( timer.getSoftTimeLimit() == chrono::milliseconds { 750 } );
+    }
+
+    SUBCASE( "Is never triggered before it's started" )
+    {
+        MoveTimer timer { chrono::milliseconds { 0 } };
+        timer.setSoftTimeLimit (chrono::milliseconds { 0 });
+        CHECK( !timer.isTriggered() );
+        CHECK( !timer.isSoftLimitReached() );
+        CHECK( timer.elapsed() == Clock::duration::zero() );
+    }
+
+    SUBCASE( "The soft limit passes before the hard one" )
+    {
+        MoveTimer timer { chrono::seconds { 10 } };
+        timer.setSoftTimeLimit (chrono::milliseconds { 5 });
+        timer.start();
+        std::this_thread::sleep_for (chrono::milliseconds { 10 });
+
+        CHECK( timer.isSoftLimitReached() );
+        CHECK( !timer.isTriggered() );
+    }
+
+    SUBCASE( "Pondering holds off the limits until the ponder hit" )
+    {
+        std::stop_source ponder_hit;
+        MoveTimer timer { chrono::milliseconds { 1 } };
+        timer.setSoftTimeLimit (chrono::milliseconds { 1 });
+        timer.setPonderHitToken (ponder_hit.get_token());
+        timer.start();
+        std::this_thread::sleep_for (chrono::milliseconds { 5 });
+
+        bool triggered = false;
+        for (int i = 0; i < Max_Iterations_Before_Checking && !triggered; i++)
+            triggered = timer.isTriggered();
+        CHECK( timer.isPondering() );
+        CHECK( !triggered );
+        CHECK( !timer.isSoftLimitReached() );
+
+        ponder_hit.request_stop();
+        for (int i = 0; i < Max_Iterations_Before_Checking && !triggered; i++)
+            triggered = timer.isTriggered();
+        CHECK( !timer.isPondering() );
+        CHECK( triggered );
+        CHECK( timer.isSoftLimitReached() );
+    }
+
+    SUBCASE( "Checks the clock often enough to notice the hard limit has passed" )
+    {
+        MoveTimer timer { chrono::milliseconds { 1 } };
+        timer.start();
+        while (timer.elapsed() < timer.getTimeLimit())
+            std::this_thread::yield();
+
+        bool triggered = false;
+        for (int i = 0; i < Max_Iterations_Before_Checking && !triggered; i++)
+            triggered = timer.isTriggered();
+        CHECK( triggered );
+    }
+}
+
+TEST_CASE( "Searches stop close to their deadlines" )
+{
+    // How far past the limit the search runs depends on how busy the
+    // machine is, so it's measured by the benchmarks rather than checked.
+    SUBCASE( "The hard limit stops a search" )
+    {
+        constexpr auto Limit = chrono::milliseconds { 100 };
+        auto [elapsed, result] = timeSearch (MoveTimer { Limit });
+
+        CHECK( result.move.has_value() );
+        CHECK( elapsed >= Limit );
+    }
+
+    SUBCASE( "The soft limit stops a search from starting another depth" )
+    {
+        MoveTimer timer { chrono::seconds { 10 } };
+        timer.setSoftTimeLimit (chrono::milliseconds { 50 });
+        auto [elapsed, result] = timeSearch (timer);
+
+        // The time manager can end the search before the soft limit when
+        // the best move has settled, but it shouldn't reach the hard one.
+        CHECK( result.move.has_value() );
+        CHECK( !result.timed_out );
+        CHECK( elapsed < chrono::seconds { 10 } );
+    }
+}
@@ -0,0 +1,212 @@
+#include <filesystem>
+#include <fstream>
+
+#include "wisdom-chess/engine/nnue.hpp"
+#include "wisdom-chess/engine/board.hpp"
+#include "wisdom-chess/engine/evaluate.hpp"
+#include "wisdom-chess/engine/eval_cache.hpp"
+#include "wisdom-chess/engine/fen_parser.hpp"
+#include "wisdom-chess/engine/generate.hpp"
+#include "wisdom-chess/engine/history.hpp"
+#include "wisdom-chess/engine/logger.hpp"
+#include "wisdom-chess/engine/search.hpp"
+#include "wisdom-chess/engine/transposition_table.hpp"
+
+#include "wisdom-chess-tests.hpp"
+
+using namespace wisdom;
+
+// Building the weights takes a moment, so share one network between the tests.
+static auto
+randomNetwork()
+    -> shared_ptr<NnueNetwork>
+{
+    static auto network = NnueNetwork::fromWeights (NnueWeights::random (1234));
+    network->setKernel (NnueKernel::Scalar);
+    return network;
+}
+
+static auto
+refreshed (const NnueNetwork& network, const Board& board)
+    -> NnueAccumulator
+{
+    NnueAccumulator result {};
+    network.refresh (board, result);
+    return result;
+}
+
+TEST_CASE( "Boards record the squares changed by the last move" )
+{
+    Board board;
+    CHECK( board.getLastMoveChanges().empty() );
+
+    SUBCASE( "Two squares for a normal move" )
+    {
+        auto child = board.withMove (Color::White, moveParse ("e2e4", Color::White));
+        auto changes = child.getLastMoveChanges();
+
+        REQUIRE( changes.size() == 2 );
+        CHECK( changes[0].coord == coordParse ("e2") );
+        CHECK( changes[0].removed == ColoredPiece::make (Color::White, Piece::Pawn) );
+        CHECK( changes[1].coord == coordParse ("e4") );
+        CHECK( changes[1].added == ColoredPiece::make (Color::White, Piece::Pawn) );
+    }
+
+    SUBCASE( "Four squares for castling" )
+    {
+        FenParser parser { "r3k2r/8/8/8/8/8/8/R3K2R w KQkq - 0 1" };
+        auto castling_board = parser.buildBoard();
+        auto move = mapCoordinatesToMove (castling_board, Color::White, coordParse ("e1"), coordParse ("g1"));
+        REQUIRE( move.has_value() );
+
+        auto child = castling_board.withMove (Color::White, *move);
+        CHECK( child.getLastMoveChanges().size() == 4 );
+    }
+}
+
+TEST_CASE( "Network files" )
+{
+    auto path = (std::filesystem::temp_directory_path() / "wisdom-chess-nnue-test.nnue").string();
+    auto network = randomNetwork();
+
+    SUBCASE( "A saved network evaluates the same when loaded again" )
+    {
+        network->saveTo (path);
+        auto loaded = NnueNetwork::load (path);
+        loaded->setKernel (NnueKernel::Scalar);
+
+        FenParser parser { "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1" };
+        auto board = parser.buildBoard();
+
+        auto original_accumulator = refreshed (*network, board);
+        auto loaded_accumulator = refreshed (*loaded, board);
+        CHECK( loaded_accumulator.values == original_accumulator.values );
+        CHECK( loaded->evaluate (loaded_accumulator, Color::White)
+               == network->evaluate (original_accumulator, Color::White) );
+        CHECK( loaded->getPath() == path );
+    }
+
+    SUBCASE( "Loading a file that isn't a network throws" )
+    {
+        {
+            std::ofstream output { path, std::ios::binary | std::ios::trunc };
+            output << "not a network";
+        }
+        CHECK_THROWS_AS( (void)NnueNetwork::load (path), NnueFileError );
+    }
+
+    SUBCASE( "Loading a missing file throws" )
+    {
+        std::filesystem::remove (path);
+        CHECK_THROWS_AS( (void)NnueNetwork::load (path), NnueFileError );
+    }
+
+    std::filesystem::remove (path);
+}
+
+TEST_CASE( "Incremental network updates match a refresh" )
+{
+    auto network = randomNetwork();
+
+    SUBCASE( "Through king moves, castling and en passant" )
+    {
+        Board board;
+        auto accumulator = refreshed (*network, board);
+        Color who = Color::White;
+
+        for (const auto* move_str : { "e2e4", "d7d5", "e4e5", "f7f5", "e5f6", "g8f6", "g1f3", "e8f7",
+                                      "f1e2", "f7g8", "e1g1", "b8c6" })
+        {
+            auto coords = string { move_str };
+            auto move = mapCoordinatesToMove (
+                board, who, coordParse (coords.substr (0, 2)), coordParse (coords.substr (2, 2))
+            );
+            REQUIRE( move.has_value() );
+
+            board = board.withMove (who, *move);
+            network->update (accumulator, board, accumulator);
+            CHECK( accumulator.values == refreshed (*network, board).values );
+
+            who = colorInvert (who);
+        }
+    }
+
+    SUBCASE( "Through random games with captures and promotions" )
+    {
+        std::mt19937 generator { 42 };
+
+        for (const auto* fen : { "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+                                 "n1n5/PPPk4/8/8/8/8/4Kppp/5N1N b - - 0 1" })
+        {
+            FenParser parser { fen };
+            auto board = parser.buildBoard();
+            auto who = parser.getActivePlayer();
+            auto accumulator = refreshed (*network, board);
+
+            for (int i = 0; i < 40; i++)
+            {
+                auto moves = generateLegalMoves (board, who);
+                if (moves.isEmpty())
+                    break;
+
+                std::uniform_int_distribution<size_t> pick { 0, moves.size() - 1 };
+                auto move = *(moves.begin() + narrow<std::ptrdiff_t> (pick (generator)));
+
+                board = board.withMove (who, move);
+                network->update (accumulator, board, accumulator);
+                REQUIRE( accumulator.values == refreshed (*network, board).values );
+
+                who = colorInvert (who);
+            }
+        }
+    }
+}
+
+TEST_CASE( "Network kernels agree with the scalar kernel" )
+{
+    auto network = randomNetwork();
+
+    FenParser parser { "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1" };
+    auto board = parser.buildBoard();
+    auto child = board.withMove (Color::White, moveParse ("e5f7", Color::White));
+
+    auto expected_accumulator = refreshed (*network, board);
+    network->update (expected_accumulator, child, expected_accumulator);
+    auto expected_score = network->evaluate (expected_accumulator, Color::Black);
+
+    for (auto kernel : { NnueKernel::Sse41, NnueKernel::Avx2 })
+    {
+        if (!isNnueKernelSupported (kernel))
+            continue;
+
+        INFO( asString (kernel) );
+        auto network_with_kernel = NnueNetwork::fromWeights (NnueWeights::random (1234));
+        network_with_kernel->setKernel (kernel);
+
+        auto accumulator = refreshed (*network_with_kernel, board);
+        network_with_kernel->update (accumulator, child, accumulator);
+
+        CHECK( accumulator.values == expected_accumulator.values );
+        CHECK( network_with_kernel->evaluate (accumulator, Color::Black) == expected_score );
+    }
+}
+
+TEST_CASE( "Searching with a network finds a move" )
+{
+    auto network = randomNetwork();
+
+    FenParser parser { "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1" };
+    auto board = parser.buildBoard();
+    auto history = History::fromInitialBoard (board);
+    MoveTimer timer { 30 };
+    auto table = TranspositionTable::fromMegabytes (1);
+    auto cache = EvalCache::fromMegabytes (0);
+
+    auto search = IterativeSearch::create (
+        board, history, makeNullLogger(), timer, 3, table, cache, network.get()
+    );
+    auto result = search.iterativelyDeepen (Color::White);
+
+    REQUIRE( result.move.has_value() );
+    CHECK( !isCheckmatingOpponentScore (result.score) );
+}
@@ -0,0 +1,159 @@
+#include "wisdom-chess/engine/pawn_structure.hpp"
+#include "wisdom-chess/engine/board.hpp"
+#include "wisdom-chess/engine/board_builder.hpp"
+#include "wisdom-chess/engine/evaluate.hpp"
+#include "wisdom-chess/engine/fen_parser.hpp"
+
+#include "wisdom-chess-tests.hpp"
+
+using namespace wisdom;
+
+TEST_CASE( "Pawn code" )
+{
+    SUBCASE( "Is the same after moves as for a board built from scratch" )
+    {
+        FenParser parser { "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1" };
+        auto board = parser.buildBoard();
+
+        // A capture of a pawn, a pawn push, and a move of another piece:
+        board = board.withMove (Color::White, moveParse ("g2xh3", Color::White));
+        board = board.withMove (Color::Black, moveParse ("c7c5", Color::Black));
+        board = board.withMove (Color::White, moveParse ("d5d6", Color::White));
+        board = board.withMove (Color::Black, moveParse ("O-O", Color::Black));
+
+        FenParser expected_parser { board.toFenString (Color::White) };
+        auto expected = expected_parser.buildBoard();
+
+        CHECK( board.getPawnCode() == expected.getPawnCode() );
+    }
+
+    SUBCASE( "Is updated by en passant and promotion" )
+    {
+        BoardBuilder builder;
+        builder.addPiece ("e1", Color::White, Piece::King);
+        builder.addPiece ("e8", Color::Black, Piece::King);
+        builder.addPiece ("e5", Color::White, Piece::Pawn);
+        builder.addPiece ("d5", Color::Black, Piece::Pawn);
+        builder.addPiece ("a7", Color::White, Piece::Pawn);
+        builder.setEnPassantTarget (Color::Black, "d6");
+
+        auto board = Board { builder };
+        board = board.withMove (Color::White, moveParse ("e5 d6 ep", Color::White));
+        board = board.withCurrentTurn (Color::White);
+        board = board.withMove (Color::White, moveParse ("a7a8 (Q)", Color::White));
+
+        BoardBuilder expected_builder;
+        expected_builder.addPiece ("e1", Color::White, Piece::King);
+        expected_builder.addPiece ("e8", Color::Black, Piece::King);
+        expected_builder.addPiece ("d6", Color::White, Piece::Pawn);
+        expected_builder.addPiece ("a8", Color::White, Piece::Queen);
+
+        CHECK( board.getPawnCode() == Board { expected_builder }.getPawnCode() );
+    }
+
+    SUBCASE( "Doesn't change when other pieces move" )
+    {
+        Board board;
+        auto after_move = board.withMove (Color::White, moveParse ("g1f3", Color::White));
+
+        CHECK( after_move.getPawnCode() == board.getPawnCode() );
+        CHECK( after_move.getCode() != board.getCode() );
+    }
+}
+
+TEST_CASE( "Pawn structure" )
+{
+    BoardBuilder builder;
+    builder.addPiece ("e1", Color::White, Piece::King);
+    builder.addPiece ("e8", Color::Black, Piece::King);
+
+    SUBCASE( "The default position has no pawn weaknesses" )
+    {
+        auto structure = analyzePawnStructure (Board {});
+
+        CHECK( structure.total (Color::White) == 0 );
+        CHECK( structure.total (Color::Black) == 0 );
+        CHECK( structure.passed_pawns[Color_Index_White] == 0 );
+    }
+
+    SUBCASE( "Doubled and isolated pawns are penalized" )
+    {
+        builder.addPiece ("a2", Color::White, Piece::Pawn);
+        builder.addPiece ("a3", Color::White, Piece::Pawn);
+        builder.addPiece ("h7", Color::Black, Piece::Pawn);
+        builder.addPiece ("g7", Color::Black, Piece::Pawn);
+        builder.addPiece ("a7", Color::Black, Piece::Pawn);
+
+        auto structure = analyzePawnStructure (Board { builder });
+
+        CHECK( structure.doubled[Color_Index_White] < 0 );
+        CHECK( structure.isolated[Color_Index_White] < 0 );
+        CHECK( structure.doubled[Color_Index_Black] == 0 );
+        CHECK( structure.isolated[Color_Index_Black] < 0 );
+        CHECK( structure.isolated[Color_Index_White] == 2 * structure.isolated[Color_Index_Black] );
+    }
+
+    SUBCASE( "Passed pawns get a larger bonus the further they are advanced" )
+    {
+        builder.addPiece ("b6", Color::White, Piece::Pawn);
+        builder.addPiece ("g3", Color::White, Piece::Pawn);
+        builder.addPiece ("h7", Color::Black, Piece::Pawn);
+
+        auto board = Board { builder };
+        auto structure = analyzePawnStructure (board);
+
+        auto b6 = uint64_t { 1 } << coordParse ("b6").index();
+        CHECK( structure.passed_pawns[Color_Index_White] == b6 );
+        CHECK( structure.passed_pawns[Color_Index_Black] == 0 );
+        CHECK( structure.passed[Color_Index_White] > 0 );
+        CHECK( structure.overallScore (Color::White) > 0 );
+        CHECK( structure.overallScore (Color::Black) == -structure.overallScore (Color::White) );
+    }
+
+    SUBCASE( "A pawn left behind its neighbors and blocked by an enemy pawn is backward" )
+    {
+        builder.addPiece ("c2", Color::White, Piece::Pawn);
+        builder.addPiece ("b3", Color::White, Piece::Pawn);
+        builder.addPiece ("d3", Color::White, Piece::Pawn);
+        builder.addPiece ("b4", Color::Black, Piece::Pawn);
+
+        auto structure = analyzePawnStructure (Board { builder });
+
+        CHECK( structure.backward[Color_Index_White] < 0 );
+        CHECK( structure.backward[Color_Index_Black] == 0 );
+    }
+}
+
+TEST_CASE( "Pawn hash table" )
+{
+    SUBCASE( "Returns the same structure as analyzing the board" )
+    {
+        FenParser parser { "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1" };
+        auto board = parser.buildBoard();
+        PawnHashTable table;
+
+        auto expected = analyzePawnStructure (board);
+        const auto& first = table.probe (board);
+        const auto& second = table.probe (board);
+
+        CHECK( first.overallScore (Color::White) == expected.overallScore (Color::White) );
+        CHECK( second.passed_pawns == expected.passed_pawns );
+
+        auto stats = table.getStats();
+        CHECK( stats.probes == 2 );
+        CHECK( stats.hits == 1 );
+    }
+
+    SUBCASE( "Evaluating with the table gives the same score as without it" )
+    {
+        FenParser parser { "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1" };
+        auto board = parser.buildBoard();
+        PawnHashTable table;
+
+        for (auto color : { Color::White, Color::Black })
+        {
+            CHECK( evaluate (board, color, 1, table) == evaluate (board, color, 1) );
+            CHECK( evaluate (board, color, 1, table) == evaluate (board, color, 1) );
+        }
+    }
+}
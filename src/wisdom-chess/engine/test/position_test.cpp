@@ -2,6 +2,7 @@
 #include "wisdom-chess/engine/position.hpp"
 #include "wisdom-chess/engine/move.hpp"
 #include "wisdom-chess/engine/board_builder.hpp"
+#include "wisdom-chess/engine/fen_parser.hpp"
 
 #include "wisdom-chess-tests.hpp"
 
@@ -11,9 +12,11 @@ TEST_CASE( "Position is initialized correctly" )
 {
     Board board;
 
-    CHECK( board.getPosition().individualScore (Color::White) < 0 );
-    CHECK( board.getPosition().individualScore (Color::Black) < 0 );
+    // The pieces are worse off on their starting squares than their material alone.
+    CHECK( board.getPosition().individualScore (Color::White).middlegame < board.getMaterial().individualScore (Color::White) );
+    CHECK( board.getPosition().individualScore (Color::Black).middlegame < board.getMaterial().individualScore (Color::Black) );
     CHECK( board.getPosition().individualScore (Color::White) == board.getPosition().individualScore (Color::Black) );
+    CHECK( board.getPosition().overallScore (Color::White, Max_Game_Phase) == 0 );
 }
 
 TEST_CASE( "Center pawn elevates position overallScore" )
@@ -28,8 +31,8 @@ TEST_CASE( "Center pawn elevates position overallScore" )
     
     auto board = Board { builder };
 
-	auto white_score = board.getPosition().overallScore (Color::White);
-	auto black_score = board.getPosition().overallScore (Color::Black);
+	auto white_score = board.getPosition().overallScore (Color::White, Max_Game_Phase);
+	auto black_score = board.getPosition().overallScore (Color::Black, Max_Game_Phase);
     CHECK( white_score > black_score );
 }
 
@@ -45,15 +48,15 @@ TEST_CASE( "Capture updates position overallScore correctly" )
 
     auto board = Board { builder };
 
-    int initial_score_white = board.getPosition().overallScore (Color::White);
-    int initial_score_black = board.getPosition().overallScore (Color::Black);
+    int initial_score_white = board.getPosition().overallScore (Color::White, Max_Game_Phase);
+    int initial_score_black = board.getPosition().overallScore (Color::Black, Max_Game_Phase);
 
     Move e4xd6 = moveParse ("e4xd6", Color::White);
 
     board = board.withMove (Color::White, e4xd6);
 
-    CHECK( initial_score_white != board.getPosition().overallScore (Color::White) );
-    CHECK( initial_score_black != board.getPosition().overallScore (Color::Black) );
+    CHECK( initial_score_white != board.getPosition().overallScore (Color::White, Max_Game_Phase) );
+    CHECK( initial_score_black != board.getPosition().overallScore (Color::Black, Max_Game_Phase) );
 }
 
 TEST_CASE( "En passant updates position overallScore correctly" )
@@ -68,16 +71,16 @@ TEST_CASE( "En passant updates position overallScore correctly" )
 
     auto board = Board { builder };
 
-    int initial_score_white = board.getPosition().overallScore (Color::White);
-    int initial_score_black = board.getPosition().overallScore (Color::Black);
+    int initial_score_white = board.getPosition().overallScore (Color::White, Max_Game_Phase);
+    int initial_score_black = board.getPosition().overallScore (Color::Black, Max_Game_Phase);
 
     Move e5xd5 = moveParse ("e5d6 ep", Color::White);
     CHECK( e5xd5.isEnPassant() );
 
     board = board.withMove (Color::White, e5xd5);
 
-    CHECK( initial_score_white != board.getPosition().overallScore (Color::White) );
-    CHECK( initial_score_black != board.getPosition().overallScore (Color::Black) );
+    CHECK( initial_score_white != board.getPosition().overallScore (Color::White, Max_Game_Phase) );
+    CHECK( initial_score_black != board.getPosition().overallScore (Color::Black, Max_Game_Phase) );
 }
 
 TEST_CASE( "Castling updates position overallScore correctly" )
@@ -92,8 +95,8 @@ TEST_CASE( "Castling updates position overallScore correctly" )
     builder.addPiece ("d5", Color::Black, Piece::Pawn);
 
     auto board = Board { builder };
-    int initial_score_white = board.getPosition().overallScore (Color::White);
-    int initial_score_black = board.getPosition().overallScore (Color::Black);
+    int initial_score_white = board.getPosition().overallScore (Color::White, Max_Game_Phase);
+    int initial_score_black = board.getPosition().overallScore (Color::Black, Max_Game_Phase);
 
     std::vector castling_moves { "o-o", "o-o-o" };
     for (auto castling_move_in : castling_moves)
@@ -103,8 +106,8 @@ TEST_CASE( "Castling updates position overallScore correctly" )
 
         Board after_castling = board.withMove (Color::White, castling_move);
 
-        CHECK( initial_score_white != after_castling.getPosition().overallScore (Color::White) );
-        CHECK( initial_score_black != after_castling.getPosition().overallScore (Color::Black) );
+        CHECK( initial_score_white != after_castling.getPosition().overallScore (Color::White, Max_Game_Phase) );
+        CHECK( initial_score_black != after_castling.getPosition().overallScore (Color::Black, Max_Game_Phase) );
     }
 }
 
@@ -118,8 +121,8 @@ TEST_CASE( "Promoting move updates position overallScore correctly" )
     builder.addPiece ("h7", Color::White, Piece::Pawn);
 
     auto board = Board { builder };
-    int initial_score_white = board.getPosition().overallScore (Color::White);
-    int initial_score_black = board.getPosition().overallScore (Color::Black);
+    int initial_score_white = board.getPosition().overallScore (Color::White, Max_Game_Phase);
+    int initial_score_black = board.getPosition().overallScore (Color::Black, Max_Game_Phase);
 
     std::vector promoting_moves { "h7h8 (Q)", "h7h8 (R)", "h7h8 (B)", "h7h8 (N)" };
     for (auto promoting_move_in : promoting_moves)
@@ -129,8 +132,8 @@ TEST_CASE( "Promoting move updates position overallScore correctly" )
 
         Board after_promotion = board.withMove (Color::White, promoting_move);
 
-        CHECK( initial_score_white != after_promotion.getPosition().overallScore (Color::White) );
-        CHECK( initial_score_black != after_promotion.getPosition().overallScore (Color::Black) );
+        CHECK( initial_score_white != after_promotion.getPosition().overallScore (Color::White, Max_Game_Phase) );
+        CHECK( initial_score_black != after_promotion.getPosition().overallScore (Color::Black, Max_Game_Phase) );
     }
 }
 
@@ -144,9 +147,57 @@ TEST_CASE( "Double pawn moves are more appealing" )
 
     Board after_white = board.withMove (Color::White, e2e4);
     Board with_double = after_white.withMove (Color::Black, e7e5);
-    auto black_big_score = with_double.getPosition().individualScore (Color::Black);
+    auto black_big_score = with_double.getPosition().individualScore (Color::Black).middlegame;
     Board with_single = after_white.withMove (Color::Black, e7e6);
-    auto black_small_score = with_single.getPosition().individualScore (Color::Black);
+    auto black_small_score = with_single.getPosition().individualScore (Color::Black).middlegame;
 
     REQUIRE( black_big_score > black_small_score );
 }
+
+TEST_CASE( "Position is the same after moves as for a board built from scratch" )
+{
+    FenParser parser { "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1" };
+    auto board = parser.buildBoard();
+
+    board = board.withMove (Color::White, moveParse ("e5xf7", Color::White));
+    board = board.withMove (Color::Black, moveParse ("O-O-O", Color::Black));
+    board = board.withMove (Color::White, moveParse ("g2xh3", Color::White));
+
+    FenParser expected_parser { board.toFenString (Color::Black) };
+    auto expected = expected_parser.buildBoard();
+
+    for (auto color : { Color::White, Color::Black })
+        CHECK( board.getPosition().individualScore (color) == expected.getPosition().individualScore (color) );
+}
+
+TEST_CASE( "King is encouraged to centralize in the endgame" )
+{
+    BoardBuilder builder;
+    builder.addPiece ("e8", Color::Black, Piece::King);
+    builder.addPiece ("a7", Color::Black, Piece::Pawn);
+    builder.addPiece ("a2", Color::White, Piece::Pawn);
+
+    auto with_king_at = [&builder] (const char* king_square) -> Board
+    {
+        BoardBuilder king_builder = builder;
+        king_builder.addPiece (king_square, Color::White, Piece::King);
+        return Board { king_builder };
+    };
+
+    auto hiding = with_king_at ("g1");
+    auto central = with_king_at ("e4");
+    const auto& hiding_position = hiding.getPosition();
+    const auto& central_position = central.getPosition();
+
+    CHECK( hiding_position.overallScore (Color::White, Max_Game_Phase) > central_position.overallScore (Color::White, Max_Game_Phase) );
+    CHECK( hiding_position.overallScore (Color::White, 0) < central_position.overallScore (Color::White, 0) );
+}
+
+TEST_CASE( "Tapered scores blend the middlegame and endgame by phase" )
+{
+    TaperedScore score { .middlegame = 100, .endgame = -20 };
+
+    CHECK( score.blend (Max_Game_Phase) == 100 );
+    CHECK( score.blend (0) == -20 );
+    CHECK( score.blend (Max_Game_Phase / 2) == 40 );
+}
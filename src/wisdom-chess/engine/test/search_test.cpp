@@ -2,6 +2,7 @@
 
 #include "wisdom-chess/engine/board.hpp"
 #include "wisdom-chess/engine/board_builder.hpp"
+#include "wisdom-chess/engine/endgame.hpp"
 #include "wisdom-chess/engine/fen_parser.hpp"
 #include "wisdom-chess/engine/game.hpp"
 #include "wisdom-chess/engine/history.hpp"
@@ -28,7 +29,7 @@ namespace wisdom::test
         auto build (const Board& board, int depth, int time = 30)
             -> IterativeSearch
         {
-            timer.setSeconds (chrono::seconds { time });
+            timer.setTimeLimit (chrono::seconds { time });
             return IterativeSearch::create (board, history, logger, timer, depth, transposition_table);
         }
     };
@@ -405,7 +406,7 @@ TEST_CASE( "Engine should avoid moves that allow opponent to force a draw when a
 
     // Search from initial position (Black to move)
     {
-        timer.setSeconds (chrono::seconds { 1 });
+        timer.setTimeLimit (chrono::seconds { 1 });
         auto search = IterativeSearch::create (board, history, logger, timer, intermediate_depth, tt);
         (void)search.iterativelyDeepen (Color::Black);
     }
@@ -417,7 +418,7 @@ TEST_CASE( "Engine should avoid moves that allow opponent to force a draw when a
 
     // Search from this position (White to move)
     {
-        timer.setSeconds (chrono::seconds { 1 });
+        timer.setTimeLimit (chrono::seconds { 1 });
         auto search = IterativeSearch::create (board, history, logger, timer, intermediate_depth, tt);
         (void)search.iterativelyDeepen (Color::White);
     }
@@ -429,7 +430,7 @@ TEST_CASE( "Engine should avoid moves that allow opponent to force a draw when a
 
     // Search from this position (Black to move)
     {
-        timer.setSeconds (chrono::seconds { 1 });
+        timer.setTimeLimit (chrono::seconds { 1 });
         auto search = IterativeSearch::create (board, history, logger, timer, intermediate_depth, tt);
         (void)search.iterativelyDeepen (Color::Black);
     }
@@ -442,7 +443,7 @@ TEST_CASE( "Engine should avoid moves that allow opponent to force a draw when a
     // 2nd occurrence: Bd6, Ra6
     // Search from this position (White to move)
     {
-        timer.setSeconds (chrono::seconds { 1 });
+        timer.setTimeLimit (chrono::seconds { 1 });
         auto search = IterativeSearch::create (board, history, logger, timer, intermediate_depth, tt);
         (void)search.iterativelyDeepen (Color::White);
     }
@@ -454,7 +455,7 @@ TEST_CASE( "Engine should avoid moves that allow opponent to force a draw when a
 
     // Search from this position (Black to move)
     {
-        timer.setSeconds (chrono::seconds { 1 });
+        timer.setTimeLimit (chrono::seconds { 1 });
         auto search = IterativeSearch::create (board, history, logger, timer, intermediate_depth, tt);
         (void)search.iterativelyDeepen (Color::Black);
     }
@@ -466,7 +467,7 @@ TEST_CASE( "Engine should avoid moves that allow opponent to force a draw when a
 
     // Search from this position (White to move)
     {
-        timer.setSeconds (chrono::seconds { 1 });
+        timer.setTimeLimit (chrono::seconds { 1 });
         auto search = IterativeSearch::create (board, history, logger, timer, intermediate_depth, tt);
         (void)search.iterativelyDeepen (Color::White);
     }
@@ -481,7 +482,7 @@ TEST_CASE( "Engine should avoid moves that allow opponent to force a draw when a
     // The TT now has cached scores for these positions from earlier searches
     // that didn't have the full repetition history.
 
-    timer.setSeconds (chrono::seconds { 1 });
+    timer.setTimeLimit (chrono::seconds { 1 });
     auto search = IterativeSearch::create (board, history, logger, timer, final_depth, tt);
     auto result = search.iterativelyDeepen (Color::Black);
 
@@ -498,3 +499,286 @@ TEST_CASE( "Engine should avoid moves that allow opponent to force a draw when a
     CHECK( result.score > 100 );
 }
 
+
+// A fixed suite of positions with one clearly best move, to guard against
+// the lazy evaluation cutting corners that cost the search its strength.
+TEST_CASE( "Lazy evaluation finds the same moves as the full evaluation on a fixed suite" )
+{
+    struct SuitePosition
+    {
+        const char* fen;
+        const char* best_move;
+    };
+
+    const SuitePosition suite[] = {
+        // Back rank mate:
+        { "6k1/5ppp/8/8/8/8/5PPP/3R2K1 w - - 0 1", "d1d8" },
+        { "3r2k1/5ppp/8/8/8/8/5PPP/6K1 b - - 0 1", "d8d1" },
+        // Take the queen:
+        { "rnb1kbnr/pppp1ppp/8/4p3/4P2q/5N2/PPPP1PPP/RNBQKB1R w KQkq - 2 3", "f3xh4" },
+        // Knight fork of king and queen:
+        { "4k3/1q6/8/8/4N3/8/8/6K1 w - - 0 1", "e4d6" },
+        // Advance the passed pawn to promote:
+        { "8/1P6/8/8/8/2k5/8/6K1 w - - 0 1", "b7b8 (Q)" },
+    };
+
+    size_t cheap_exits = 0;
+    for (const auto& position : suite)
+    {
+        INFO( position.fen );
+
+        FenParser parser { position.fen };
+        auto board = parser.buildBoard();
+        auto who = parser.getActivePlayer();
+        auto expected = moveParse (position.best_move, who);
+
+        SearchHelper full_helper;
+        auto full_search = full_helper.build (board, 4);
+        full_search.setLazyEvaluationMargin (nullopt);
+        auto full_result = full_search.iterativelyDeepen (who);
+
+        SearchHelper lazy_helper;
+        auto lazy_search = lazy_helper.build (board, 4);
+        auto lazy_result = lazy_search.iterativelyDeepen (who);
+
+        REQUIRE( full_result.move.has_value() );
+        REQUIRE( lazy_result.move.has_value() );
+        CHECK( *full_result.move == expected );
+        CHECK( *lazy_result.move == expected );
+        CHECK( full_search.getLazyEvaluationStats().cheap_exits == 0 );
+
+        cheap_exits += lazy_search.getLazyEvaluationStats().cheap_exits;
+    }
+
+    CHECK( cheap_exits > 0 );
+}
+
+TEST_CASE( "Searching a drawn king and pawn ending stops almost immediately" )
+{
+    FenParser parser { "7k/8/8/6KP/8/8/8/8 w - - 0 1" };
+    auto game = parser.build();
+
+    SearchHelper helper;
+    auto search = helper.build (game.getBoard(), Default_Max_Depth);
+    auto result = search.iterativelyDeepen (Color::White);
+
+    REQUIRE( result.move.has_value() );
+    CHECK( !result.timed_out );
+    CHECK( result.score <= 0 );
+    CHECK( search.getNodesVisited() < 1000 );
+}
+
+TEST_CASE( "Searching a won king and pawn ending keeps the win" )
+{
+    FenParser parser { "4k3/8/4K3/4P3/8/8/8/8 w - - 0 1" };
+    auto game = parser.build();
+
+    SearchHelper helper;
+    auto search = helper.build (game.getBoard(), 6);
+    auto result = search.iterativelyDeepen (Color::White);
+
+    REQUIRE( result.move.has_value() );
+    CHECK( result.score > Known_Win_Score );
+}
+
+TEST_CASE( "A node limited search comes out the same every time" )
+{
+    FenParser parser { "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1" };
+    auto game = parser.build();
+    constexpr int64_t Node_Limit = 20000;
+
+    auto search_with_limit = [&]
+    {
+        SearchHelper helper;
+        auto search = helper.build (game.getBoard(), Default_Max_Depth);
+        search.setNodeLimit (Node_Limit);
+        auto result = search.iterativelyDeepen (Color::White);
+        return std::pair { result.move, search.getNodesVisited() };
+    };
+
+    auto [first_move, first_nodes] = search_with_limit();
+    auto [second_move, second_nodes] = search_with_limit();
+
+    REQUIRE( first_move.has_value() );
+    CHECK( first_move == second_move );
+    CHECK( first_nodes == second_nodes );
+    CHECK( first_nodes <= Node_Limit );
+}
+
+TEST_CASE( "Searching only some moves picks one of them" )
+{
+    // Taking the queen is the best move, but it isn't allowed.
+    FenParser parser { "4k3/8/8/3q4/8/8/3R4/4K3 w - - 0 1" };
+    auto game = parser.build();
+
+    SearchHelper helper;
+    auto search = helper.build (game.getBoard(), 4);
+    auto allowed = vector<Move> {
+        moveParse ("e1f1", Color::White),
+        moveParse ("e1f2", Color::White),
+    };
+    search.setSearchMoves (allowed);
+    auto result = search.iterativelyDeepen (Color::White);
+
+    REQUIRE( result.move.has_value() );
+    CHECK( std::find (allowed.begin(), allowed.end(), *result.move) != allowed.end() );
+}
+
+TEST_CASE( "The listener hears about every depth the search finishes" )
+{
+    struct RecordingListener : SearchListener
+    {
+        vector<SearchStats> iterations;
+        vector<RootMoveStats> root_moves;
+
+        void iterationFinished (const SearchStats& stats) override
+        {
+            iterations.push_back (stats);
+        }
+
+        void rootMoveStarted (const RootMoveStats& stats) override
+        {
+            root_moves.push_back (stats);
+        }
+    };
+
+    auto board = Board {};
+    auto listener = make_shared<RecordingListener>();
+
+    SearchHelper helper;
+    auto search = helper.build (board, 4);
+    search.setListener (listener);
+    auto result = search.iterativelyDeepen (Color::White);
+
+    REQUIRE( result.move.has_value() );
+    REQUIRE( listener->iterations.size() == 4 );
+
+    for (int i = 0; i < 4; i++)
+    {
+        const auto& stats = listener->iterations[i];
+        CHECK( stats.depth == i + 1 );
+        CHECK( stats.selective_depth >= stats.depth );
+        CHECK( !stats.principal_variation.empty() );
+        CHECK( narrow<int> (stats.principal_variation.size()) <= stats.depth );
+        if (i > 0)
+            CHECK( stats.nodes > listener->iterations[i - 1].nodes );
+    }
+
+    const auto& last = listener->iterations.back();
+    CHECK( last.principal_variation.front() == *result.move );
+    CHECK( last.score == result.score );
+    CHECK( last.nodes == search.getNodesVisited() );
+
+    // Every move at the root is searched at every depth without a cutoff.
+    CHECK( listener->root_moves.size() == 4 * 20 );
+    CHECK( listener->root_moves.front().move_number == 1 );
+    CHECK( listener->root_moves.back().move_number == 20 );
+}
+
+TEST_CASE( "The principal variation is a legal line starting with the best move" )
+{
+    FenParser parser { "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1" };
+    auto board = parser.buildBoard();
+
+    SearchHelper helper;
+    auto search = helper.build (board, 4);
+    auto result = search.iterativelyDeepen (Color::White);
+
+    REQUIRE( result.move.has_value() );
+    REQUIRE( !result.principal_variation.empty() );
+    CHECK( result.principal_variation.front() == *result.move );
+    CHECK( result.principal_variation.size() <= 4 );
+
+    auto side = Color::White;
+    for (auto move : result.principal_variation)
+    {
+        auto legal_moves = generateLegalMoves (board, side);
+        REQUIRE( std::find (legal_moves.begin(), legal_moves.end(), move) != legal_moves.end() );
+        board = board.withMove (side, move);
+        side = colorInvert (side);
+    }
+}
+
+TEST_CASE( "The root move list keeps the best move first" )
+{
+    auto board = Board {};
+
+    SUBCASE( "Every legal move is searched, and the best one is first" )
+    {
+        SearchHelper helper;
+        auto search = helper.build (board, 4);
+        auto result = search.iterativelyDeepen (Color::White);
+
+        auto root_moves = search.getRootMoves();
+        REQUIRE( root_moves.size() == 20 );
+        CHECK( root_moves.front().move == *result.move );
+        CHECK( root_moves.front().score == result.score );
+
+        for (const auto& root_move : root_moves)
+        {
+            CHECK( root_move.nodes > 0 );
+            CHECK( root_move.score <= result.score );
+        }
+
+        // After the best move, the others are in order of their node counts.
+        CHECK( std::is_sorted (root_moves.begin() + 1, root_moves.end(),
+            [] (const RootMove& first, const RootMove& second) { return first.nodes > second.nodes; }) );
+    }
+
+    SUBCASE( "Search moves restrict the list" )
+    {
+        SearchHelper helper;
+        auto search = helper.build (board, 3);
+        search.setSearchMoves ({ moveParse ("a2a3", Color::White), moveParse ("h2h3", Color::White) });
+        auto result = search.iterativelyDeepen (Color::White);
+
+        auto root_moves = search.getRootMoves();
+        REQUIRE( root_moves.size() == 2 );
+        CHECK( root_moves.front().move == *result.move );
+    }
+}
+
+TEST_CASE( "MultiPV finds the best few moves in order" )
+{
+    struct LineListener : SearchListener
+    {
+        vector<SearchStats> lines;
+
+        void iterationFinished (const SearchStats& stats) override
+        {
+            lines.push_back (stats);
+        }
+
+        void rootMoveStarted (const RootMoveStats&) override {}
+    };
+
+    // Mating with the rook is best, but the other moves still get lines.
+    FenParser parser { "6k1/5ppp/8/8/8/8/5PPP/R5K1 w - - 0 1" };
+    auto board = parser.buildBoard();
+    auto listener = make_shared<LineListener>();
+
+    SearchHelper helper;
+    auto search = helper.build (board, 3);
+    search.setMultiPv (3);
+    search.setListener (listener);
+    auto result = search.iterativelyDeepen (Color::White);
+
+    REQUIRE( result.move.has_value() );
+    CHECK( *result.move == moveParse ("a1a8", Color::White) );
+
+    auto root_moves = search.getRootMoves();
+    REQUIRE( root_moves.size() > 3 );
+    CHECK( root_moves[0].move == *result.move );
+    CHECK( root_moves[0].score >= root_moves[1].score );
+    CHECK( root_moves[1].score >= root_moves[2].score );
+    CHECK( root_moves[1].move != root_moves[2].move );
+
+    // The search stops at the first depth once it finds the mate.
+    REQUIRE( listener->lines.size() == 3 );
+    for (int line = 0; line < 3; line++)
+    {
+        CHECK( listener->lines[line].multi_pv == line + 1 );
+        CHECK( listener->lines[line].principal_variation.front() == root_moves[line].move );
+        CHECK( listener->lines[line].score == root_moves[line].score );
+    }
+}
@@ -0,0 +1,101 @@
+#include <atomic>
+#include <thread>
+
+#include "wisdom-chess/engine/fen_parser.hpp"
+#include "wisdom-chess/engine/history.hpp"
+#include "wisdom-chess/engine/logger.hpp"
+#include "wisdom-chess/engine/search.hpp"
+#include "wisdom-chess/engine/search_worker.hpp"
+#include "wisdom-chess/engine/transposition_table.hpp"
+
+#include "wisdom-chess-tests.hpp"
+
+using namespace wisdom;
+
+TEST_CASE( "Search worker" )
+{
+    SUBCASE( "Runs every job on the same thread" )
+    {
+        SearchWorker worker;
+        vector<std::thread::id> thread_ids;
+
+        for (int i = 0; i < 3; i++)
+        {
+            worker.start ([&] (std::stop_token) { thread_ids.push_back (std::this_thread::get_id()); });
+            worker.wait();
+        }
+
+        REQUIRE( thread_ids.size() == 3 );
+        CHECK( thread_ids[0] != std::this_thread::get_id() );
+        CHECK( thread_ids[1] == thread_ids[0] );
+        CHECK( thread_ids[2] == thread_ids[0] );
+        CHECK( !worker.isBusy() );
+    }
+
+    SUBCASE( "A stop request reaches the running job only" )
+    {
+        SearchWorker worker;
+        std::atomic<bool> started = false;
+
+        worker.start ([&] (std::stop_token stop_token)
+        {
+            started = true;
+            while (!stop_token.stop_requested())
+                std::this_thread::yield();
+        });
+        while (!started)
+            std::this_thread::yield();
+
+        CHECK( worker.isBusy() );
+        worker.requestStop();
+        worker.wait();
+        CHECK( !worker.isBusy() );
+
+        bool next_job_stopped = true;
+        worker.start ([&] (std::stop_token stop_token) { next_job_stopped = stop_token.stop_requested(); });
+        worker.wait();
+        CHECK( !next_job_stopped );
+    }
+
+    SUBCASE( "Destroying the worker stops its job" )
+    {
+        std::atomic<bool> stopped = false;
+        {
+            SearchWorker worker;
+            worker.start ([&] (std::stop_token stop_token)
+            {
+                while (!stop_token.stop_requested())
+                    std::this_thread::yield();
+                stopped = true;
+            });
+        }
+
+        CHECK( stopped );
+    }
+}
+
+TEST_CASE( "A search can run on a different thread from the one that created it" )
+{
+    FenParser parser { "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1" };
+    auto board = parser.buildBoard();
+    auto history = History::fromInitialBoard (board);
+    auto logger = makeNullLogger();
+    MoveTimer timer { 30 };
+
+    auto local_table = TranspositionTable::fromMegabytes (1);
+    auto local_search = IterativeSearch::create (board, history, logger, timer, 3, local_table);
+    auto expected = local_search.iterativelyDeepen (Color::White);
+
+    auto worker_table = TranspositionTable::fromMegabytes (1);
+    auto worker_search = IterativeSearch::create (board, history, logger, timer, 3, worker_table);
+    SearchResult result;
+
+    SearchWorker worker;
+    worker.start ([&] (std::stop_token) { result = worker_search.iterativelyDeepen (Color::White); });
+    worker.wait();
+
+    REQUIRE( result.move.has_value() );
+    CHECK( *result.move == *expected.move );
+    CHECK( result.score == expected.score );
+    CHECK( worker_search.getNodesVisited() == local_search.getNodesVisited() );
+}
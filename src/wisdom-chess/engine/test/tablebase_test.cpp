@@ -0,0 +1,262 @@
+#include <filesystem>
+
+#include "wisdom-chess/engine/tablebase.hpp"
+#include "wisdom-chess/engine/tablebase_generator.hpp"
+#include "wisdom-chess/engine/board.hpp"
+#include "wisdom-chess/engine/endgame.hpp"
+#include "wisdom-chess/engine/evaluate.hpp"
+#include "wisdom-chess/engine/fen_parser.hpp"
+#include "wisdom-chess/engine/game.hpp"
+#include "wisdom-chess/engine/history.hpp"
+#include "wisdom-chess/engine/logger.hpp"
+#include "wisdom-chess/engine/search.hpp"
+#include "wisdom-chess/engine/transposition_table.hpp"
+
+#include "wisdom-chess-tests.hpp"
+
+using namespace wisdom;
+
+namespace
+{
+    struct GeneratedTablebase
+    {
+        Tablebase tablebase;
+        std::unordered_map<string, TablebaseGenerationResult> results;
+    };
+
+    // Generating the three piece endings takes a moment, so share them
+    // between the tests.
+    auto
+    threePieceTablebase()
+        -> const GeneratedTablebase&
+    {
+        static const auto result = []
+        {
+            auto generated = make_unique<GeneratedTablebase>();
+            for (const auto& name : tablebaseNames (3))
+            {
+                auto table = generateTablebase (name, generated->tablebase, 2);
+                generated->tablebase.addTable (name, table.values);
+                table.values.clear();
+                generated->results.emplace (name, std::move (table));
+            }
+            return generated;
+        }();
+
+        return *result;
+    }
+
+    auto
+    probeFen (const Tablebase& tablebase, const char* fen)
+        -> optional<TablebaseResult>
+    {
+        FenParser parser { fen };
+        auto game = parser.build();
+        return tablebase.probe (game.getBoard(), parser.getActivePlayer());
+    }
+}
+
+TEST_CASE( "Tablebase layout" )
+{
+    SUBCASE( "Names put the stronger side first" )
+    {
+        auto layout = TablebaseLayout::fromName ("KRvKP");
+        REQUIRE( layout.has_value() );
+        CHECK( layout->name() == "KRvKP" );
+        CHECK( layout->hasPawns() );
+        CHECK( layout->pieces()[2] == ColoredPiece::make (Color::White, Piece::Rook) );
+        CHECK( layout->pieces()[3] == ColoredPiece::make (Color::Black, Piece::Pawn) );
+
+        CHECK( !TablebaseLayout::fromName ("KPvKR").has_value() );
+        CHECK( !TablebaseLayout::fromName ("KQRvKR").has_value() );
+        CHECK( !TablebaseLayout::fromName ("KXvK").has_value() );
+    }
+
+    SUBCASE( "Positions that are reflections of each other share an index" )
+    {
+        auto layout = TablebaseLayout::fromName ("KQvK");
+        REQUIRE( layout.has_value() );
+
+        // Kc2, Ke5, Qh7 and the mirror image Kf2, Kd5, Qa7.
+        array<int, 3> squares = { 50, 28, 15 };
+        array<int, 3> mirrored = { 53, 27, 8 };
+        CHECK( layout->index (squares, Color::White) == layout->index (mirrored, Color::White) );
+        CHECK( layout->index (squares, Color::White) != layout->index (squares, Color::Black) );
+
+        array<int, 3> decoded {};
+        auto index = layout->index (squares, Color::Black);
+        CHECK( layout->decode (index, decoded) == Color::Black );
+        CHECK( layout->index (decoded, Color::Black) == index );
+    }
+
+    SUBCASE( "Captures and promotions only lead to endings earlier in the list" )
+    {
+        auto names = tablebaseNames (3);
+        CHECK( names == vector<string> { "KBvK", "KNvK", "KQvK", "KRvK", "KPvK" } );
+        CHECK( tablebaseNames (4).size() == 35 );
+    }
+}
+
+TEST_CASE( "Generating the three piece tablebases" )
+{
+    const auto& generated = threePieceTablebase();
+
+    SUBCASE( "A queen or a rook always mates unless it's lost right away" )
+    {
+        // The longest mates are ten moves with a queen and sixteen with a
+        // rook, so the side to move loses in at most twenty and thirty two
+        // plies.
+        CHECK( generated.results.at ("KQvK").longest_mate == 20 );
+        CHECK( generated.results.at ("KRvK").longest_mate == 32 );
+        CHECK( generated.results.at ("KQvK").wins > 0 );
+    }
+
+    SUBCASE( "A lone bishop or knight can't mate" )
+    {
+        for (const auto* name : { "KBvK", "KNvK" })
+        {
+            CHECK( generated.results.at (name).wins == 0 );
+            CHECK( generated.results.at (name).losses == 0 );
+        }
+    }
+
+    SUBCASE( "King and pawn against king agrees with the bitbase" )
+    {
+        auto white_pawn = ColoredPiece::make (Color::White, Piece::Pawn);
+        array<ColoredPiece, 3> pieces = {
+            ColoredPiece::make (Color::White, Piece::King),
+            ColoredPiece::make (Color::Black, Piece::King),
+            white_pawn,
+        };
+
+        int mismatches = 0;
+        int positions = 0;
+        for (int pawn = Num_Columns; pawn < Num_Squares - Num_Columns; pawn++)
+        {
+            for (int white_king = 0; white_king < Num_Squares; white_king++)
+            {
+                for (int black_king = 0; black_king < Num_Squares; black_king++)
+                {
+                    auto white_king_coord = Coord::fromIndex (white_king);
+                    auto black_king_coord = Coord::fromIndex (black_king);
+                    auto pawn_coord = Coord::fromIndex (pawn);
+
+                    auto row_distance = std::abs (white_king_coord.row<int>() - black_king_coord.row<int>());
+                    auto col_distance = std::abs (white_king_coord.column<int>() - black_king_coord.column<int>());
+                    if (white_king == pawn || black_king == pawn || std::max (row_distance, col_distance) <= 1)
+                        continue;
+
+                    // With white to move, the pawn can't be giving check.
+                    bool in_check = black_king_coord.row<int>() == pawn_coord.row<int>() - 1
+                        && std::abs (black_king_coord.column<int>() - pawn_coord.column<int>()) == 1;
+
+                    for (auto who : { Color::White, Color::Black })
+                    {
+                        if (who == Color::White && in_check)
+                            continue;
+
+                        array<int, 3> squares = { white_king, black_king, pawn };
+                        auto result = generated.tablebase.probe (pieces, squares, who);
+                        REQUIRE( result.has_value() );
+
+                        bool tablebase_win = result->outcome != TablebaseOutcome::Draw;
+                        bool bitbase_win = isKingPawnVsKingWin (
+                            white_king_coord, pawn_coord, black_king_coord, Color::White, who
+                        );
+                        mismatches += tablebase_win != bitbase_win;
+                        positions++;
+                    }
+                }
+            }
+        }
+
+        CHECK( positions > 300000 );
+        CHECK( mismatches == 0 );
+    }
+}
+
+TEST_CASE( "Probing the tablebase" )
+{
+    const auto& tablebase = threePieceTablebase().tablebase;
+
+    SUBCASE( "Finds a mate in one and the checkmate itself" )
+    {
+        auto mate_in_one = probeFen (tablebase, "k7/8/1K6/8/8/8/7Q/8 w - - 0 1");
+        CHECK( mate_in_one == TablebaseResult { TablebaseOutcome::Win, 1 } );
+
+        auto checkmated = probeFen (tablebase, "k6Q/8/1K6/8/8/8/8/8 b - - 0 1");
+        CHECK( checkmated == TablebaseResult { TablebaseOutcome::Loss, 0 } );
+    }
+
+    SUBCASE( "Looks up black's material with the colors reversed" )
+    {
+        auto mate_in_one = probeFen (tablebase, "8/8/8/8/8/1k6/7q/K7 b - - 0 1");
+        CHECK( mate_in_one == TablebaseResult { TablebaseOutcome::Win, 1 } );
+    }
+
+    SUBCASE( "Doesn't know endings it doesn't have tables for" )
+    {
+        CHECK( !probeFen (tablebase, "k7/8/1K6/8/8/8/8/5QR1 w - - 0 1").has_value() );
+        CHECK( probeFen (tablebase, "k7/8/1K6/8/8/8/8/8 w - - 0 1") == TablebaseResult {} );
+    }
+
+    SUBCASE( "Gives the same results after a round trip through a file" )
+    {
+        auto directory = std::filesystem::temp_directory_path() / "wisdom-chess-tablebase-test";
+        std::filesystem::create_directories (directory);
+
+        auto layout = TablebaseLayout::fromName ("KQvK");
+        REQUIRE( layout.has_value() );
+        vector<uint8_t> values ( layout->size() );
+        for (size_t index = 0; index < values.size(); index++)
+        {
+            array<int, 3> squares {};
+            auto who = layout->decode (index, squares);
+            array<ColoredPiece, 3> pieces {};
+            std::copy (layout->pieces().begin(), layout->pieces().end(), pieces.begin());
+            values[index] = encodeTablebaseResult (tablebase.probe (pieces, squares, who).value());
+        }
+
+        writeTablebaseFile ((directory / "KQvK.wtb").string(), "KQvK", values);
+        auto loaded = Tablebase::open (directory.string());
+        std::filesystem::remove_all (directory);
+
+        CHECK( loaded->hasTable ("KQvK") );
+        CHECK( loaded->maxPieces() == 3 );
+        CHECK( probeFen (*loaded, "k7/8/1K6/8/8/8/7Q/8 w - - 0 1") == TablebaseResult { TablebaseOutcome::Win, 1 } );
+        CHECK( probeFen (*loaded, "8/8/8/3k4/8/8/1K6/7Q b - - 0 1")
+               == probeFen (tablebase, "8/8/8/3k4/8/8/1K6/7Q b - - 0 1") );
+    }
+
+    SUBCASE( "Opening a missing directory is an error" )
+    {
+        CHECK_THROWS_AS( (void)Tablebase::open ("/nonexistent/wisdom-chess-tablebases"), TablebaseFileError );
+    }
+}
+
+TEST_CASE( "Searching with a tablebase picks the fastest mate without searching" )
+{
+    const auto& tablebase = threePieceTablebase().tablebase;
+
+    FenParser parser { "8/8/8/3k4/8/8/1K6/7R w - - 0 1" };
+    auto board = parser.buildBoard();
+    auto history = History::fromInitialBoard (board);
+    MoveTimer timer { 30 };
+    auto table = TranspositionTable::fromMegabytes (1);
+
+    auto expected = tablebase.probe (board, Color::White);
+    REQUIRE( expected.has_value() );
+    REQUIRE( expected->outcome == TablebaseOutcome::Win );
+
+    auto search = IterativeSearch::create (board, history, makeNullLogger(), timer, 3, table);
+    search.setTablebase (&tablebase);
+    auto result = search.iterativelyDeepen (Color::White);
+
+    REQUIRE( result.move.has_value() );
+    CHECK( result.score == checkmateScoreInMoves (expected->plies) );
+    CHECK( search.getNodesVisited() == 0 );
+
+    auto child_result = tablebase.probe (board.withMove (Color::White, *result.move), Color::Black);
+    REQUIRE( child_result.has_value() );
+    CHECK( *child_result == TablebaseResult { TablebaseOutcome::Loss, expected->plies - 1 } );
+}
@@ -0,0 +1,138 @@
+#include "wisdom-chess/engine/move.hpp"
+#include "wisdom-chess/engine/time_manager.hpp"
+
+#include "wisdom-chess-tests.hpp"
+
+using namespace wisdom;
+
+namespace
+{
+    using chrono::milliseconds;
+
+    auto
+    sampleMove (const char* move)
+        -> Move
+    {
+        return moveParse (move, Color::White);
+    }
+}
+
+TEST_CASE( "Allocating time for a move" )
+{
+    SUBCASE( "Spreads sudden death time over the default number of moves" )
+    {
+        auto budget = allocateTime ({ .time_remaining = milliseconds { 60'030 } });
+        CHECK( budget.optimum == milliseconds { 60'000 / Default_Moves_To_Go } );
+        CHECK( budget.maximum == budget.optimum * Max_Time_Factor );
+    }
+
+    SUBCASE( "Uses the moves left until the time control" )
+    {
+        auto few_moves = allocateTime ({ .time_remaining = milliseconds { 10'030 }, .moves_to_go = 5 });
+        CHECK( few_moves.optimum == milliseconds { 2'000 } );
+        CHECK( few_moves.maximum == milliseconds { 2'500 } );
+
+        auto last_move = allocateTime ({ .time_remaining = milliseconds { 10'030 }, .moves_to_go = 1 });
+        CHECK( last_move.optimum == milliseconds { 8'000 } );
+        CHECK( last_move.maximum == milliseconds { 8'000 } );
+    }
+
+    SUBCASE( "Adds the increment" )
+    {
+        auto budget = allocateTime ({ .time_remaining = milliseconds { 60'030 }, .increment = milliseconds { 500 } });
+        CHECK( budget.optimum == milliseconds { 2'500 } );
+    }
+
+    SUBCASE( "Never spends more than is left on the clock" )
+    {
+        for (auto remaining : { 0, 1, 20, 100, 1'000 })
+        {
+            auto budget = allocateTime ({
+                .time_remaining = milliseconds { remaining },
+                .increment = milliseconds { 5'000 },
+                .moves_to_go = 1,
+            });
+            CHECK( budget.optimum >= milliseconds { 1 } );
+            CHECK( budget.optimum <= budget.maximum );
+            CHECK( budget.maximum <= std::max (milliseconds { remaining }, milliseconds { 1 }) );
+        }
+    }
+}
+
+TEST_CASE( "Managing time during a search" )
+{
+    const TimeBudget budget { milliseconds { 1'000 }, milliseconds { 4'000 } };
+
+    SUBCASE( "A stable best move gets less time" )
+    {
+        TimeManager manager { budget };
+        for (int iteration = 1; iteration <= 6; iteration++)
+            manager.iterationFinished (sampleMove ("e2e4"), 50, milliseconds { iteration });
+
+        CHECK( manager.targetTime() == milliseconds { 500 } );
+    }
+
+    SUBCASE( "A changing best move gets more time" )
+    {
+        TimeManager manager { budget };
+        manager.iterationFinished (sampleMove ("e2e4"), 50, milliseconds { 1 });
+        manager.iterationFinished (sampleMove ("d2d4"), 50, milliseconds { 2 });
+
+        CHECK( manager.targetTime() == milliseconds { 1'500 } );
+    }
+
+    SUBCASE( "A falling score gets more time, up to the maximum" )
+    {
+        TimeManager manager { budget };
+        manager.iterationFinished (sampleMove ("e2e4"), 400, milliseconds { 1 });
+        manager.iterationFinished (sampleMove ("e2e4"), 0, milliseconds { 2 });
+        manager.iterationFinished (sampleMove ("e2e4"), 0, milliseconds { 3 });
+        CHECK( manager.targetTime() > milliseconds { 1'000 } );
+
+        manager.iterationFinished (sampleMove ("d2d4"), -1'000, milliseconds { 4 });
+        manager.iterationFinished (sampleMove ("e2e4"), -2'000, milliseconds { 5 });
+        CHECK( manager.targetTime() <= budget.maximum );
+        CHECK( manager.targetTime() > milliseconds { 2'000 } );
+    }
+
+    SUBCASE( "Predicts the next iteration from the branching factor" )
+    {
+        TimeManager manager { budget };
+        manager.iterationFinished (sampleMove ("e2e4"), 50, milliseconds { 10 });
+        manager.iterationFinished (sampleMove ("e2e4"), 50, milliseconds { 40 });
+        CHECK( manager.predictedIterationTime() == milliseconds { 90 } );
+    }
+
+    SUBCASE( "Keeps going past the optimum while the best move is unsettled" )
+    {
+        TimeManager manager { budget };
+        manager.iterationFinished (sampleMove ("e2e4"), 50, milliseconds { 100 });
+        manager.iterationFinished (sampleMove ("d2d4"), 50, milliseconds { 400 });
+
+        CHECK( manager.shouldStartIteration (milliseconds { 1'100 }) );
+    }
+
+    SUBCASE( "Doesn't start an iteration that won't finish" )
+    {
+        TimeManager manager { budget };
+        manager.iterationFinished (sampleMove ("e2e4"), 50, milliseconds { 100 });
+        manager.iterationFinished (sampleMove ("d2d4"), 50, milliseconds { 800 });
+
+        // The next iteration should take about 700 * 7 = 4900ms, past the
+        // maximum.
+        CHECK( !manager.shouldStartIteration (milliseconds { 900 }) );
+    }
+
+    SUBCASE( "Stops early with a settled best move" )
+    {
+        TimeManager manager { budget };
+        manager.iterationFinished (sampleMove ("e2e4"), 50, milliseconds { 10 });
+        manager.iterationFinished (sampleMove ("e2e4"), 50, milliseconds { 40 });
+        manager.iterationFinished (sampleMove ("e2e4"), 50, milliseconds { 200 });
+
+        // The next iteration should take about 160 * 5.3 = 850ms, which
+        // would finish past the 800ms target.
+        CHECK( manager.targetTime() == milliseconds { 800 } );
+        CHECK( !manager.shouldStartIteration (milliseconds { 200 }) );
+    }
+}
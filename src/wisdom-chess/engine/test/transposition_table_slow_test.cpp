@@ -0,0 +1,198 @@
+#include <chrono>
+
+#ifndef _WIN32
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#include "wisdom-chess/engine/game.hpp"
+#include "wisdom-chess/engine/logger.hpp"
+#include "wisdom-chess/engine/transposition_table.hpp"
+
+#include "wisdom-chess-tests.hpp"
+
+using namespace wisdom;
+
+namespace
+{
+    constexpr int Large_Table_Size_In_Megabytes = 1024;
+
+    auto
+    elapsedMilliseconds (chrono::steady_clock::time_point start)
+        -> double
+    {
+        auto end = chrono::steady_clock::now();
+        return chrono::duration<double, std::milli> (end - start).count();
+    }
+
+    constexpr int Num_Stress_Processes = 4;
+    constexpr int Keys_Per_Process = 25'000;
+    constexpr int Stress_Rounds = 8;
+    constexpr int Stress_Table_Size_In_Megabytes = 8;
+
+    // Exit codes from the child processes.
+    constexpr int Child_Ok = 0;
+    constexpr int Child_Corrupt_Entry = 1;
+    constexpr int Child_Attach_Failed = 2;
+
+    // Spread the keys over the whole table. Never zero, since that's empty.
+    auto
+    stressHash (int key)
+        -> BoardHashCode
+    {
+        auto result = static_cast<uint64_t> (key + 1) * 0x9e37'79b9'7f4a'7c15ULL;
+        result ^= result >> 31;
+        return result | 1;
+    }
+
+    // The score and move stored for a key, so readers can tell whether an
+    // entry they find belongs to the key they looked up.
+    auto
+    stressScore (int key)
+        -> int
+    {
+        return (key % 20'000) - 10'000;
+    }
+
+    auto
+    stressMove (int key)
+        -> Move
+    {
+        return Move::make (key % 8, (key / 8) % 8, (key / 64) % 8, (key / 512) % 8);
+    }
+
+#ifndef _WIN32
+    // Repeatedly store this process's keys, while probing every process's
+    // keys and checking that nothing found belongs to a different key.
+    auto
+    runStressProcess (const string& name, int process_index)
+        -> int
+    {
+        TranspositionTable table = TranspositionTable::fromEntries (2);
+        try
+        {
+            table.attachSharedMemory (name, Stress_Table_Size_In_Megabytes);
+        }
+        catch (const TranspositionTableFileError&)
+        {
+            return Child_Attach_Failed;
+        }
+
+        int first_key = process_index * Keys_Per_Process;
+        int total_keys = Num_Stress_Processes * Keys_Per_Process;
+
+        for (int round = 0; round < Stress_Rounds; round++)
+        {
+            for (int key = first_key; key < first_key + Keys_Per_Process; key++)
+            {
+                table.store (
+                    stressHash (key),
+                    stressScore (key),
+                    round,
+                    BoundType::Exact,
+                    stressMove (key),
+                    0
+                );
+            }
+
+            for (int key = 0; key < total_keys; key++)
+            {
+                auto score = table.probe (stressHash (key), 0, -Initial_Alpha, Initial_Alpha, 0);
+                if (score.has_value() && *score != stressScore (key))
+                    return Child_Corrupt_Entry;
+
+                auto move = table.getBestMove (stressHash (key));
+                if (move.has_value() && *move != stressMove (key))
+                    return Child_Corrupt_Entry;
+            }
+        }
+
+        return Child_Ok;
+    }
+#endif
+}
+
+TEST_CASE( "Searching a copy of a game with a large transposition table" )
+{
+    Game game = Game::createStandardGame();
+    game.setTranspositionTableSize (Large_Table_Size_In_Megabytes);
+    game.setMaxDepth (1);
+
+    SUBCASE( "Copying the game does not copy the table" )
+    {
+        // This mirrors what the UCI interface does on every "go" command.
+        auto start = chrono::steady_clock::now();
+        Game game_copy = game;
+        auto copy_time = elapsedMilliseconds (start);
+
+        MESSAGE( "Copy time with " << Large_Table_Size_In_Megabytes << " MB table: "
+                 << copy_time << " ms" );
+        CHECK( game_copy.sharesTranspositionTableWith (game) );
+        CHECK( copy_time < 10.0 );
+    }
+
+    SUBCASE( "Go response time stays low" )
+    {
+        auto start = chrono::steady_clock::now();
+        Game game_copy = game;
+        auto best_move = game_copy.findBestMove (makeNullLogger());
+        auto response_time = elapsedMilliseconds (start);
+
+        MESSAGE( "Depth 1 response time with " << Large_Table_Size_In_Megabytes << " MB table: "
+                 << response_time << " ms" );
+        CHECK( best_move.has_value() );
+        CHECK( response_time < 100.0 );
+    }
+}
+
+#ifndef _WIN32
+TEST_CASE( "Shared memory transposition table with several processes" )
+{
+    string name = "wisdom-chess-stress-test-" + std::to_string (::getpid());
+    TranspositionTable::removeSharedMemory (name);
+
+    // Create the segment up front, so the children race on its entries
+    // rather than on creating it.
+    TranspositionTable table = TranspositionTable::fromEntries (2);
+    table.attachSharedMemory (name, Stress_Table_Size_In_Megabytes);
+
+    vector<pid_t> children;
+    for (int i = 0; i < Num_Stress_Processes; i++)
+    {
+        pid_t pid = ::fork();
+        REQUIRE( pid >= 0 );
+        if (pid == 0)
+            ::_exit (runStressProcess (name, i));
+        children.push_back (pid);
+    }
+
+    for (auto pid : children)
+    {
+        int status = 0;
+        REQUIRE( ::waitpid (pid, &status, 0) == pid );
+        REQUIRE( WIFEXITED (status) );
+        CHECK( WEXITSTATUS (status) == Child_Ok );
+    }
+
+    // Every key was stored by one of the other processes, so everything
+    // found here came through the shared segment.
+    int total_keys = Num_Stress_Processes * Keys_Per_Process;
+    int hits = 0;
+    for (int key = 0; key < total_keys; key++)
+    {
+        auto score = table.probe (stressHash (key), 0, -Initial_Alpha, Initial_Alpha, 0);
+        if (score.has_value())
+        {
+            CHECK( *score == stressScore (key) );
+            hits++;
+        }
+    }
+
+    auto hit_rate = 100.0 * hits / total_keys;
+    MESSAGE( "Shared table hit rate after " << Num_Stress_Processes << " processes: "
+             << hit_rate << "%" );
+    CHECK( hit_rate > 80.0 );
+
+    TranspositionTable::removeSharedMemory (name);
+}
+#endif
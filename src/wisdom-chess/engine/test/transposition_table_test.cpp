@@ -8,8 +8,14 @@
 #include "wisdom-chess-tests.hpp"
 
 #include <bitset>
+#include <filesystem>
+#include <fstream>
 #include <unordered_set>
 
+#ifndef _WIN32
+#include <unistd.h>
+#endif
+
 using namespace wisdom;
 
 TEST_CASE( "Transposition table" )
@@ -227,6 +233,41 @@ TEST_CASE( "Transposition table" )
         CHECK( !result.has_value() );
     }
 
+    SUBCASE( "copies have their own entries" )
+    {
+        TranspositionTable tt = TranspositionTable::fromMegabytes (1);
+
+        BoardHashCode hash = 12345678ULL;
+        tt.store (hash, 100, 5, BoundType::Exact, Move::make (0, 0, 1, 1), 0);
+
+        TranspositionTable copy { tt };
+        tt.clear();
+
+        auto result = copy.probe (hash, 5, -Initial_Alpha, Initial_Alpha, 0);
+        REQUIRE( result.has_value() );
+        CHECK( *result == 100 );
+        CHECK( copy.getStoredEntriesCount() == 1 );
+        CHECK( tt.getStoredEntriesCount() == 0 );
+    }
+
+    SUBCASE( "resize changes the size and resets the table" )
+    {
+        TranspositionTable tt = TranspositionTable::fromMegabytes (1);
+        auto original_size = tt.getSize();
+
+        BoardHashCode hash = 12345678ULL;
+        tt.store (hash, 100, 5, BoundType::Exact, Move::make (0, 0, 1, 1), 0);
+
+        tt.resize (4);
+
+        CHECK( tt.getSizeInMegabytes() == 4 );
+        CHECK( tt.getSize() == original_size * 4 );
+        CHECK( tt.getStoredEntriesCount() == 0 );
+
+        auto result = tt.probe (hash, 5, -Initial_Alpha, Initial_Alpha, 0);
+        CHECK( !result.has_value() );
+    }
+
     SUBCASE( "tracks hit and probe counts" )
     {
         TranspositionTable tt = TranspositionTable::fromMegabytes (1);
@@ -247,6 +288,195 @@ TEST_CASE( "Transposition table" )
     }
 }
 
+TEST_CASE( "Transposition table files" )
+{
+    auto path = (std::filesystem::temp_directory_path() / "wisdom-chess-tt-test.hash").string();
+    BoardHashCode hash = 12345678ULL;
+
+    SUBCASE( "a saved table can be loaded again" )
+    {
+        TranspositionTable tt = TranspositionTable::fromMegabytes (1);
+        tt.store (hash, 100, 5, BoundType::Exact, Move::make (0, 0, 1, 1), 0);
+        tt.saveTo (path);
+
+        TranspositionTable loaded = TranspositionTable::fromMegabytes (2);
+        loaded.loadFrom (path);
+
+        CHECK( loaded.getSize() == tt.getSize() );
+        CHECK( loaded.getSizeInMegabytes() == 1 );
+        CHECK( loaded.getStoredEntriesCount() == 1 );
+        CHECK( loaded.getGeneration() == 1 );
+
+        auto result = loaded.probe (hash, 5, -Initial_Alpha, Initial_Alpha, 0);
+        REQUIRE( result.has_value() );
+        CHECK( *result == 100 );
+
+        auto best_move = loaded.getBestMove (hash);
+        REQUIRE( best_move.has_value() );
+        CHECK( *best_move == Move::make (0, 0, 1, 1) );
+    }
+
+    SUBCASE( "changes to a loaded table don't change the file" )
+    {
+        TranspositionTable tt = TranspositionTable::fromMegabytes (1);
+        tt.store (hash, 100, 5, BoundType::Exact, Move::make (0, 0, 1, 1), 0);
+        tt.saveTo (path);
+
+        TranspositionTable loaded = TranspositionTable::fromMegabytes (1);
+        loaded.loadFrom (path);
+        loaded.clear();
+
+        TranspositionTable reloaded = TranspositionTable::fromMegabytes (1);
+        reloaded.loadFrom (path);
+
+        auto result = reloaded.probe (hash, 5, -Initial_Alpha, Initial_Alpha, 0);
+        REQUIRE( result.has_value() );
+        CHECK( *result == 100 );
+    }
+
+    SUBCASE( "the generation increases each time the table is saved" )
+    {
+        TranspositionTable tt = TranspositionTable::fromMegabytes (1);
+        tt.saveTo (path);
+
+        TranspositionTable loaded = TranspositionTable::fromMegabytes (1);
+        loaded.loadFrom (path);
+        loaded.saveTo (path);
+        loaded.loadFrom (path);
+
+        CHECK( loaded.getGeneration() == 2 );
+
+        loaded.clear();
+        CHECK( loaded.getGeneration() == 0 );
+    }
+
+    SUBCASE( "invalid files are rejected and leave the table unchanged" )
+    {
+        TranspositionTable tt = TranspositionTable::fromMegabytes (1);
+        tt.store (hash, 100, 5, BoundType::Exact, Move::make (0, 0, 1, 1), 0);
+        tt.saveTo (path);
+
+        auto original_size = std::filesystem::file_size (path);
+        std::filesystem::resize_file (path, original_size - 1);
+
+        TranspositionTable other = TranspositionTable::fromMegabytes (2);
+        other.store (hash, 200, 5, BoundType::Exact, Move::make (0, 0, 1, 1), 0);
+        CHECK_THROWS_AS( other.loadFrom (path), TranspositionTableFileError );
+
+        {
+            std::ofstream garbage { path, std::ios::binary | std::ios::trunc };
+            garbage << "not a transposition table";
+        }
+        CHECK_THROWS_AS( other.loadFrom (path), TranspositionTableFileError );
+
+        CHECK_THROWS_AS( other.loadFrom (path + ".missing"), TranspositionTableFileError );
+
+        CHECK( other.getSizeInMegabytes() == 2 );
+        auto result = other.probe (hash, 5, -Initial_Alpha, Initial_Alpha, 0);
+        REQUIRE( result.has_value() );
+        CHECK( *result == 200 );
+    }
+
+    std::filesystem::remove (path);
+}
+
+TEST_CASE( "Transposition entry packing" )
+{
+    SUBCASE( "entries round trip through the data word" )
+    {
+        TranspositionData data {
+            .best_move = Move::make (1, 2, 3, 4),
+            .score = -Checkmate_Score,
+            .depth = 12,
+            .bound_type = BoundType::UpperBound,
+        };
+
+        auto unpacked = unpackTranspositionData (packTranspositionData (data));
+
+        CHECK( unpacked.best_move == data.best_move );
+        CHECK( unpacked.score == data.score );
+        CHECK( unpacked.depth == data.depth );
+        CHECK( unpacked.bound_type == data.bound_type );
+    }
+
+    SUBCASE( "depths too deep to store are stored as the maximum depth" )
+    {
+        TranspositionData data { .depth = 1000 };
+
+        auto unpacked = unpackTranspositionData (packTranspositionData (data));
+
+        CHECK( unpacked.depth == Max_Transposition_Depth );
+    }
+}
+
+#ifndef _WIN32
+TEST_CASE( "Shared memory transposition tables" )
+{
+    string name = "wisdom-chess-shared-test-" + std::to_string (::getpid());
+    BoardHashCode hash = 12345678ULL;
+
+    TranspositionTable::removeSharedMemory (name);
+
+    SUBCASE( "entries stored by one table are seen by another" )
+    {
+        TranspositionTable first = TranspositionTable::fromMegabytes (1);
+        first.attachSharedMemory (name, 1);
+
+        TranspositionTable second = TranspositionTable::fromMegabytes (1);
+        second.attachSharedMemory (name, 1);
+
+        CHECK( first.isShared() );
+        CHECK( second.isShared() );
+
+        first.store (hash, 100, 5, BoundType::Exact, Move::make (0, 0, 1, 1), 0);
+
+        auto result = second.probe (hash, 5, -Initial_Alpha, Initial_Alpha, 0);
+        REQUIRE( result.has_value() );
+        CHECK( *result == 100 );
+    }
+
+    SUBCASE( "later tables use the size the segment was created with" )
+    {
+        TranspositionTable first = TranspositionTable::fromMegabytes (1);
+        first.attachSharedMemory (name, 2);
+
+        TranspositionTable second = TranspositionTable::fromMegabytes (1);
+        second.attachSharedMemory (name, 8);
+
+        CHECK( second.getSizeInMegabytes() == 2 );
+        CHECK( second.getSize() == first.getSize() );
+    }
+
+    SUBCASE( "clearing a shared table keeps its entries" )
+    {
+        TranspositionTable first = TranspositionTable::fromMegabytes (1);
+        first.attachSharedMemory (name, 1);
+        first.store (hash, 100, 5, BoundType::Exact, Move::make (0, 0, 1, 1), 0);
+        first.clear();
+
+        auto result = first.probe (hash, 5, -Initial_Alpha, Initial_Alpha, 0);
+        CHECK( result.has_value() );
+    }
+
+    SUBCASE( "copies and resized tables are private" )
+    {
+        TranspositionTable first = TranspositionTable::fromMegabytes (1);
+        first.attachSharedMemory (name, 1);
+
+        TranspositionTable copy { first };
+        CHECK( !copy.isShared() );
+
+        copy.store (hash, 100, 5, BoundType::Exact, Move::make (0, 0, 1, 1), 0);
+        CHECK( !first.probe (hash, 5, -Initial_Alpha, Initial_Alpha, 0).has_value() );
+
+        first.resize (1);
+        CHECK( !first.isShared() );
+    }
+
+    TranspositionTable::removeSharedMemory (name);
+}
+#endif
+
 TEST_CASE( "Transposition table with real board positions" )
 {
     SUBCASE( "stores and retrieves using actual board hash" )
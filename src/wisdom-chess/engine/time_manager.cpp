@@ -0,0 +1,123 @@
+#include "wisdom-chess/engine/time_manager.hpp"
+
+namespace wisdom
+{
+    using chrono::milliseconds;
+    using chrono::steady_clock;
+
+    // A score falling by this much gives the search half as much time again.
+    static constexpr int Score_Drop_Scale = WeightPawn * Material_Score_Scale;
+
+    // The effective branching factor assumed until there are two iterations
+    // long enough to measure.
+    static constexpr double Default_Branching_Factor = 2.0;
+    static constexpr double Min_Branching_Factor = 1.5;
+    static constexpr double Max_Branching_Factor = 8.0;
+
+    // Iterations shorter than this are too noisy to predict from.
+    static constexpr milliseconds Min_Measured_Iteration { 1 };
+
+    auto
+    allocateTime (const TimeControl& time_control)
+        -> TimeBudget
+    {
+        auto remaining = time_control.time_remaining;
+        auto available = std::max (remaining - Move_Overhead, remaining / 4);
+        available = std::max (available, milliseconds { 1 });
+
+        auto moves_to_go = std::clamp (time_control.moves_to_go.value_or (Default_Moves_To_Go), 1, 50);
+
+        // Don't spend more than a share of the clock on one move unless the
+        // time control is about to end anyway, and even then keep some back.
+        auto optimum = available / moves_to_go + time_control.increment;
+        auto maximum = std::min (optimum * Max_Time_Factor, available / std::min (moves_to_go, 4));
+        maximum = std::min (maximum, available * 4 / 5);
+        maximum = std::max (maximum, milliseconds { 1 });
+        optimum = std::clamp (optimum, milliseconds { 1 }, maximum);
+
+        return { optimum, maximum };
+    }
+
+    void
+    TimeManager::iterationFinished (Move best_move, int score, steady_clock::duration elapsed)
+    {
+        my_earlier_iteration_time = my_previous_iteration_time;
+        my_previous_iteration_time = my_last_iteration_time;
+        my_last_iteration_time = elapsed - my_elapsed;
+        my_elapsed = elapsed;
+
+        my_best_move_changes /= 2;
+        if (my_best_move.has_value() && *my_best_move != best_move)
+        {
+            my_best_move_changes += 1.0;
+            my_stable_iterations = 0;
+        }
+        else if (my_best_move.has_value())
+        {
+            my_stable_iterations++;
+        }
+        my_best_move = best_move;
+
+        // The score from two iterations ago was found with the same side
+        // making the last move.
+        auto& same_parity_score = my_last_scores[1];
+        my_score_drop = same_parity_score.has_value() ? std::max (*same_parity_score - score, 0) : 0;
+        my_last_scores[1] = my_last_scores[0];
+        my_last_scores[0] = score;
+    }
+
+    auto
+    TimeManager::targetTime() const
+        -> milliseconds
+    {
+        double stability = 1.0 - 0.1 * std::min (my_stable_iterations, 5);
+        double instability = 1.0 + 0.5 * std::min (my_best_move_changes, 2.0);
+        double score_drop = 1.0 + 0.5 * std::min (static_cast<double> (my_score_drop) / Score_Drop_Scale, 1.0);
+
+        auto target = milliseconds {
+            static_cast<milliseconds::rep> (my_budget.optimum.count() * stability * instability * score_drop)
+        };
+        return std::clamp (target, milliseconds { 1 }, my_budget.maximum);
+    }
+
+    auto
+    TimeManager::predictedIterationTime() const
+        -> steady_clock::duration
+    {
+        // The branching factor alternates between odd and even depths, so
+        // go by the larger of the last two to avoid starting an iteration
+        // that won't finish.
+        double branching_factor = Default_Branching_Factor;
+        if (my_previous_iteration_time >= Min_Measured_Iteration)
+        {
+            branching_factor = chrono::duration<double> (my_last_iteration_time) / my_previous_iteration_time;
+            if (my_earlier_iteration_time >= Min_Measured_Iteration)
+            {
+                branching_factor = std::max (
+                    branching_factor,
+                    chrono::duration<double> (my_previous_iteration_time) / my_earlier_iteration_time
+                );
+            }
+            branching_factor = std::clamp (branching_factor, Min_Branching_Factor, Max_Branching_Factor);
+        }
+
+        return chrono::duration_cast<steady_clock::duration> (my_last_iteration_time * branching_factor);
+    }
+
+    auto
+    TimeManager::shouldStartIteration (steady_clock::duration elapsed) const
+        -> bool
+    {
+        auto target = targetTime();
+        if (elapsed >= target)
+            return false;
+
+        // An iteration cut off by the timer is thrown away, so starting one
+        // that can't finish only wastes the clock.
+        auto finish = elapsed + predictedIterationTime();
+        if (finish > my_budget.maximum)
+            return false;
+
+        return my_stable_iterations < 2 || finish <= target;
+    }
+}
@@ -0,0 +1,101 @@
+#pragma once
+
+#include "wisdom-chess/engine/global.hpp"
+#include "wisdom-chess/engine/move.hpp"
+
+namespace wisdom
+{
+    // What's known about the clock when a search starts.
+    struct TimeControl
+    {
+        chrono::milliseconds time_remaining { 0 };
+        chrono::milliseconds increment { 0 };
+
+        // Moves left until the next time control, if there is one.
+        optional<int> moves_to_go {};
+    };
+
+    // How long to spend on a move. The search aims for the optimum and is
+    // aborted at the maximum.
+    struct TimeBudget
+    {
+        chrono::milliseconds optimum;
+        chrono::milliseconds maximum;
+    };
+
+    // Time held back on every move for communication delays.
+    inline constexpr chrono::milliseconds Move_Overhead { 30 };
+
+    // How many moves to plan for when the time control doesn't say.
+    inline constexpr int Default_Moves_To_Go = 30;
+
+    // The most the optimum can be stretched by when the search is unsettled.
+    inline constexpr int Max_Time_Factor = 2;
+
+    [[nodiscard]] auto
+    allocateTime (const TimeControl& time_control)
+        -> TimeBudget;
+
+    // Decides when iterative deepening should stop, from how the results of
+    // each iteration change. A best move that keeps changing, or a score
+    // that falls, gets more time. A best move that has stayed the same gets
+    // less.
+    class TimeManager
+    {
+    public:
+        explicit TimeManager (TimeBudget budget)
+            : my_budget { budget }
+        {
+        }
+
+        // Record the result of an iteration that finished, and the total time
+        // searched so far.
+        void iterationFinished (Move best_move, int score, chrono::steady_clock::duration elapsed);
+
+        // How long to search for after adjusting for the results so far.
+        [[nodiscard]] auto
+        targetTime() const
+            -> chrono::milliseconds;
+
+        // The expected time of the next iteration, from the last iteration's
+        // time and the effective branching factor.
+        [[nodiscard]] auto
+        predictedIterationTime() const
+            -> chrono::steady_clock::duration;
+
+        // Whether another iteration is worth starting. It isn't if it
+        // couldn't finish before the maximum, or if the best move is settled
+        // and it would finish past the target.
+        [[nodiscard]] auto
+        shouldStartIteration (chrono::steady_clock::duration elapsed) const
+            -> bool;
+
+        [[nodiscard]] auto
+        getBudget() const
+            -> TimeBudget
+        {
+            return my_budget;
+        }
+
+    private:
+        TimeBudget my_budget;
+
+        optional<Move> my_best_move {};
+        int my_stable_iterations = 0;
+
+        // Count of best move changes, which halves every iteration so that
+        // older changes matter less.
+        double my_best_move_changes = 0.0;
+
+        // The last scores, to compare iterations of the same parity: odd and
+        // even depths end with different sides to move and so tend to
+        // differ.
+        array<optional<int>, 2> my_last_scores {};
+        int my_score_drop = 0;
+
+        chrono::steady_clock::duration my_elapsed {};
+        chrono::steady_clock::duration my_last_iteration_time {};
+        chrono::steady_clock::duration my_previous_iteration_time {};
+        chrono::steady_clock::duration my_earlier_iteration_time {};
+    };
+}
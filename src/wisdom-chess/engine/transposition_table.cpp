@@ -1,8 +1,133 @@
+#include <atomic>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+
+#if !defined(_WIN32) && !defined(EMSCRIPTEN)
+#define WISDOM_CHESS_SHARED_MEMORY_TABLES 1
+#endif
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 #include "wisdom-chess/engine/transposition_table.hpp"
 #include "wisdom-chess/engine/evaluate.hpp"
 
 namespace wisdom
 {
+    // Layout of a saved table: this header, followed by the entries exactly
+    // as they are in memory. The header is padded so the entries that follow
+    // it stay aligned.
+    struct TranspositionFileHeader
+    {
+        char magic[8];
+        uint32_t version;
+        uint32_t entry_size;
+        uint64_t entry_count;
+        uint64_t zobrist_fingerprint;
+        uint64_t generation;
+        uint64_t stored_entries;
+        uint64_t size_in_megabytes;
+        uint64_t reserved;
+    };
+    static_assert (sizeof (TranspositionFileHeader) == 64);
+    static_assert (sizeof (TranspositionFileHeader) % alignof (TranspositionEntry) == 0);
+
+    static constexpr char Transposition_File_Magic[8] = { 'W', 'I', 'S', 'D', 'O', 'M', 'T', 'T' };
+
+    // Increment when the layout of the header or TranspositionEntry changes.
+    static constexpr uint32_t Transposition_File_Version = 2;
+
+    // Header at the start of a shared memory segment, followed by the entries.
+    // The process that creates the segment fills in the header and then sets
+    // the ready word, so others know not to look at the rest until then.
+    struct SharedTableHeader
+    {
+        uint64_t ready;
+        uint32_t version;
+        uint32_t entry_size;
+        uint64_t entry_count;
+        uint64_t zobrist_fingerprint;
+        uint64_t size_in_megabytes;
+        uint64_t reserved[3];
+    };
+    static_assert (sizeof (SharedTableHeader) == 64);
+
+    static constexpr uint64_t Shared_Table_Ready = 0x5749'5344'4f4d'5348; // "WISDOMSH"
+
+    // How long to wait for another process to finish creating a segment.
+    static constexpr auto Shared_Table_Ready_Timeout = std::chrono::seconds { 5 };
+
+    // Tables at least this large are cleared using multiple threads.
+    static constexpr size_t Parallel_Clear_Min_Bytes = 64 * 1024 * 1024;
+    static constexpr unsigned Max_Clear_Threads = 8;
+
+    static void
+    zeroEntries (TranspositionEntry* entries, size_t entry_count)
+    {
+        std::memset (static_cast<void*> (entries), 0, entry_count * sizeof (TranspositionEntry));
+    }
+
+    static void
+    clearEntriesInParallel (TranspositionEntry* entries, size_t entry_count)
+    {
+        auto thread_count = std::min (std::thread::hardware_concurrency(), Max_Clear_Threads);
+        auto total_bytes = entry_count * sizeof (TranspositionEntry);
+
+        if (thread_count <= 1 || total_bytes < Parallel_Clear_Min_Bytes)
+        {
+            zeroEntries (entries, entry_count);
+            return;
+        }
+
+        vector<std::thread> threads;
+        threads.reserve (thread_count);
+
+        auto chunk_size = (entry_count + thread_count - 1) / thread_count;
+        for (size_t start = 0; start < entry_count; start += chunk_size)
+        {
+            auto count = std::min (chunk_size, entry_count - start);
+            threads.emplace_back ([entries, start, count]
+            {
+                zeroEntries (entries + start, count);
+            });
+        }
+
+        for (auto& thread : threads)
+            thread.join();
+    }
+
+    void
+    TranspositionTable::FreeEntries::operator() (TranspositionEntry* entries) const noexcept
+    {
+#ifndef _WIN32
+        if (mapped_length > 0)
+        {
+            ::munmap (reinterpret_cast<char*> (entries) - mapped_offset, mapped_length);
+            return;
+        }
+#endif
+        std::free (entries);
+    }
+
+    auto
+    TranspositionTable::allocateEntries (size_t entry_count)
+        -> EntryStorage
+    {
+        void* memory = std::calloc (entry_count, sizeof (TranspositionEntry));
+        if (memory == nullptr)
+            throw std::bad_alloc {};
+
+        return EntryStorage { static_cast<TranspositionEntry*> (memory) };
+    }
+
     TranspositionTable::TranspositionTable()
         : TranspositionTable { Default_Size_In_Megabytes }
     {
@@ -10,16 +135,51 @@ namespace wisdom
 
     TranspositionTable::TranspositionTable (int size_in_mb)
     {
+        resize (size_in_mb);
+    }
+
+    TranspositionTable::TranspositionTable (const TranspositionTable& other)
+        : my_entries { allocateEntries (other.my_entry_count) }
+        , my_entry_count { other.my_entry_count }
+        , my_size_mask { other.my_size_mask }
+        , my_size_in_megabytes { other.my_size_in_megabytes }
+        , my_hits { other.my_hits }
+        , my_probes { other.my_probes }
+        , my_stored_entries { other.my_stored_entries }
+        , my_generation { other.my_generation }
+    {
+        std::memcpy (
+            static_cast<void*> (my_entries.get()),
+            other.my_entries.get(),
+            my_entry_count * sizeof (TranspositionEntry)
+        );
+    }
+
+    TranspositionTable& TranspositionTable::operator= (const TranspositionTable& other)
+    {
+        if (this != &other)
+        {
+            TranspositionTable copy { other };
+            *this = std::move (copy);
+        }
+        return *this;
+    }
+
+    auto
+    TranspositionTable::entryCountFromMegabytes (int size_in_mb)
+        -> size_t
+    {
+        Expects (size_in_mb > 0);
+
         constexpr size_t bytes_per_mb = 1024 * 1024;
-        size_t entry_count = (size_in_mb * bytes_per_mb) / sizeof (TranspositionEntry);
+        size_t entry_count = (static_cast<size_t> (size_in_mb) * bytes_per_mb) / sizeof (TranspositionEntry);
 
+        // Round down to a power of two, so the index can be found with a mask.
         size_t power_of_2 = 1;
-        while (power_of_2 < entry_count)
+        while (power_of_2 * 2 <= entry_count)
             power_of_2 <<= 1;
-        power_of_2 >>= 1;
 
-        my_entries.resize (power_of_2);
-        my_size_mask = power_of_2 - 1;
+        return power_of_2;
     }
 
     auto
@@ -32,8 +192,12 @@ namespace wisdom
     TranspositionTable::TranspositionTable (FromEntriesTag, size_t entry_count)
     {
         Expects (entry_count >= 2);
-        my_entries.resize (entry_count);
+        my_entries = allocateEntries (entry_count);
+        my_entry_count = entry_count;
         my_size_mask = entry_count - 1;
+        my_size_in_megabytes = narrow<int> (
+            (entry_count * sizeof (TranspositionEntry)) / (1024 * 1024)
+        );
     }
 
     auto
@@ -66,6 +230,37 @@ namespace wisdom
         return score;
     }
 
+    static_assert (alignof (TranspositionEntry) >= std::atomic_ref<uint64_t>::required_alignment);
+
+    // Entries may be written concurrently by other threads or processes, so
+    // each word is accessed atomically. Relaxed ordering is enough, because
+    // the key check catches entries whose two words don't belong together.
+    [[nodiscard]] static auto
+    loadWord (uint64_t& word)
+        -> uint64_t
+    {
+        return std::atomic_ref<uint64_t> { word }.load (std::memory_order_relaxed);
+    }
+
+    static void
+    storeWord (uint64_t& word, uint64_t value)
+    {
+        std::atomic_ref<uint64_t> { word }.store (value, std::memory_order_relaxed);
+    }
+
+    [[nodiscard]] static auto
+    readEntry (TranspositionEntry& entry, BoardHashCode hash)
+        -> optional<TranspositionData>
+    {
+        auto key = loadWord (entry.key);
+        auto data = loadWord (entry.data);
+
+        if ((key ^ data) != hash)
+            return nullopt;
+
+        return unpackTranspositionData (data);
+    }
+
     auto
     TranspositionTable::probe (
         BoardHashCode hash,
@@ -79,17 +274,17 @@ namespace wisdom
         my_probes++;
 
         auto index = foldHashTo32Bits (hash) & my_size_mask;
-        auto& entry = my_entries[index];
+        auto entry = readEntry (my_entries[index], hash);
 
-        if (entry.hash_code != hash)
+        if (!entry.has_value())
             return nullopt;
 
-        if (entry.depth < depth)
+        if (entry->depth < depth)
             return nullopt;
 
-        int adjusted_score = scoreFromTT (entry.score, ply);
+        int adjusted_score = scoreFromTT (entry->score, ply);
 
-        switch (entry.bound_type)
+        switch (entry->bound_type)
         {
             case BoundType::Exact:
                 my_hits++;
@@ -120,15 +315,15 @@ namespace wisdom
         -> optional<Move>
     {
         auto index = foldHashTo32Bits (hash) & my_size_mask;
-        auto& entry = my_entries[index];
+        auto entry = readEntry (my_entries[index], hash);
 
-        if (entry.hash_code != hash)
+        if (!entry.has_value())
             return nullopt;
 
-        if (entry.best_move.isNullMove())
+        if (entry->best_move.isNullMove())
             return nullopt;
 
-        return entry.best_move;
+        return entry->best_move;
     }
 
     void
@@ -144,25 +339,389 @@ namespace wisdom
         auto index = foldHashTo32Bits (hash) & my_size_mask;
         auto& entry = my_entries[index];
 
-        if (entry.hash_code == hash && entry.depth > depth)
+        auto old_key = loadWord (entry.key);
+        auto old_data = loadWord (entry.data);
+        auto old_hash = old_key ^ old_data;
+
+        if (old_hash == hash && unpackTranspositionData (old_data).depth > depth)
             return;
 
-        if (entry.hash_code == 0)
+        if (old_hash == 0)
             my_stored_entries++;
 
-        entry.hash_code = hash;
-        entry.score = scoreToTT (score, ply);
-        entry.depth = narrow<int16_t> (depth);
-        entry.bound_type = bound_type;
-        entry.best_move = best_move;
+        auto data = packTranspositionData (TranspositionData {
+            .best_move = best_move,
+            .score = scoreToTT (score, ply),
+            .depth = depth,
+            .bound_type = bound_type,
+        });
+
+        storeWord (entry.data, data);
+        storeWord (entry.key, hash ^ data);
     }
 
     void
     TranspositionTable::clear()
     {
-        std::fill (my_entries.begin(), my_entries.end(), TranspositionEntry {});
+        // Nothing stored since the last clear means every entry is still zero,
+        // and skipping the clear avoids touching pages the OS hasn't mapped yet.
+        if (my_stored_entries > 0 && !my_is_shared)
+            clearEntriesInParallel (my_entries.get(), my_entry_count);
+
+        my_hits = 0;
+        my_probes = 0;
+        my_stored_entries = 0;
+        my_generation = 0;
+    }
+
+    void
+    TranspositionTable::resize (int size_in_megabytes)
+    {
+        auto entry_count = entryCountFromMegabytes (size_in_megabytes);
+
+        // Release the old storage before allocating the new one, so that
+        // growing a large table doesn't briefly need both in memory. If the
+        // allocation fails, the size is left as zero so a later resize to
+        // any size will reallocate.
+        my_entries.reset();
+        my_entry_count = 0;
+        my_size_mask = 0;
+        my_size_in_megabytes = 0;
+
+        my_entries = allocateEntries (entry_count);
+        my_entry_count = entry_count;
+        my_size_mask = entry_count - 1;
+        my_size_in_megabytes = size_in_megabytes;
+
+        my_hits = 0;
+        my_probes = 0;
+        my_stored_entries = 0;
+        my_generation = 0;
+        my_is_shared = false;
+    }
+
+    static void
+    validateHeader (const TranspositionFileHeader& header, uint64_t file_size, const string& path)
+    {
+        if (std::memcmp (header.magic, Transposition_File_Magic, sizeof (header.magic)) != 0)
+            throw TranspositionTableFileError { "Not a transposition table file", path };
+
+        if (header.version != Transposition_File_Version)
+            throw TranspositionTableFileError { "Unsupported transposition table file version", path };
+
+        if (header.entry_size != sizeof (TranspositionEntry))
+            throw TranspositionTableFileError { "Transposition table entry size mismatch", path };
+
+        if (header.zobrist_fingerprint != Hash_Code_Table_Fingerprint)
+            throw TranspositionTableFileError {
+                "Transposition table was saved with different hash codes", path
+            };
+
+        auto entry_count = header.entry_count;
+        if (entry_count < 2 || (entry_count & (entry_count - 1)) != 0)
+            throw TranspositionTableFileError { "Invalid transposition table entry count", path };
+
+        auto max_entries = (std::numeric_limits<uint64_t>::max() - sizeof (TranspositionFileHeader))
+            / sizeof (TranspositionEntry);
+        if (entry_count > max_entries
+            || file_size != sizeof (TranspositionFileHeader) + entry_count * sizeof (TranspositionEntry))
+        {
+            throw TranspositionTableFileError { "Transposition table file is truncated", path };
+        }
+
+        if (header.stored_entries > entry_count)
+            throw TranspositionTableFileError { "Invalid transposition table entry count", path };
+
+        if (header.size_in_megabytes > static_cast<uint64_t> (std::numeric_limits<int>::max()))
+            throw TranspositionTableFileError { "Invalid transposition table size", path };
+    }
+
+    void
+    TranspositionTable::saveTo (const string& path)
+    {
+        TranspositionFileHeader header {};
+        std::memcpy (header.magic, Transposition_File_Magic, sizeof (header.magic));
+        header.version = Transposition_File_Version;
+        header.entry_size = sizeof (TranspositionEntry);
+        header.entry_count = my_entry_count;
+        header.zobrist_fingerprint = Hash_Code_Table_Fingerprint;
+        header.generation = my_generation + 1;
+        header.stored_entries = my_stored_entries;
+        header.size_in_megabytes = narrow<uint64_t> (my_size_in_megabytes);
+
+        // Write to a temporary file and rename it into place, so that a
+        // failed save doesn't destroy a previously saved table.
+        auto temp_path = path + ".tmp";
+        {
+            std::ofstream output { temp_path, std::ios::binary | std::ios::trunc };
+            if (!output)
+                throw TranspositionTableFileError { "Unable to create transposition table file", path };
+
+            output.write (reinterpret_cast<const char*> (&header), sizeof (header));
+            output.write (
+                reinterpret_cast<const char*> (my_entries.get()),
+                narrow<std::streamsize> (my_entry_count * sizeof (TranspositionEntry))
+            );
+            output.close();
+
+            if (!output)
+            {
+                std::error_code ignored;
+                std::filesystem::remove (temp_path, ignored);
+                throw TranspositionTableFileError { "Unable to write transposition table file", path };
+            }
+        }
+
+        std::error_code error;
+        std::filesystem::rename (temp_path, path, error);
+        if (error)
+        {
+            std::error_code ignored;
+            std::filesystem::remove (temp_path, ignored);
+            throw TranspositionTableFileError { "Unable to write transposition table file", path };
+        }
+
+        my_generation = header.generation;
+    }
+
+#ifndef _WIN32
+    void
+    TranspositionTable::loadFrom (const string& path)
+    {
+        int fd = ::open (path.c_str(), O_RDONLY);
+        if (fd < 0)
+            throw TranspositionTableFileError { "Unable to open transposition table file", path };
+
+        auto close_file = gsl::finally ([fd] { ::close (fd); });
+
+        struct stat file_stat {};
+        if (::fstat (fd, &file_stat) != 0)
+            throw TranspositionTableFileError { "Unable to open transposition table file", path };
+
+        auto file_size = static_cast<uint64_t> (file_stat.st_size);
+
+        TranspositionFileHeader header {};
+        if (file_size < sizeof (header)
+            || ::pread (fd, &header, sizeof (header), 0) != static_cast<ssize_t> (sizeof (header)))
+        {
+            throw TranspositionTableFileError { "Not a transposition table file", path };
+        }
+
+        validateHeader (header, file_size, path);
+
+        // A private mapping is copy-on-write: the search can update entries
+        // without those changes going back to the file.
+        auto mapped_length = narrow<size_t> (file_size);
+        void* mapping = ::mmap (nullptr, mapped_length, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+        if (mapping == MAP_FAILED)
+            throw TranspositionTableFileError { "Unable to map transposition table file", path };
+
+        auto entries = reinterpret_cast<TranspositionEntry*> (
+            static_cast<char*> (mapping) + sizeof (TranspositionFileHeader)
+        );
+        auto entry_count = narrow<size_t> (header.entry_count);
+
+        my_entries = EntryStorage { entries, FreeEntries { sizeof (TranspositionFileHeader), mapped_length } };
+        my_entry_count = entry_count;
+        my_size_mask = entry_count - 1;
+        my_size_in_megabytes = narrow<int> (header.size_in_megabytes);
+        my_hits = 0;
+        my_probes = 0;
+        my_stored_entries = narrow<size_t> (header.stored_entries);
+        my_generation = header.generation;
+        my_is_shared = false;
+    }
+#else
+    void
+    TranspositionTable::loadFrom (const string& path)
+    {
+        // No mmap() here, so read the entries into a fresh allocation instead.
+        std::ifstream input { path, std::ios::binary };
+        if (!input)
+            throw TranspositionTableFileError { "Unable to open transposition table file", path };
+
+        std::error_code error;
+        auto file_size = static_cast<uint64_t> (std::filesystem::file_size (path, error));
+        if (error)
+            throw TranspositionTableFileError { "Unable to open transposition table file", path };
+
+        TranspositionFileHeader header {};
+        if (file_size < sizeof (header) || !input.read (reinterpret_cast<char*> (&header), sizeof (header)))
+            throw TranspositionTableFileError { "Not a transposition table file", path };
+
+        validateHeader (header, file_size, path);
+
+        auto entry_count = narrow<size_t> (header.entry_count);
+        auto entries = allocateEntries (entry_count);
+        if (!input.read (
+                reinterpret_cast<char*> (entries.get()),
+                narrow<std::streamsize> (entry_count * sizeof (TranspositionEntry))))
+        {
+            throw TranspositionTableFileError { "Transposition table file is truncated", path };
+        }
+
+        my_entries = std::move (entries);
+        my_entry_count = entry_count;
+        my_size_mask = entry_count - 1;
+        my_size_in_megabytes = narrow<int> (header.size_in_megabytes);
+        my_hits = 0;
+        my_probes = 0;
+        my_stored_entries = narrow<size_t> (header.stored_entries);
+        my_generation = header.generation;
+        my_is_shared = false;
+    }
+#endif
+
+#ifdef WISDOM_CHESS_SHARED_MEMORY_TABLES
+    [[nodiscard]] static auto
+    sharedMemoryName (const string& name)
+        -> string
+    {
+        // Portable shared memory names start with a slash and have no others.
+        string result = "/";
+        for (auto ch : name)
+            result += (ch == '/') ? '_' : ch;
+        return result;
+    }
+
+    [[nodiscard]] static auto
+    waitUntilReady (int fd, SharedTableHeader& header)
+        -> bool
+    {
+        auto deadline = std::chrono::steady_clock::now() + Shared_Table_Ready_Timeout;
+
+        while (std::chrono::steady_clock::now() < deadline)
+        {
+            struct stat segment_stat {};
+            if (::fstat (fd, &segment_stat) == 0
+                && static_cast<uint64_t> (segment_stat.st_size) >= sizeof (SharedTableHeader)
+                && ::pread (fd, &header, sizeof (header), 0) == static_cast<ssize_t> (sizeof (header))
+                && header.ready == Shared_Table_Ready)
+            {
+                return true;
+            }
+            std::this_thread::sleep_for (std::chrono::milliseconds { 1 });
+        }
+
+        return false;
+    }
+
+    void
+    TranspositionTable::attachSharedMemory (const string& name, int size_in_megabytes)
+    {
+        auto shm_name = sharedMemoryName (name);
+        auto entry_count = entryCountFromMegabytes (size_in_megabytes);
+
+        SharedTableHeader header {};
+        bool created = true;
+        int fd = ::shm_open (shm_name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+        if (fd < 0 && errno == EEXIST)
+        {
+            created = false;
+            fd = ::shm_open (shm_name.c_str(), O_RDWR, 0600);
+        }
+        if (fd < 0)
+            throw TranspositionTableFileError { "Unable to open shared memory segment", name };
+
+        auto close_segment = gsl::finally ([fd] { ::close (fd); });
+
+        if (created)
+        {
+            auto length = sizeof (SharedTableHeader) + entry_count * sizeof (TranspositionEntry);
+            if (::ftruncate (fd, narrow<off_t> (length)) != 0)
+            {
+                ::shm_unlink (shm_name.c_str());
+                throw TranspositionTableFileError { "Unable to size shared memory segment", name };
+            }
+
+            header.version = Transposition_File_Version;
+            header.entry_size = sizeof (TranspositionEntry);
+            header.entry_count = entry_count;
+            header.zobrist_fingerprint = Hash_Code_Table_Fingerprint;
+            header.size_in_megabytes = narrow<uint64_t> (size_in_megabytes);
+        }
+        else
+        {
+            if (!waitUntilReady (fd, header))
+                throw TranspositionTableFileError { "Shared memory segment was never initialized", name };
+
+            if (header.version != Transposition_File_Version
+                || header.entry_size != sizeof (TranspositionEntry)
+                || header.zobrist_fingerprint != Hash_Code_Table_Fingerprint)
+            {
+                throw TranspositionTableFileError {
+                    "Shared memory segment was created by an incompatible version", name
+                };
+            }
+
+            entry_count = narrow<size_t> (header.entry_count);
+            if (entry_count < 2 || (entry_count & (entry_count - 1)) != 0)
+                throw TranspositionTableFileError { "Invalid transposition table entry count", name };
+
+            struct stat segment_stat {};
+            if (::fstat (fd, &segment_stat) != 0
+                || static_cast<uint64_t> (segment_stat.st_size)
+                    != sizeof (SharedTableHeader) + entry_count * sizeof (TranspositionEntry))
+            {
+                throw TranspositionTableFileError { "Shared memory segment has the wrong size", name };
+            }
+        }
+
+        auto mapped_length = sizeof (SharedTableHeader) + entry_count * sizeof (TranspositionEntry);
+        void* mapping = ::mmap (nullptr, mapped_length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (mapping == MAP_FAILED)
+        {
+            if (created)
+                ::shm_unlink (shm_name.c_str());
+            throw TranspositionTableFileError { "Unable to map shared memory segment", name };
+        }
+
+        if (created)
+        {
+            // The entries are already zero from ftruncate(). Publish the header
+            // with the ready word last, so other processes see all of it.
+            auto shared_header = static_cast<SharedTableHeader*> (mapping);
+            std::memcpy (
+                reinterpret_cast<char*> (shared_header) + sizeof (header.ready),
+                reinterpret_cast<const char*> (&header) + sizeof (header.ready),
+                sizeof (header) - sizeof (header.ready)
+            );
+            std::atomic_ref<uint64_t> { shared_header->ready }.store (
+                Shared_Table_Ready, std::memory_order_release
+            );
+        }
+
+        auto entries = reinterpret_cast<TranspositionEntry*> (
+            static_cast<char*> (mapping) + sizeof (SharedTableHeader)
+        );
+
+        my_entries = EntryStorage { entries, FreeEntries { sizeof (SharedTableHeader), mapped_length } };
+        my_entry_count = entry_count;
+        my_size_mask = entry_count - 1;
+        my_size_in_megabytes = narrow<int> (header.size_in_megabytes);
         my_hits = 0;
         my_probes = 0;
         my_stored_entries = 0;
+        my_generation = 0;
+        my_is_shared = true;
+    }
+
+    void
+    TranspositionTable::removeSharedMemory (const string& name)
+    {
+        auto shm_name = sharedMemoryName (name);
+        ::shm_unlink (shm_name.c_str());
+    }
+#else
+    void
+    TranspositionTable::attachSharedMemory (const string& name, [[maybe_unused]] int size_in_megabytes)
+    {
+        throw TranspositionTableFileError { "Shared memory tables are not supported on this platform", name };
+    }
+
+    void
+    TranspositionTable::removeSharedMemory ([[maybe_unused]] const string& name)
+    {
     }
+#endif
 }
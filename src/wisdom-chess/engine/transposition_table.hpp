@@ -36,15 +36,68 @@ namespace wisdom
         UpperBound
     };
 
-    struct TranspositionEntry
+    // The contents of an entry, unpacked from its data word.
+    struct TranspositionData
     {
-        BoardHashCode hash_code = 0;
         Move best_move {};
         int score = 0;
-        int16_t depth = 0;
+        int depth = 0;
         BoundType bound_type = BoundType::Exact;
     };
 
+    // An entry is two words: the hash code XORed with the packed data, and the
+    // data itself. Entries are read and written without locks, so a reader can
+    // see one word from one writer and the other word from another. When that
+    // happens, the hash recovered from the key no longer matches and the entry
+    // is treated as missing rather than returning another position's data.
+    //
+    // An entry with all bytes zeroed is the same as a default constructed one,
+    // which lets the table be allocated and cleared without constructing entries.
+    struct TranspositionEntry
+    {
+        uint64_t key = 0;
+        uint64_t data = 0;
+    };
+    static_assert (std::is_trivially_copyable_v<TranspositionEntry>);
+    static_assert (sizeof (TranspositionEntry) == 16);
+
+    // Depths deeper than this are stored as this depth, which is safe because
+    // it only makes the entry look less useful than it is.
+    inline constexpr int Max_Transposition_Depth = std::numeric_limits<int8_t>::max();
+
+    [[nodiscard]] constexpr auto
+    packTranspositionData (const TranspositionData& data)
+        -> uint64_t
+    {
+        auto depth = std::clamp (data.depth, 0, Max_Transposition_Depth);
+
+        return static_cast<uint64_t> (data.best_move.my_data)
+            | (static_cast<uint64_t> (static_cast<uint32_t> (data.score)) << 16)
+            | (static_cast<uint64_t> (depth) << 48)
+            | (static_cast<uint64_t> (data.bound_type) << 56);
+    }
+
+    [[nodiscard]] constexpr auto
+    unpackTranspositionData (uint64_t packed)
+        -> TranspositionData
+    {
+        return TranspositionData {
+            .best_move = Move { static_cast<uint16_t> (packed & 0xffff) },
+            .score = static_cast<int32_t> (static_cast<uint32_t> ((packed >> 16) & 0xffff'ffff)),
+            .depth = static_cast<int> ((packed >> 48) & 0xff),
+            .bound_type = static_cast<BoundType> ((packed >> 56) & 0xff),
+        };
+    }
+
+    class TranspositionTableFileError : public Error
+    {
+    public:
+        TranspositionTableFileError (string message, string path) noexcept
+            : Error { std::move (message), std::move (path) }
+        {
+        }
+    };
+
     class TranspositionTable
     {
         explicit TranspositionTable (int size_in_megabytes);
@@ -57,6 +110,14 @@ namespace wisdom
 
         explicit TranspositionTable();
 
+        TranspositionTable (const TranspositionTable& other);
+        TranspositionTable& operator= (const TranspositionTable& other);
+
+        TranspositionTable (TranspositionTable&& other) noexcept = default;
+        TranspositionTable& operator= (TranspositionTable&& other) noexcept = default;
+
+        ~TranspositionTable() = default;
+
         [[nodiscard]] static auto
         fromMegabytes (int size)
             -> TranspositionTable;
@@ -82,8 +143,45 @@ namespace wisdom
             int ply
         );
 
+        // Reset all entries. Large tables are cleared with several threads.
+        // A table in shared memory keeps its entries, because other processes
+        // may still be using them, and only the statistics are reset.
         void clear();
 
+        // Reallocate the table to the new size. All entries are discarded, and
+        // a table in shared memory is replaced with one private to this process.
+        void resize (int size_in_megabytes);
+
+        // Write the table to a file, so a later process can pick up where
+        // this one left off. Throws TranspositionTableFileError on failure.
+        void saveTo (const string& path);
+
+        // Replace the table with one saved by saveTo(). The file is mapped
+        // copy-on-write rather than read, so pages are only loaded from disk
+        // as the search touches them, and the file itself is never modified.
+        // Throws TranspositionTableFileError if the file can't be used, in
+        // which case the table is left unchanged.
+        void loadFrom (const string& path);
+
+        // Replace the table with one in a named shared memory segment, so that
+        // several engine processes on the same machine share their entries.
+        // The first process to attach creates the segment with the requested
+        // size, and later ones use whatever size it was created with. The
+        // segment outlives the processes attached to it until it's removed.
+        // Throws TranspositionTableFileError if the segment can't be used.
+        void attachSharedMemory (const string& name, int size_in_megabytes);
+
+        // Remove a shared memory segment. Processes already attached to it
+        // keep using it, but new ones will create a fresh segment.
+        static void removeSharedMemory (const string& name);
+
+        [[nodiscard]] auto
+        isShared() const
+            -> bool
+        {
+            return my_is_shared;
+        }
+
         [[nodiscard]] auto
         getHitCount() const
             -> size_t
@@ -109,7 +207,31 @@ namespace wisdom
         getSize() const
             -> size_t
         {
-            return my_entries.size();
+            return my_entry_count;
+        }
+
+        // How full the table is, in thousandths, as UCI reports it.
+        [[nodiscard]] auto
+        getHashFull() const
+            -> int
+        {
+            return my_entry_count > 0 ? narrow<int> (my_stored_entries * 1000 / my_entry_count) : 0;
+        }
+
+        [[nodiscard]] auto
+        getSizeInMegabytes() const
+            -> int
+        {
+            return my_size_in_megabytes;
+        }
+
+        // The number of times this table's contents have been saved. Starts
+        // at zero and is reset whenever the table is cleared or resized.
+        [[nodiscard]] auto
+        getGeneration() const
+            -> uint64_t
+        {
+            return my_generation;
         }
 
         [[nodiscard]] auto
@@ -120,6 +242,38 @@ namespace wisdom
         }
 
     private:
+        // Entries are either allocated with calloc() or are part of a file
+        // mapping, in which case the deleter needs the mapping to unmap it.
+        struct FreeEntries
+        {
+            constexpr FreeEntries() noexcept
+                : FreeEntries { 0, 0 }
+            {
+            }
+
+            constexpr FreeEntries (size_t offset, size_t length) noexcept
+                : mapped_offset { offset }
+                , mapped_length { length }
+            {
+            }
+
+            size_t mapped_offset;
+            size_t mapped_length;
+
+            void operator() (TranspositionEntry* entries) const noexcept;
+        };
+        using EntryStorage = unique_ptr<TranspositionEntry[], FreeEntries>;
+
+        // Allocate zeroed entries. Large allocations are backed by pages the OS
+        // zeroes lazily, so this doesn't touch the whole table up front.
+        [[nodiscard]] static auto
+        allocateEntries (size_t entry_count)
+            -> EntryStorage;
+
+        [[nodiscard]] static auto
+        entryCountFromMegabytes (int size_in_megabytes)
+            -> size_t;
+
         [[nodiscard]] auto
         scoreToTT (int score, int ply) const
             -> int;
@@ -128,10 +282,14 @@ namespace wisdom
         scoreFromTT (int score, int ply) const
             -> int;
 
-        vector<TranspositionEntry> my_entries;
-        size_t my_size_mask;
+        EntryStorage my_entries;
+        size_t my_entry_count = 0;
+        size_t my_size_mask = 0;
+        int my_size_in_megabytes = 0;
         size_t my_hits = 0;
         size_t my_probes = 0;
         size_t my_stored_entries = 0;
+        uint64_t my_generation = 0;
+        bool my_is_shared = false;
     };
 }
@@ -0,0 +1,91 @@
+#include <cstdint>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "wisdom-chess/engine/fen_parser.hpp"
+#include "wisdom-chess/engine/history.hpp"
+#include "wisdom-chess/engine/logger.hpp"
+#include "wisdom-chess/engine/move_timer.hpp"
+#include "wisdom-chess/engine/search.hpp"
+#include "wisdom-chess/engine/transposition_table.hpp"
+
+using wisdom::FenParser;
+using wisdom::History;
+using wisdom::IterativeSearch;
+using wisdom::makeNullLogger;
+using wisdom::MoveTimer;
+using wisdom::TranspositionTable;
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    const std::vector<std::string> Positions = {
+        "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+        "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+        "r1bqkbnr/pppp1ppp/2n5/4p3/4P3/5N2/PPPP1PPP/RNBQKB1R w KQkq - 2 3",
+        "rnbqkb1r/pp2pppp/3p1n2/8/3NP3/8/PPP2PPP/RNBQKB1R w KQkq - 1 5",
+        "r1bq1rk1/ppp2ppp/2np1n2/2b1p3/2B1P3/2NP1N2/PPP2PPP/R1BQ1RK1 w - - 0 7",
+        "2r3k1/pp3ppp/4p3/3n4/3P4/P4N2/1P3PPP/2R3K1 w - - 0 25",
+        "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+    };
+
+    struct BenchmarkResult
+    {
+        double seconds = 0.0;
+        int64_t nodes = 0;
+    };
+
+    // Search every position to the same depth from an empty table, so each
+    // setting starts from the same place.
+    auto runPositions (int multi_pv, int depth) -> BenchmarkResult
+    {
+        BenchmarkResult result;
+
+        for (const auto& fen : Positions)
+        {
+            FenParser parser { fen };
+            auto board = parser.buildBoard();
+            auto history = History::fromInitialBoard (board);
+            MoveTimer timer { std::chrono::hours { 1 } };
+            auto table = TranspositionTable::fromMegabytes (TranspositionTable::Default_Size_In_Megabytes);
+
+            auto search = IterativeSearch::create (board, history, makeNullLogger(), timer, depth, table);
+            search.setMultiPv (multi_pv);
+
+            auto start = Clock::now();
+            (void)search.iterativelyDeepen (parser.getActivePlayer());
+            result.seconds += std::chrono::duration<double> (Clock::now() - start).count();
+            result.nodes += search.getNodesVisited();
+        }
+
+        return result;
+    }
+}
+
+auto main (int argc, char** argv) -> int
+{
+    int depth = argc > 1 ? std::stoi (argv[1]) : 5;
+
+    std::cout << "Searching " << Positions.size() << " positions to depth " << depth << std::endl;
+
+    BenchmarkResult single_line;
+    for (int multi_pv : { 1, 4, 8 })
+    {
+        auto result = runPositions (multi_pv, depth);
+        if (multi_pv == 1)
+            single_line = result;
+
+        std::cout << "MultiPV " << multi_pv << ": "
+                  << std::fixed << std::setprecision (2) << result.seconds << "s, "
+                  << result.nodes << " nodes, "
+                  << std::setprecision (0) << static_cast<double> (result.nodes) / result.seconds << " nodes/sec, "
+                  << std::setprecision (2) << result.seconds / single_line.seconds << "x the time of MultiPV 1"
+                  << std::endl;
+    }
+
+    return 0;
+}
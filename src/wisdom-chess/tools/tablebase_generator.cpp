@@ -0,0 +1,171 @@
+#include <chrono>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "wisdom-chess/engine/board_builder.hpp"
+#include "wisdom-chess/engine/board.hpp"
+#include "wisdom-chess/engine/tablebase.hpp"
+#include "wisdom-chess/engine/tablebase_generator.hpp"
+
+using wisdom::Board;
+using wisdom::BoardBuilder;
+using wisdom::Color;
+using wisdom::generateTablebase;
+using wisdom::Max_Tablebase_Pieces;
+using wisdom::Num_Columns;
+using wisdom::Num_Squares;
+using wisdom::Piece;
+using wisdom::Tablebase;
+using wisdom::Tablebase_File_Extension;
+using wisdom::TablebaseLayout;
+using wisdom::tablebaseNames;
+using wisdom::writeTablebaseFile;
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+
+    auto secondsSince (Clock::time_point start) -> double
+    {
+        return std::chrono::duration<double> (Clock::now() - start).count();
+    }
+
+    struct ProbePosition
+    {
+        Board board;
+        Color to_move;
+    };
+
+    // Pick random entries of every table that decode to a position a board
+    // can hold.
+    auto samplePositions (const std::vector<std::string>& names, int per_table) -> std::vector<ProbePosition>
+    {
+        std::mt19937_64 generator { 1 };
+        std::vector<ProbePosition> result;
+
+        for (const auto& name : names)
+        {
+            auto layout = TablebaseLayout::fromName (name);
+            std::uniform_int_distribution<std::size_t> distribution { 0, layout->size() - 1 };
+
+            for (int found = 0; found < per_table;)
+            {
+                std::array<int, Max_Tablebase_Pieces> squares {};
+                auto to_move = layout->decode (
+                    distribution (generator),
+                    { squares.data(), layout->pieces().size() }
+                );
+
+                bool valid = true;
+                for (std::size_t i = 0; i < layout->pieces().size(); i++)
+                {
+                    auto row = squares[i] / Num_Columns;
+                    auto type = wisdom::pieceType (layout->pieces()[i]);
+                    if (type == Piece::Pawn && (row == wisdom::First_Row || row == wisdom::Last_Row))
+                        valid = false;
+                    for (std::size_t j = 0; j < i; j++)
+                        valid = valid && squares[i] != squares[j];
+                }
+                if (!valid)
+                    continue;
+
+                BoardBuilder builder;
+                for (std::size_t i = 0; i < layout->pieces().size(); i++)
+                {
+                    auto piece = layout->pieces()[i];
+                    builder.addPiece (
+                        squares[i] / Num_Columns,
+                        squares[i] % Num_Columns,
+                        wisdom::pieceColor (piece),
+                        wisdom::pieceType (piece)
+                    );
+                }
+                result.push_back ({ Board { builder }, to_move });
+                found++;
+            }
+        }
+
+        return result;
+    }
+
+    void measureProbes (const Tablebase& tablebase, const std::vector<ProbePosition>& positions)
+    {
+        constexpr int Passes = 5;
+        int found = 0;
+
+        for (int pass = 0; pass < Passes; pass++)
+        {
+            auto start = Clock::now();
+            for (const auto& position : positions)
+                found += tablebase.probe (position.board, position.to_move).has_value();
+            auto nanoseconds = secondsSince (start) * 1e9 / static_cast<double> (positions.size());
+
+            // The first pass pays for faulting in the pages of the mapped files.
+            std::cout << (pass == 0 ? "  cold" : "  warm") << " pass: " << std::fixed << std::setprecision (1)
+                      << nanoseconds << " ns per probe" << std::endl;
+        }
+
+        std::cout << "  " << found / Passes << " of " << positions.size() << " positions found" << std::endl;
+    }
+}
+
+auto main (int argc, char** argv) -> int
+{
+    if (argc < 2)
+    {
+        std::cerr << "Usage: " << argv[0] << " <output directory> [max pieces] [threads]\n";
+        return 1;
+    }
+
+    std::string directory = argv[1];
+    int max_pieces = argc > 2 ? std::stoi (argv[2]) : Max_Tablebase_Pieces;
+    int thread_count = argc > 3 ? std::stoi (argv[3]) : static_cast<int> (std::thread::hardware_concurrency());
+
+    max_pieces = std::clamp (max_pieces, 3, Max_Tablebase_Pieces);
+    thread_count = std::max (thread_count, 1);
+    std::filesystem::create_directories (directory);
+
+    auto names = tablebaseNames (max_pieces);
+    std::cout << "Generating " << names.size() << " tables with up to " << max_pieces
+              << " pieces using " << thread_count << " threads" << std::endl;
+
+    Tablebase generated;
+    auto total_start = Clock::now();
+
+    for (const auto& name : names)
+    {
+        auto start = Clock::now();
+        auto result = generateTablebase (name, generated, thread_count);
+        auto seconds = secondsSince (start);
+
+        auto path = (std::filesystem::path { directory } / (name + std::string { Tablebase_File_Extension })).string();
+        writeTablebaseFile (path, name, result.values);
+
+        std::cout << std::left << std::setw (8) << name << std::right
+                  << std::setw (10) << result.positions << " positions, "
+                  << std::setw (9) << result.wins << " wins, "
+                  << std::setw (9) << result.losses << " losses, "
+                  << std::setw (9) << result.draws << " draws, "
+                  << "longest mate " << std::setw (3) << result.longest_mate << " plies, "
+                  << std::fixed << std::setprecision (2) << seconds << "s" << std::endl;
+
+        generated.addTable (name, std::move (result.values));
+    }
+
+    std::cout << "Generated everything in " << std::fixed << std::setprecision (1)
+              << secondsSince (total_start) << "s" << std::endl;
+
+    auto tablebase = Tablebase::open (directory);
+    std::cout << "Mapped " << tablebase->tableCount() << " table files" << std::endl;
+
+    auto positions = samplePositions (names, 20000);
+    std::cout << "Probing " << positions.size() << " random positions:" << std::endl;
+    measureProbes (*tablebase, positions);
+
+    return 0;
+}
@@ -0,0 +1,209 @@
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "wisdom-chess/engine/game.hpp"
+#include "wisdom-chess/engine/logger.hpp"
+#include "wisdom-chess/engine/time_manager.hpp"
+
+using wisdom::allocateTime;
+using wisdom::Color;
+using wisdom::colorIndex;
+using wisdom::Game;
+using wisdom::GameStatus;
+using wisdom::Logger;
+using wisdom::TimeBudget;
+using wisdom::TimeControl;
+
+namespace
+{
+    using Clock = std::chrono::steady_clock;
+    using std::chrono::milliseconds;
+
+    // Play self-play games against a simulated clock, and report how each
+    // way of budgeting time for a move uses it.
+    enum class Policy
+    {
+        // The old fixed budget: a thirtieth of the clock plus the increment,
+        // searched until the timer fires.
+        Fixed,
+
+        // The time manager's optimum and maximum.
+        Managed,
+    };
+
+    struct ClockSettings
+    {
+        const char* name;
+        milliseconds initial;
+        milliseconds increment;
+        std::optional<int> moves_per_control;
+    };
+
+    constexpr int Max_Plies = 100;
+
+    const std::vector<std::string> Openings = {
+        "rnbqkbnr/pppppppp/8/8/4P3/8/PPPP1PPP/RNBQKBNR b KQkq - 0 1",
+        "rnbqkb1r/pppp1ppp/5n2/4p3/2P5/2N5/PP1PPPPP/R1BQKBNR w KQkq - 2 3",
+    };
+
+    // Picks out of the search log how deep it got and why it stopped.
+    class SearchLog : public Logger
+    {
+    public:
+        void debug (const std::string&) const override {}
+
+        void info (const std::string& output) const override
+        {
+            constexpr std::string_view Depth_Prefix = "Searching depth ";
+            if (output.starts_with (Depth_Prefix))
+                depth = std::stoi (output.substr (Depth_Prefix.size()));
+            else if (output.starts_with ("Search timed out"))
+                timed_out = true;
+            else if (output.starts_with ("Soft time limit"))
+                stopped_at_target = true;
+            else if (output.starts_with ("Next depth wouldn't finish"))
+                stopped_by_prediction = true;
+        }
+
+        // The deepest search that finished, since one cut off by the timer
+        // is thrown away.
+        [[nodiscard]] auto
+        completedDepth() const
+            -> int
+        {
+            return timed_out ? depth - 1 : depth;
+        }
+
+        mutable int depth = 0;
+        mutable bool timed_out = false;
+        mutable bool stopped_at_target = false;
+        mutable bool stopped_by_prediction = false;
+    };
+
+    struct Report
+    {
+        int moves = 0;
+        int flag_falls = 0;
+        int stopped_at_target = 0;
+        int stopped_by_prediction = 0;
+        int timed_out = 0;
+        long depth_total = 0;
+        milliseconds used_total { 0 };
+        milliseconds optimum_total { 0 };
+        milliseconds worst_overrun { 0 };
+        milliseconds lowest_clock { std::chrono::hours { 1 } };
+    };
+
+    auto
+    budgetFor (Policy policy, const TimeControl& time_control)
+        -> TimeBudget
+    {
+        if (policy == Policy::Managed)
+            return allocateTime (time_control);
+
+        auto time_for_move = time_control.time_remaining / 30 + time_control.increment;
+        time_for_move = std::max (time_for_move, milliseconds { 100 });
+        return { time_for_move, time_for_move };
+    }
+
+    void
+    playGame (Policy policy, const ClockSettings& settings, const std::string& fen, Report& report)
+    {
+        auto game = Game::createGameFromFen (fen);
+        std::array<milliseconds, 2> clocks = { settings.initial, settings.initial };
+        std::array<int, 2> moves_made {};
+
+        for (int ply = 0; ply < Max_Plies && game.status() == GameStatus::Playing; ply++)
+        {
+            auto who = game.getCurrentTurn();
+            auto index = colorIndex (who);
+
+            TimeControl time_control { clocks[index], settings.increment, {} };
+            if (settings.moves_per_control.has_value())
+                time_control.moves_to_go = *settings.moves_per_control - moves_made[index] % *settings.moves_per_control;
+
+            auto budget = budgetFor (policy, time_control);
+            game.setSearchTimeout (budget.maximum);
+            game.setSoftSearchTimeout (
+                policy == Policy::Managed ? std::optional { budget.optimum } : std::nullopt
+            );
+
+            auto log = std::make_shared<SearchLog>();
+            auto start = Clock::now();
+            auto move = game.findBestMove (log, who);
+            auto used = std::chrono::duration_cast<milliseconds> (Clock::now() - start);
+            if (!move.has_value())
+                break;
+
+            game.move (*move);
+            clocks[index] -= used;
+            moves_made[index]++;
+
+            report.moves++;
+            report.depth_total += log->completedDepth();
+            report.timed_out += log->timed_out;
+            report.stopped_at_target += log->stopped_at_target;
+            report.stopped_by_prediction += log->stopped_by_prediction;
+            report.used_total += used;
+            report.optimum_total += budget.optimum;
+            report.worst_overrun = std::max (report.worst_overrun, used - budget.maximum);
+            report.lowest_clock = std::min (report.lowest_clock, clocks[index]);
+
+            if (clocks[index] <= milliseconds { 0 })
+            {
+                report.flag_falls++;
+                break;
+            }
+
+            clocks[index] += settings.increment;
+            if (settings.moves_per_control.has_value() && moves_made[index] % *settings.moves_per_control == 0)
+                clocks[index] += settings.initial;
+        }
+    }
+
+    void
+    printReport (const char* name, const Report& report)
+    {
+        auto moves = std::max (report.moves, 1);
+        std::cout << "  " << std::left << std::setw (8) << name << std::right
+                  << std::setw (4) << report.moves << " moves, "
+                  << std::setw (6) << report.used_total.count() / moves << "ms per move ("
+                  << std::fixed << std::setprecision (2)
+                  << static_cast<double> (report.used_total.count()) / static_cast<double> (report.optimum_total.count())
+                  << " of optimum), average completed depth "
+                  << std::setprecision (1) << static_cast<double> (report.depth_total) / moves
+                  << ", stopped at target " << report.stopped_at_target
+                  << ", by prediction " << report.stopped_by_prediction
+                  << ", timed out " << report.timed_out
+                  << ", worst overrun " << report.worst_overrun.count() << "ms"
+                  << ", lowest clock " << report.lowest_clock.count() << "ms"
+                  << ", flag falls " << report.flag_falls << std::endl;
+    }
+}
+
+auto main() -> int
+{
+    const std::vector<ClockSettings> clock_settings = {
+        { "8s + 0.08s", milliseconds { 8'000 }, milliseconds { 80 }, std::nullopt },
+        { "20 moves in 4s", milliseconds { 4'000 }, milliseconds { 0 }, 20 },
+    };
+
+    for (const auto& settings : clock_settings)
+    {
+        std::cout << settings.name << ":" << std::endl;
+        for (auto [policy, name] : { std::pair { Policy::Fixed, "fixed" }, std::pair { Policy::Managed, "managed" } })
+        {
+            Report report;
+            for (const auto& fen : Openings)
+                playGame (policy, settings, fen, report);
+            printReport (name, report);
+        }
+    }
+
+    return 0;
+}
@@ -1,12 +1,19 @@
 #include "uci_interface.hpp"
 #include "wisdom-chess/engine/logger.hpp"
+#include "wisdom-chess/engine/evaluate.hpp"
 #include "wisdom-chess/engine/fen_parser.hpp"
+#include "wisdom-chess/engine/generate.hpp"
 #include "wisdom-chess/engine/str.hpp"
 #include "wisdom-chess/engine/move.hpp"
+#include "wisdom-chess/engine/material.hpp"
+#include "wisdom-chess/engine/search.hpp"
 #include "wisdom-chess/engine/coord.hpp"
+#include "wisdom-chess/engine/time_manager.hpp"
+#include "wisdom-chess/engine/transposition_table.hpp"
 
 #include <algorithm>
 #include <chrono>
+#include <sstream>
 
 namespace wisdom
 {
@@ -23,22 +30,109 @@ namespace wisdom
             void debug (const string& output) const override
             {
                 if (my_debug_enabled)
-                {
-                    std::cout << "info string " << output << "\n";
-                    std::cout.flush();
-                }
+                    writeStrings (output);
             }
 
+            // The search's own messages aren't standard info, so they go
+            // out as strings.
             void info (const string& output) const override
             {
-                std::cout << "info " << output << "\n";
-                std::cout.flush();
+                writeStrings (output);
             }
 
         private:
+            // Every line of the output becomes an "info string" line. They're
+            // written at once, so "readyok" can't land in the middle of them
+            // while the search is running.
+            static void writeStrings (const string& output)
+            {
+                string result;
+                std::istringstream lines { output };
+                for (string line; std::getline (lines, line);)
+                {
+                    if (!line.empty())
+                        result += "info string " + line + "\n";
+                }
+
+                std::cout << result;
+                std::cout.flush();
+            }
+
             bool my_debug_enabled;
         };
 
+        auto
+        moveToUci (const Move& move)
+            -> string
+        {
+            string result;
+            result += asString (move.getSrc());
+            result += asString (move.getDst());
+
+            if (move.isPromoting())
+            {
+                char piece_char = tolower (pieceToChar (move.getPromotedPiece()));
+                result += piece_char;
+            }
+
+            return result;
+        }
+
+        // A score as "cp" in hundredths of a pawn, or as "mate" in moves,
+        // negative when the side to move is getting mated.
+        auto
+        scoreToUci (int score)
+            -> string
+        {
+            if (isCheckmatingOpponentScore (score))
+                return "mate " + std::to_string ((Checkmate_Score - score + 1) / 2);
+            if (isCheckmatingOpponentScore (-score))
+                return "mate " + std::to_string (-(Checkmate_Score + score + 1) / 2);
+
+            auto centipawns = score * 100 / Material::scaledScore (Material::weight (Piece::Pawn));
+            return "cp " + std::to_string (centipawns);
+        }
+
+        // Writes the progress of the search as standard "info" lines.
+        class UciSearchListener : public SearchListener
+        {
+        public:
+            // The current root move is only worth reporting once the depth
+            // takes long enough for someone to be watching.
+            static constexpr chrono::milliseconds Current_Move_Delay { 1000 };
+
+            void iterationFinished (const SearchStats& stats) override
+            {
+                std::ostringstream line;
+                line << "info depth " << stats.depth
+                     << " seldepth " << stats.selective_depth
+                     << " multipv " << stats.multi_pv
+                     << " score " << scoreToUci (stats.score)
+                     << " nodes " << stats.nodes
+                     << " nps " << stats.nodes_per_second
+                     << " hashfull " << stats.hash_full
+                     << " time " << stats.time.count()
+                     << " pv";
+                for (auto move : stats.principal_variation)
+                    line << " " << moveToUci (move);
+                line << "\n";
+
+                std::cout << std::move (line).str();
+                std::cout.flush();
+            }
+
+            void rootMoveStarted (const RootMoveStats& stats) override
+            {
+                if (stats.time < Current_Move_Delay)
+                    return;
+
+                std::cout << ("info depth " + std::to_string (stats.depth)
+                    + " currmove " + moveToUci (stats.move)
+                    + " currmovenumber " + std::to_string (stats.move_number) + "\n");
+                std::cout.flush();
+            }
+        };
+
         auto
         findTokenValue (const vector<string>& tokens, const string& name)
             -> optional<int>
@@ -58,6 +152,38 @@ namespace wisdom
             return nullopt;
         }
 
+        auto
+        findLongTokenValue (const vector<string>& tokens, const string& name)
+            -> optional<int64_t>
+        {
+            auto it = std::find (tokens.begin(), tokens.end(), name);
+            if (it != tokens.end() && (it + 1) != tokens.end())
+            {
+                try
+                {
+                    return std::stoll (*(it + 1));
+                }
+                catch (...)
+                {
+                    return nullopt;
+                }
+            }
+            return nullopt;
+        }
+
+        // The words after "go" that start a new parameter, which end the
+        // list of moves after "searchmoves".
+        auto
+        isGoParameter (const string& token)
+            -> bool
+        {
+            static const std::array<string, 12> parameters = {
+                "searchmoves", "ponder", "wtime", "btime", "winc", "binc",
+                "movestogo", "depth", "nodes", "mate", "movetime", "infinite",
+            };
+            return std::find (parameters.begin(), parameters.end(), token) != parameters.end();
+        }
+
         auto
         hasToken (const vector<string>& tokens, const string& name)
             -> bool
@@ -83,16 +209,18 @@ namespace wisdom
 
     UciInterface::~UciInterface()
     {
-        waitForSearchThread();
+        stopSearch();
     }
 
-    void UciInterface::waitForSearchThread()
+    void UciInterface::stopSearch()
     {
-        if (my_search_thread.joinable())
-        {
-            my_search_id.fetch_add (1);
-            my_search_thread.join();
-        }
+        my_search_worker.requestStop();
+        my_search_worker.wait();
+    }
+
+    void UciInterface::waitForSearch()
+    {
+        my_search_worker.wait();
     }
 
     void UciInterface::run()
@@ -102,6 +230,13 @@ namespace wisdom
         {
             processCommand (line);
         }
+
+        // Let a search started just before the input ended report its
+        // move, unless it would never end by itself.
+        if (my_holding_best_move)
+            stopSearch();
+        else
+            waitForSearch();
     }
 
     void UciInterface::processCommand (const string& line)
@@ -136,6 +271,10 @@ namespace wisdom
         {
             handleStop();
         }
+        else if (command == "ponderhit")
+        {
+            handlePonderHit();
+        }
         else if (command == "quit")
         {
             handleQuit();
@@ -162,18 +301,29 @@ namespace wisdom
         std::cout.flush();
     }
 
+    // This doesn't wait for a search to finish: "readyok" is expected right
+    // away even while searching.
     void UciInterface::handleIsReady()
     {
-        waitForSearchThread();
         std::cout << "readyok\n";
         std::cout.flush();
     }
 
     void UciInterface::handleNewGame()
     {
-        waitForSearchThread();
+        stopSearch();
         std::lock_guard<std::mutex> lock { my_game_mutex };
-        my_game = Game::createStandardGame();
+        resetGame (Game::createStandardGame());
+        my_game.clearTranspositionTable();
+    }
+
+    void UciInterface::resetGame (Game new_game)
+    {
+        new_game.setEvaluationNetwork (my_game.getEvaluationNetwork());
+        new_game.setTablebase (my_game.getTablebase());
+        new_game.takeTranspositionTable (std::move (my_game));
+        new_game.takeEvalCache (std::move (my_game));
+        my_game = std::move (new_game);
     }
 
     void UciInterface::handlePosition (const vector<string>& tokens)
@@ -181,12 +331,12 @@ namespace wisdom
         if (tokens.size() < 2)
             return;
 
-        waitForSearchThread();
+        stopSearch();
         std::lock_guard<std::mutex> lock { my_game_mutex };
 
         if (tokens[1] == "startpos")
         {
-            my_game = Game::createStandardGame();
+            resetGame (Game::createStandardGame());
 
             auto moves_it = std::find (tokens.begin(), tokens.end(), "moves");
             if (moves_it != tokens.end())
@@ -213,7 +363,7 @@ namespace wisdom
 
             try
             {
-                my_game = Game::createGameFromFen (fen_string);
+                resetGame (Game::createGameFromFen (fen_string));
             }
             catch (...)
             {
@@ -242,7 +392,7 @@ namespace wisdom
 
     void UciInterface::handleGo (const vector<string>& tokens)
     {
-        waitForSearchThread();
+        stopSearch();
 
         auto depth = findTokenValue (tokens, "depth");
         auto movetime = findTokenValue (tokens, "movetime");
@@ -250,16 +400,29 @@ namespace wisdom
         auto btime = findTokenValue (tokens, "btime");
         auto winc = findTokenValue (tokens, "winc");
         auto binc = findTokenValue (tokens, "binc");
+        auto movestogo = findTokenValue (tokens, "movestogo");
+        auto nodes = findLongTokenValue (tokens, "nodes");
+        auto mate = findTokenValue (tokens, "mate");
         bool infinite = hasToken (tokens, "infinite");
+        bool ponder = hasToken (tokens, "ponder");
+        auto search_moves = parseSearchMoves (tokens);
 
         int search_depth = my_settings.default_depth;
         std::chrono::milliseconds search_time { 0 };
+        optional<std::chrono::milliseconds> soft_search_time {};
 
         if (depth.has_value())
         {
             search_depth = std::clamp (*depth, 1, 64);
         }
 
+        // A mate in N moves takes 2N - 1 plies to find, and the search stops
+        // early when it finds one.
+        if (mate.has_value())
+        {
+            search_depth = std::min (search_depth, std::clamp (2 * *mate - 1, 1, 64));
+        }
+
         if (movetime.has_value())
         {
             search_time = std::chrono::milliseconds { *movetime };
@@ -269,57 +432,68 @@ namespace wisdom
             std::lock_guard<std::mutex> lock { my_game_mutex };
             Color current_turn = my_game.getCurrentTurn();
 
-            int time_remaining = 0;
-            int increment = 0;
+            TimeControl time_control;
+            time_control.moves_to_go = movestogo;
 
             if (current_turn == Color::White)
             {
-                time_remaining = wtime.value_or (0);
-                increment = winc.value_or (0);
+                time_control.time_remaining = std::chrono::milliseconds { wtime.value_or (0) };
+                time_control.increment = std::chrono::milliseconds { winc.value_or (0) };
             }
             else
             {
-                time_remaining = btime.value_or (0);
-                increment = binc.value_or (0);
+                time_control.time_remaining = std::chrono::milliseconds { btime.value_or (0) };
+                time_control.increment = std::chrono::milliseconds { binc.value_or (0) };
             }
 
-            int time_for_move = (time_remaining / 30) + increment;
-            time_for_move = std::max (time_for_move, 100);
-            search_time = std::chrono::milliseconds { time_for_move };
+            // The search aims for the optimum, adjusting it as it goes, and
+            // is cut off at the maximum.
+            auto budget = allocateTime (time_control);
+            search_time = budget.maximum;
+            soft_search_time = budget.optimum;
         }
-        else if (infinite)
+        else if (infinite || nodes.has_value() || mate.has_value())
         {
+            // A node limited search mustn't depend on the clock, so that it
+            // comes out the same every time.
             search_time = std::chrono::hours { 24 };
         }
 
-        int current_search_id = my_search_id.fetch_add (1) + 1;
+        // The move from pondering or an infinite search can't be reported
+        // until "ponderhit" or "stop".
+        my_holding_best_move = ponder || infinite;
+        my_ponder_hit = std::stop_source {};
 
         Game game_copy = [this]
         {
             std::lock_guard<std::mutex> lock { my_game_mutex };
             return my_game;
         }();
-
-        my_search_thread = std::thread (
-            [this, game = std::move (game_copy), search_depth, search_time, current_search_id] () mutable
+        if (ponder)
+            game_copy.setPonderHitToken (my_ponder_hit.get_token());
+        game_copy.setSearchListener (make_shared<UciSearchListener>());
+        game_copy.setMultiPv (my_settings.multi_pv);
+        game_copy.setNodeLimit (nodes);
+        game_copy.setSearchMoves (std::move (search_moves));
+
+        my_search_worker.start (
+            [this, game = std::move (game_copy), search_depth, search_time, soft_search_time] (std::stop_token stop_token) mutable
             {
                 game.setMaxDepth (search_depth);
                 if (search_time.count() > 0)
-                {
-                    auto seconds = std::chrono::duration_cast<std::chrono::seconds> (search_time);
-                    if (seconds.count() == 0)
-                        seconds = std::chrono::seconds { 1 };
-                    game.setSearchTimeout (seconds);
-                }
-                game.setPeriodicFunction (buildNotifier (current_search_id));
+                    game.setSearchTimeout (search_time);
+                game.setSoftSearchTimeout (soft_search_time);
 
                 auto logger = std::make_shared<UciLogger> (my_debug_mode);
-                auto best_move = game.findBestMove (logger);
+                auto best_move = game.findBestMove (logger, stop_token);
+                auto ponder_move = best_move.has_value() ? game.expectedReply (*best_move) : nullopt;
 
-                if (my_search_id.load() == current_search_id)
                 {
-                    sendBestMove (best_move);
+                    std::unique_lock<std::mutex> lock { my_hold_mutex };
+                    my_hold_condition.wait (lock, stop_token, [this] { return !my_holding_best_move; });
                 }
+
+                sendBestMove (best_move, ponder_move);
             });
     }
 
@@ -344,8 +518,16 @@ namespace wisdom
         option_name = toLower (option_name);
 
         optional<int> value;
+        string value_string;
         if (value_it != tokens.end() && value_it + 1 != tokens.end())
         {
+            for (auto value_token = value_it + 1; value_token != tokens.end(); ++value_token)
+            {
+                if (!value_string.empty())
+                    value_string += " ";
+                value_string += *value_token;
+            }
+
             try
             {
                 value = std::stoi (*(value_it + 1));
@@ -357,22 +539,257 @@ namespace wisdom
 
         if (option_name == "hash" && value.has_value())
         {
-            my_settings.hash_size_mb = std::clamp (*value, 1, 1024);
+            my_settings.hash_size_mb = std::clamp (
+                *value,
+                UciSettings::Min_Hash_Size_Mb,
+                UciSettings::Max_Hash_Size_Mb
+            );
+            applyHashSize();
         }
         else if (option_name == "depth" && value.has_value())
         {
             my_settings.default_depth = std::clamp (*value, 1, 64);
         }
+        else if (option_name == "multipv" && value.has_value())
+        {
+            my_settings.multi_pv = std::clamp (*value, 1, UciSettings::Max_Multi_Pv);
+        }
+        else if (option_name == "eval cache" && value.has_value())
+        {
+            my_settings.eval_cache_mb = std::clamp (*value, 0, UciSettings::Max_Eval_Cache_Size_Mb);
+            applyEvalCacheSize();
+        }
+        else if (option_name == "evalfile")
+        {
+            my_settings.eval_file = (value_string == "<empty>") ? string {} : value_string;
+            loadEvalFile();
+        }
+        else if (option_name == "use nnue")
+        {
+            my_settings.use_nnue = toLower (value_string) == "true";
+            applyEvaluator();
+        }
+        else if (option_name == "tablebase path")
+        {
+            my_settings.tablebase_path = (value_string == "<empty>") ? string {} : value_string;
+            loadTablebase();
+        }
+        else if (option_name == "hash file" && !value_string.empty())
+        {
+            my_settings.hash_file = value_string;
+        }
+        else if (option_name == "shared hash")
+        {
+            auto shared_hash = (value_string == "<empty>") ? string {} : value_string;
+            if (shared_hash != my_settings.shared_hash)
+            {
+                my_settings.shared_hash = shared_hash;
+                applySharedHash();
+            }
+        }
+        else if (option_name == "save hash")
+        {
+            saveHashFile();
+        }
+        else if (option_name == "load hash")
+        {
+            loadHashFile();
+        }
+    }
+
+    void UciInterface::loadEvalFile()
+    {
+        my_network.reset();
+
+        if (!my_settings.eval_file.empty())
+        {
+            try
+            {
+                my_network = NnueNetwork::load (my_settings.eval_file);
+            }
+            catch (const NnueFileError& error)
+            {
+                std::cout << "info string " << error.message() << ": " << error.extra_info() << "\n";
+                std::cout.flush();
+            }
+        }
+
+        applyEvaluator();
+    }
+
+    void UciInterface::loadTablebase()
+    {
+        shared_ptr<const Tablebase> tablebase;
+
+        if (!my_settings.tablebase_path.empty())
+        {
+            try
+            {
+                tablebase = Tablebase::open (my_settings.tablebase_path);
+                std::cout << "info string Loaded " << tablebase->tableCount() << " tablebase files with up to "
+                          << tablebase->maxPieces() << " pieces\n";
+                std::cout.flush();
+            }
+            catch (const TablebaseFileError& error)
+            {
+                std::cout << "info string " << error.message() << ": " << error.extra_info() << "\n";
+                std::cout.flush();
+            }
+        }
+
+        stopSearch();
+        std::lock_guard<std::mutex> lock { my_game_mutex };
+        my_game.setTablebase (std::move (tablebase));
+    }
+
+    void UciInterface::applyEvaluator()
+    {
+        stopSearch();
+        std::lock_guard<std::mutex> lock { my_game_mutex };
+
+        if (my_settings.use_nnue && my_network == nullptr)
+        {
+            std::cout << "info string No network loaded from EvalFile, using the classic evaluation\n";
+            std::cout.flush();
+        }
+
+        my_game.setEvaluationNetwork (my_settings.use_nnue ? my_network : nullptr);
+    }
+
+    void UciInterface::applySharedHash()
+    {
+        stopSearch();
+        std::lock_guard<std::mutex> lock { my_game_mutex };
+
+        if (my_settings.shared_hash.empty())
+        {
+            // Switch back to a private table. The current entries are only
+            // worth copying if the table keeps its size: resizing would
+            // discard the copy straight away.
+            if (my_game.getTranspositionTableSize() == my_settings.hash_size_mb)
+                my_game.detachTranspositionTable();
+            else
+                my_game.replaceTranspositionTable (my_settings.hash_size_mb);
+            return;
+        }
+
+        try
+        {
+            my_game.attachSharedTranspositionTable (my_settings.shared_hash, my_settings.hash_size_mb);
+        }
+        catch (const TranspositionTableFileError& error)
+        {
+            std::cout << "info string " << error.message() << ": " << error.extra_info() << "\n";
+            std::cout.flush();
+            my_settings.shared_hash.clear();
+        }
+    }
+
+    void UciInterface::saveHashFile()
+    {
+        stopSearch();
+        std::lock_guard<std::mutex> lock { my_game_mutex };
+
+        try
+        {
+            my_game.saveTranspositionTable (my_settings.hash_file);
+        }
+        catch (const TranspositionTableFileError& error)
+        {
+            std::cout << "info string " << error.message() << ": " << error.extra_info() << "\n";
+            std::cout.flush();
+        }
+    }
+
+    void UciInterface::loadHashFile()
+    {
+        stopSearch();
+        std::lock_guard<std::mutex> lock { my_game_mutex };
+
+        try
+        {
+            my_game.loadTranspositionTable (my_settings.hash_file);
+            my_settings.hash_size_mb = my_game.getTranspositionTableSize();
+            my_settings.shared_hash.clear();
+        }
+        catch (const TranspositionTableFileError& error)
+        {
+            std::cout << "info string " << error.message() << ": " << error.extra_info() << "\n";
+            std::cout.flush();
+        }
+    }
+
+    void UciInterface::applyHashSize()
+    {
+        stopSearch();
+        std::lock_guard<std::mutex> lock { my_game_mutex };
+
+        if (!my_settings.shared_hash.empty())
+        {
+            // The size of a shared table is fixed by whichever process created it.
+            std::cout << "info string Keeping the shared hash table at "
+                      << my_game.getTranspositionTableSize() << " MB, the new Hash size "
+                      << "applies once Shared Hash is cleared\n";
+            std::cout.flush();
+            return;
+        }
+
+        try
+        {
+            my_game.setTranspositionTableSize (my_settings.hash_size_mb);
+        }
+        catch (const std::bad_alloc&)
+        {
+            std::cout << "info string Unable to allocate " << my_settings.hash_size_mb
+                      << " MB for the hash table, using "
+                      << UciSettings::Default_Hash_Size_Mb << " MB\n";
+            std::cout.flush();
+
+            my_settings.hash_size_mb = UciSettings::Default_Hash_Size_Mb;
+            my_game.setTranspositionTableSize (my_settings.hash_size_mb);
+        }
+    }
+
+    void UciInterface::applyEvalCacheSize()
+    {
+        stopSearch();
+        std::lock_guard<std::mutex> lock { my_game_mutex };
+
+        try
+        {
+            my_game.setEvalCacheSize (my_settings.eval_cache_mb);
+        }
+        catch (const std::bad_alloc&)
+        {
+            std::cout << "info string Unable to allocate " << my_settings.eval_cache_mb
+                      << " MB for the evaluation cache, disabling it\n";
+            std::cout.flush();
+
+            my_settings.eval_cache_mb = 0;
+            my_game.setEvalCacheSize (0);
+        }
     }
 
     void UciInterface::handleStop()
     {
-        my_search_id.fetch_add (1);
+        stopSearch();
+    }
+
+    // The opponent played the move being pondered on, so the search goes
+    // on under the time control it was started with.
+    void UciInterface::handlePonderHit()
+    {
+        {
+            std::lock_guard<std::mutex> lock { my_hold_mutex };
+            my_holding_best_move = false;
+        }
+        my_ponder_hit.request_stop();
+        my_hold_condition.notify_all();
     }
 
     void UciInterface::handleQuit()
     {
-        waitForSearchThread();
+        stopSearch();
         std::exit (0);
     }
 
@@ -394,9 +811,22 @@ namespace wisdom
 
     void UciInterface::sendEngineInfo()
     {
-        std::cout << "option name Hash type spin default 16 min 1 max 1024\n";
+        std::cout << "option name Hash type spin default " << UciSettings::Default_Hash_Size_Mb
+                  << " min " << UciSettings::Min_Hash_Size_Mb
+                  << " max " << UciSettings::Max_Hash_Size_Mb << "\n";
+        std::cout << "option name Ponder type check default false\n";
         std::cout << "option name Depth type spin default " << Default_Max_Depth
                   << " min 1 max 64\n";
+        std::cout << "option name MultiPV type spin default 1 min 1 max " << UciSettings::Max_Multi_Pv << "\n";
+        std::cout << "option name Eval Cache type spin default " << EvalCache::Default_Size_In_Megabytes
+                  << " min 0 max " << UciSettings::Max_Eval_Cache_Size_Mb << "\n";
+        std::cout << "option name EvalFile type string default <empty>\n";
+        std::cout << "option name Use NNUE type check default false\n";
+        std::cout << "option name Tablebase Path type string default <empty>\n";
+        std::cout << "option name Hash File type string default " << UciSettings::Default_Hash_File << "\n";
+        std::cout << "option name Shared Hash type string default <empty>\n";
+        std::cout << "option name Save Hash type button\n";
+        std::cout << "option name Load Hash type button\n";
     }
 
     auto
@@ -440,27 +870,37 @@ namespace wisdom
     }
 
     auto
-    UciInterface::moveToUci (const Move& move)
-        -> string
+    UciInterface::parseSearchMoves (const vector<string>& tokens)
+        -> vector<Move>
     {
-        string result;
-        result += asString (move.getSrc());
-        result += asString (move.getDst());
+        vector<Move> result;
 
-        if (move.isPromoting())
+        auto it = std::find (tokens.begin(), tokens.end(), "searchmoves");
+        if (it == tokens.end())
+            return result;
+
+        std::lock_guard<std::mutex> lock { my_game_mutex };
+        auto legal_moves = generateLegalMoves (my_game.getBoard(), my_game.getCurrentTurn());
+
+        for (++it; it != tokens.end() && !isGoParameter (*it); ++it)
         {
-            char piece_char = tolower (pieceToChar (move.getPromotedPiece()));
-            result += piece_char;
+            auto move = parseUciMove (*it);
+            if (move.has_value() && std::find (legal_moves.begin(), legal_moves.end(), *move) != legal_moves.end())
+                result.push_back (*move);
         }
 
         return result;
     }
 
-    void UciInterface::sendBestMove (const optional<Move>& move)
+    void UciInterface::sendBestMove (const optional<Move>& move, const optional<Move>& ponder_move)
     {
-        if (move)
+        if (move && ponder_move)
         {
-            std::cout << "bestmove " << moveToUci (*move) << "\n";
+            std::cout << ("bestmove " + moveToUci (*move) + " ponder " + moveToUci (*ponder_move) + "\n");
+        }
+        else if (move)
+        {
+            std::cout << ("bestmove " + moveToUci (*move) + "\n");
         }
         else
         {
@@ -468,17 +908,4 @@ namespace wisdom
         }
         std::cout.flush();
     }
-
-    auto
-    UciInterface::buildNotifier (int initial_search_id)
-        -> MoveTimer::PeriodicFunction
-    {
-        return [this, initial_search_id] (nonnull_observer_ptr<MoveTimer> timer)
-        {
-            if (my_search_id.load() != initial_search_id)
-            {
-                timer->setCancelled (true);
-            }
-        };
-    }
 }
@@ -2,14 +2,18 @@
 
 #include "wisdom-chess/engine/global.hpp"
 #include "wisdom-chess/engine/game.hpp"
+#include "wisdom-chess/engine/eval_cache.hpp"
 #include "wisdom-chess/engine/move.hpp"
 #include "wisdom-chess/engine/move_timer.hpp"
+#include "wisdom-chess/engine/nnue.hpp"
+#include "wisdom-chess/engine/search_worker.hpp"
+#include "wisdom-chess/engine/tablebase.hpp"
 
 #include <atomic>
+#include <condition_variable>
 #include <iostream>
 #include <mutex>
 #include <sstream>
-#include <thread>
 #include <vector>
 
 namespace wisdom
@@ -18,8 +22,32 @@ namespace wisdom
 
     struct UciSettings
     {
-        int hash_size_mb = 16;
+        static constexpr int Default_Hash_Size_Mb = 16;
+        static constexpr int Min_Hash_Size_Mb = 1;
+        static constexpr int Max_Hash_Size_Mb = 32 * 1024;
+        static constexpr const char* Default_Hash_File = "wisdom-chess.hash";
+        static constexpr int Max_Eval_Cache_Size_Mb = 1024;
+
+        int hash_size_mb = Default_Hash_Size_Mb;
+        string hash_file = Default_Hash_File;
+
+        // Name of the shared memory segment holding the hash table, if any.
+        string shared_hash;
+
+        // Size of the evaluation cache, or zero to disable it.
+        int eval_cache_mb = EvalCache::Default_Size_In_Megabytes;
+
+        // The network file, and whether to evaluate with it.
+        string eval_file;
+        bool use_nnue = false;
+
+        // The directory with the endgame tablebase files, if any.
+        string tablebase_path;
+
         int default_depth = Default_Max_Depth;
+
+        static constexpr int Max_Multi_Pv = 256;
+        int multi_pv = 1;
     };
 
     class UciInterface
@@ -39,30 +67,63 @@ namespace wisdom
         void handleGo (const vector<string>& tokens);
         void handleSetOption (const vector<string>& tokens);
         void handleStop();
+        void handlePonderHit();
         void handleQuit();
 
         auto parsePosition (const vector<string>& tokens) -> bool;
         auto tokenizeCommand (const string& line) -> vector<string>;
         auto parseUciMove (const string& uci_move) -> optional<Move>;
-        auto moveToUci (const Move& move) -> string;
+
+        // The legal moves after "searchmoves" in a "go" command.
+        auto parseSearchMoves (const vector<string>& tokens) -> vector<Move>;
 
         void sendEngineInfo();
-        void sendBestMove (const optional<Move>& move);
+        void sendBestMove (const optional<Move>& move, const optional<Move>& ponder_move);
+
+        // Stop the search, which still reports its best move, and wait for
+        // it to finish.
+        void stopSearch();
 
-        [[nodiscard]] auto
-        buildNotifier (int initial_search_id)
-            -> MoveTimer::PeriodicFunction;
+        void waitForSearch();
 
-        void waitForSearchThread();
+        // Replace the current game, keeping the existing transposition table
+        // and evaluation cache.
+        void resetGame (Game new_game);
+
+        void applyHashSize();
+        void applyEvalCacheSize();
+
+        void loadEvalFile();
+        void applyEvaluator();
+
+        void loadTablebase();
+
+        void applySharedHash();
+        void saveHashFile();
+        void loadHashFile();
 
         Game my_game;
         shared_ptr<Logger> my_logger;
         bool my_debug_mode = false;
 
         std::mutex my_game_mutex;
-        std::atomic<int> my_search_id { 0 };
-        std::thread my_search_thread;
+
+        // Whether the search has to wait for "ponderhit" or "stop" before
+        // reporting its move.
+        std::mutex my_hold_mutex;
+        std::condition_variable_any my_hold_condition;
+        bool my_holding_best_move = false;
+
+        // Signals the search that the move it was pondering on was played.
+        std::stop_source my_ponder_hit;
 
         UciSettings my_settings;
+
+        // The network loaded from the eval file, if any.
+        shared_ptr<const NnueNetwork> my_network;
+
+        // Runs every search on the same thread. Declared last, so it's
+        // destroyed before anything the searches use.
+        SearchWorker my_search_worker;
     };
 }